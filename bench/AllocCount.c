@@ -0,0 +1,49 @@
+/***
+ * File: AllocCount.c
+ */
+
+#include <stdlib.h>
+#include "AllocCount.h"
+
+void *__real_malloc(size_t size);
+void *__real_calloc(size_t count, size_t size);
+void *__real_realloc(void *pointer, size_t size);
+
+// Lexer_Parallel and Lexer_Batch allocate from several threads at once
+static size_t calls;
+static size_t bytes;
+
+static void Count(size_t size)
+{
+   __atomic_fetch_add(&calls, 1, __ATOMIC_RELAXED);
+   __atomic_fetch_add(&bytes, size, __ATOMIC_RELAXED);
+}
+
+void *__wrap_malloc(size_t size)
+{
+   Count(size);
+   return __real_malloc(size);
+}
+
+void *__wrap_calloc(size_t count, size_t size)
+{
+   Count(count * size);
+   return __real_calloc(count, size);
+}
+
+void *__wrap_realloc(void *pointer, size_t size)
+{
+   Count(size);
+   return __real_realloc(pointer, size);
+}
+
+AllocCount_t AllocCount_Get(void)
+{
+   AllocCount_t count =
+   {
+      .calls = __atomic_load_n(&calls, __ATOMIC_RELAXED),
+      .bytes = __atomic_load_n(&bytes, __ATOMIC_RELAXED)
+   };
+
+   return count;
+}
@@ -0,0 +1,23 @@
+/***
+ * File: AllocCount.h
+ * Desc: Counts calls to malloc, calloc and realloc. Only works when linked with
+ *       -Wl,--wrap=malloc,--wrap=calloc,--wrap=realloc, as "make bench" does.
+ */
+
+#ifndef _ALLOCCOUNT_H
+#define _ALLOCCOUNT_H
+
+#include <stddef.h>
+
+typedef struct
+{
+   size_t calls;
+   size_t bytes;     // Asked for, not counting what's freed
+} AllocCount_t;
+
+/*
+ * Allocations made since the program started.
+ */
+AllocCount_t AllocCount_Get(void);
+
+#endif
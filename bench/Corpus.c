@@ -0,0 +1,312 @@
+/***
+ * File: Corpus.c
+ *
+ * Each kind writes whole lines until the source is big enough, then the source
+ * is cut to size and ends with a newline. Random numbers come from xorshift32,
+ * so the output doesn't depend on the C library.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "Corpus.h"
+
+typedef struct
+{
+   char *text;
+   size_t used;
+   size_t size;
+   uint32_t state;
+} Writer_t;
+
+static const char *kindNames[Corpus_Kind_Count] =
+{
+   [Corpus_Kind_Identifiers] = "identifiers",
+   [Corpus_Kind_Numbers]     = "numbers",
+   [Corpus_Kind_Strings]     = "strings",
+   [Corpus_Kind_Symbols]     = "symbols",
+   [Corpus_Kind_Errors]      = "errors",
+   [Corpus_Kind_Mixed]       = "mixed"
+};
+
+static uint32_t Random(Writer_t *writer)
+{
+   writer->state ^= writer->state << 13;
+   writer->state ^= writer->state >> 17;
+   writer->state ^= writer->state << 5;
+   return writer->state;
+}
+
+// Random number in [0, count)
+static uint32_t Pick(Writer_t *writer, uint32_t count)
+{
+   return Random(writer) % count;
+}
+
+static bool Full(const Writer_t *writer)
+{
+   return writer->used >= writer->size;
+}
+
+// Writes past size land in the slack allocated after it and are cut off
+static void Put(Writer_t *writer, char c)
+{
+   if(writer->used < writer->size + 64)
+   {
+      writer->text[writer->used++] = c;
+   }
+}
+
+static void PutString(Writer_t *writer, const char *string)
+{
+   while(*string != '\0')
+   {
+      Put(writer, *string++);
+   }
+}
+
+static void PutFrom(Writer_t *writer, const char *characters, size_t length)
+{
+   size_t count = strlen(characters);
+
+   for(size_t i = 0; i < length; i++)
+   {
+      Put(writer, characters[Pick(writer, count)]);
+   }
+}
+
+static void PutWord(Writer_t *writer)
+{
+   static const char *letters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ";
+
+   PutFrom(writer, letters, 1);
+   PutFrom(writer, "abcdefghijklmnopqrstuvwxyz_-?", Pick(writer, 14));
+}
+
+static void PutDigits(Writer_t *writer, size_t length)
+{
+   PutFrom(writer, "0123456789", length);
+}
+
+/*********************************
+ * Lines of each kind
+ *********************************/
+static void IdentifierLine(Writer_t *writer)
+{
+   size_t words = 6 + Pick(writer, 8);
+
+   PutFrom(writer, " ", Pick(writer, 4));
+   for(size_t i = 0; i < words; i++)
+   {
+      if(Pick(writer, 10) == 0)
+      {
+         Put(writer, ':');
+      }
+      PutWord(writer);
+      Put(writer, ' ');
+   }
+   Put(writer, '\n');
+}
+
+static void NumberLine(Writer_t *writer)
+{
+   size_t numbers = 8 + Pick(writer, 8);
+
+   for(size_t i = 0; i < numbers; i++)
+   {
+      switch(Pick(writer, 5))
+      {
+         case 0:  // Decimal with no leading digits
+            Put(writer, '.');
+            PutDigits(writer, 1 + Pick(writer, 6));
+            break;
+
+         case 1:
+            PutDigits(writer, 1 + Pick(writer, 8));
+            Put(writer, '.');
+            PutDigits(writer, 1 + Pick(writer, 8));
+            break;
+
+         case 2:  // Sized type
+            PutDigits(writer, 1 + Pick(writer, 2));
+            Put(writer, Pick(writer, 2) ? '\'' : '"');
+            break;
+
+         default:
+            PutDigits(writer, 1 + Pick(writer, 12));
+            break;
+      }
+      Put(writer, ' ');
+   }
+   Put(writer, '\n');
+}
+
+static void StringLine(Writer_t *writer)
+{
+   static const char *text = "abcdefghijklmnopqrstuvwxyz ABCDEFGHIJKLMNOPQRSTUVWXYZ 0123456789 .,:;!?()[]{}<>=+-*/'";
+   size_t strings = 1 + Pick(writer, 4);
+
+   for(size_t i = 0; i < strings; i++)
+   {
+      Put(writer, '"');
+      PutFrom(writer, text, Pick(writer, 60));
+      Put(writer, '"');
+      Put(writer, ' ');
+   }
+   Put(writer, '\n');
+}
+
+static void SymbolLine(Writer_t *writer)
+{
+   static const char *spaced[] = { "@", "#", "$", "-", "+", "/", "*", "=", "<", ">", "<=", ">=", "==", "!=", "..", "...", "~" };
+   static const char *packed[] = { "(", ")", "[", "]", "{", "}", ",", ".", "`" };
+   size_t symbols = 16 + Pick(writer, 16);
+
+   for(size_t i = 0; i < symbols; i++)
+   {
+      if(Pick(writer, 2))
+      {
+         PutString(writer, packed[Pick(writer, sizeof(packed) / sizeof(packed[0]))]);
+      }
+      else
+      {
+         Put(writer, ' ');
+         PutString(writer, spaced[Pick(writer, sizeof(spaced) / sizeof(spaced[0]))]);
+         Put(writer, ' ');
+      }
+   }
+   Put(writer, '\n');
+}
+
+static void ErrorLine(Writer_t *writer)
+{
+   size_t errors = 4 + Pick(writer, 6);
+
+   for(size_t i = 0; i < errors; i++)
+   {
+      switch(Pick(writer, 6))
+      {
+         case 0:  // Unexpected characters
+            PutFrom(writer, "%^&\\|;", 1 + Pick(writer, 3));
+            break;
+
+         case 1:  // Touchy symbols touching
+            PutWord(writer);
+            PutFrom(writer, "+-*/=<>@$", 1);
+            PutWord(writer);
+            break;
+
+         case 2:  // Identifier with no word character
+            PutFrom(writer, "_-#!", 2 + Pick(writer, 4));
+            break;
+
+         case 3:  // Non-ascii
+            PutFrom(writer, "\xC3\xA9\xE2\x82\xAC", 1 + Pick(writer, 4));
+            break;
+
+         case 4:  // String that runs into the next line
+            Put(writer, '"');
+            PutWord(writer);
+            Put(writer, '\n');
+            break;
+
+         default:
+            Put(writer, ':');
+            PutFrom(writer, "([{", 1);
+            break;
+      }
+      Put(writer, ' ');
+   }
+   Put(writer, '\n');
+}
+
+static void MixedLine(Writer_t *writer)
+{
+   static void (*const others[])(Writer_t *writer) = { IdentifierLine, NumberLine, StringLine, SymbolLine };
+
+   switch(Pick(writer, 8))
+   {
+      case 0:
+         others[Pick(writer, 4)](writer);
+         break;
+
+      case 1:
+         PutString(writer, "if ");
+         PutWord(writer);
+         PutString(writer, " != ");
+         PutDigits(writer, 1 + Pick(writer, 3));
+         PutString(writer, " {\n");
+         break;
+
+      case 2:
+         PutString(writer, "}\n");
+         break;
+
+      case 3:
+         PutString(writer, "print \"");
+         PutWord(writer);
+         PutString(writer, "\" .. ");
+         PutWord(writer);
+         Put(writer, '\n');
+         break;
+
+      default:
+         PutFrom(writer, " ", 3 * Pick(writer, 3));
+         PutWord(writer);
+         PutString(writer, ": ");
+         PutWord(writer);
+         PutString(writer, " = ");
+         PutWord(writer);
+         PutString(writer, Pick(writer, 2) ? " + " : " * ");
+         PutDigits(writer, 1 + Pick(writer, 4));
+         Put(writer, '\n');
+         break;
+   }
+}
+
+/*********************************
+ * Public functions
+ *********************************/
+const char *Corpus_KindName(Corpus_Kind_t kind)
+{
+   return kindNames[kind];
+}
+
+Corpus_Kind_t Corpus_KindNamed(const char *name)
+{
+   for(Corpus_Kind_t kind = 0; kind < Corpus_Kind_Count; kind++)
+   {
+      if(strcmp(kindNames[kind], name) == 0)
+      {
+         return kind;
+      }
+   }
+
+   return -1;
+}
+
+char *Corpus_Generate(Corpus_Kind_t kind, size_t size, uint32_t seed)
+{
+   static void (*const lines[Corpus_Kind_Count])(Writer_t *writer) =
+   {
+      [Corpus_Kind_Identifiers] = IdentifierLine,
+      [Corpus_Kind_Numbers]     = NumberLine,
+      [Corpus_Kind_Strings]     = StringLine,
+      [Corpus_Kind_Symbols]     = SymbolLine,
+      [Corpus_Kind_Errors]      = ErrorLine,
+      [Corpus_Kind_Mixed]       = MixedLine
+   };
+   Writer_t writer = { .text = malloc(size + 64 + 1), .used = 0, .size = size, .state = seed | 1 };
+
+   while(!Full(&writer))
+   {
+      lines[kind](&writer);
+   }
+
+   if(size > 0)
+   {
+      writer.text[size - 1] = '\n';
+   }
+   writer.text[size] = '\0';
+   return writer.text;
+}
@@ -0,0 +1,43 @@
+/***
+ * File: Corpus.h
+ * Desc: Generates synthetic sources for benchmarking, each leaning on one kind
+ *       of token. The same kind, size and seed always give the same bytes.
+ */
+
+#ifndef _CORPUS_H
+#define _CORPUS_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+   Corpus_Kind_Identifiers = 0,
+   Corpus_Kind_Numbers,
+   Corpus_Kind_Strings,
+   Corpus_Kind_Symbols,
+   Corpus_Kind_Errors,
+   Corpus_Kind_Mixed,
+
+   Corpus_Kind_Count
+};
+typedef int Corpus_Kind_t;
+
+/*
+ * Name of a kind of corpus, as used on the command line.
+ */
+const char *Corpus_KindName(Corpus_Kind_t kind);
+
+/*
+ * Kind with the given name, or -1 if there isn't one.
+ */
+Corpus_Kind_t Corpus_KindNamed(const char *name);
+
+/*
+ * Generate size bytes of source of one kind, followed by '\0'.
+ *
+ * @return - the source, which the caller frees
+ */
+char *Corpus_Generate(Corpus_Kind_t kind, size_t size, uint32_t seed);
+
+#endif
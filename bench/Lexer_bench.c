@@ -0,0 +1,584 @@
+/***
+ * File: Lexer_bench.c
+ * Desc: Times every I_Lexer with every I_List over generated sources of each
+ *       kind and size, or over a file. Prints a table and appends the same
+ *       results to a tab-separated file so runs can be compared over time.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+#include "Lexer_StaticLookup.h"
+#include "Lexer_Dfa.h"
+#include "Lexer_Parallel.h"
+#include "List_Calloc.h"
+#include "List_Arena.h"
+#include "TokenStream.h"
+#include "TokenList.h"
+#include "SourceFile.h"
+#include "Token.h"
+#include "Corpus.h"
+#include "AllocCount.h"
+#include "util.h"
+
+#define BENCH_DEFAULT_SIZES "1K,64K,1M,16M"
+#define BENCH_DEFAULT_RESULTS "bench/results.tsv"
+#define BENCH_SEED (20200503)
+#define BENCH_MIN_ROUNDS (3)
+#define BENCH_MAX_ROUNDS (1000)
+#define BENCH_MIN_SECONDS (0.25)
+
+#define ARRAY_LENGTH(array) (sizeof(array) / sizeof((array)[0]))
+
+typedef struct
+{
+   I_Error_t interface;
+   size_t count;
+} Error_Count_t;
+
+typedef union
+{
+   Lexer_StaticLookup_t staticLookup;
+   Lexer_Dfa_t dfa;
+   Lexer_Parallel_t parallel;
+} Bench_Lexer_t;
+
+typedef union
+{
+   List_Calloc_t calloc;
+   List_Arena_t arena;
+   TokenStream_t stream;
+   TokenList_t tokenList;
+} Bench_List_t;
+
+typedef struct
+{
+   const char *name;
+   I_Lexer_t *(*init)(Bench_Lexer_t *lexer, I_Error_t *errors);
+   void (*deinit)(Bench_Lexer_t *lexer);
+} Bench_LexerKind_t;
+
+typedef struct
+{
+   const char *name;
+   I_List_t *(*init)(Bench_List_t *list, const char *source);
+   void (*deinit)(Bench_List_t *list);
+} Bench_ListKind_t;
+
+typedef struct
+{
+   const char *kind;
+   size_t bytes;
+   size_t rounds;
+   double seconds;   // Best round
+   size_t tokens;
+   size_t errors;
+   long peakKb;      // Above what was resident before the round, -1 if unknown
+   AllocCount_t allocations;
+} Bench_Result_t;
+
+typedef struct
+{
+   bool kinds[Corpus_Kind_Count];
+   size_t sizes[16];
+   size_t sizeCount;
+   const char *lexers;
+   const char *lists;
+   const char *file;
+   const char *results;
+   const char *label;
+} Bench_Options_t;
+
+/*********************************
+ * Implementations under test
+ *********************************/
+static I_Lexer_t *InitStaticLookup(Bench_Lexer_t *lexer, I_Error_t *errors)
+{
+   Lexer_StaticLookup_Init(&lexer->staticLookup, errors);
+   return &lexer->staticLookup.interface;
+}
+
+static void DeinitStaticLookup(Bench_Lexer_t *lexer)
+{
+   Lexer_StaticLookup_Deinit(&lexer->staticLookup);
+}
+
+static I_Lexer_t *InitDfa(Bench_Lexer_t *lexer, I_Error_t *errors)
+{
+   Lexer_Dfa_Init(&lexer->dfa, errors);
+   return &lexer->dfa.interface;
+}
+
+static I_Lexer_t *InitParallel(Bench_Lexer_t *lexer, I_Error_t *errors)
+{
+   Lexer_Parallel_Init(&lexer->parallel, errors, 0);
+   return &lexer->parallel.interface;
+}
+
+static void DeinitNothing(Bench_Lexer_t *lexer)
+{
+   (void)lexer;
+}
+
+static I_List_t *InitCalloc(Bench_List_t *list, const char *source)
+{
+   (void)source;
+   List_Calloc_Init(&list->calloc, sizeof(Token_t));
+   return &list->calloc.interface;
+}
+
+static void DeinitCalloc(Bench_List_t *list)
+{
+   List_Calloc_Deinit(&list->calloc);
+}
+
+static I_List_t *InitArena(Bench_List_t *list, const char *source)
+{
+   (void)source;
+   List_Arena_Init(&list->arena, sizeof(Token_t));
+   return &list->arena.interface;
+}
+
+static void DeinitArena(Bench_List_t *list)
+{
+   List_Arena_Deinit(&list->arena);
+}
+
+static I_List_t *InitTokenStream(Bench_List_t *list, const char *source)
+{
+   TokenStream_Init(&list->stream, source);
+   return &list->stream.interface;
+}
+
+static void DeinitTokenStream(Bench_List_t *list)
+{
+   TokenStream_Deinit(&list->stream);
+}
+
+static I_List_t *InitTokenList(Bench_List_t *list, const char *source)
+{
+   (void)source;
+   TokenList_Init(&list->tokenList);
+   return &list->tokenList.interface;
+}
+
+static void DeinitTokenList(Bench_List_t *list)
+{
+   TokenList_Deinit(&list->tokenList);
+}
+
+static const Bench_LexerKind_t lexerKinds[] =
+{
+   { "StaticLookup", InitStaticLookup, DeinitStaticLookup },
+   { "Dfa",          InitDfa,          DeinitNothing      },
+   { "Parallel",     InitParallel,     DeinitNothing      }
+};
+
+static const Bench_ListKind_t listKinds[] =
+{
+   { "Calloc",      InitCalloc,      DeinitCalloc      },
+   { "Arena",       InitArena,       DeinitArena       },
+   { "TokenStream", InitTokenStream, DeinitTokenStream },
+   { "TokenList",   InitTokenList,   DeinitTokenList   }
+};
+
+/*********************************
+ * Measurement
+ *********************************/
+static void CountError(I_Error_t *interface, size_t line, const char *message)
+{
+   REINTERPRET(instance, interface, Error_Count_t *);
+   (void)line;
+   (void)message;
+   instance->count++;
+}
+
+static double Seconds(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+// Field of /proc/self/status in kB, or -1 if it can't be read
+static long StatusKb(const char *field)
+{
+   FILE *status = fopen("/proc/self/status", "r");
+   char line[128];
+   long kb = -1;
+
+   if(status == NULL)
+   {
+      return -1;
+   }
+
+   while(fgets(line, sizeof(line), status) != NULL)
+   {
+      if(strncmp(line, field, strlen(field)) == 0)
+      {
+         kb = strtol(&line[strlen(field) + 1], NULL, 10);
+         break;
+      }
+   }
+
+   fclose(status);
+   return kb;
+}
+
+// Start the peak resident size over from what's resident now
+static long ResetPeak(void)
+{
+   FILE *clearRefs;
+
+#ifdef __GLIBC__
+   malloc_trim(0);
+#endif
+   clearRefs = fopen("/proc/self/clear_refs", "w");
+   if(clearRefs == NULL)
+   {
+      return -1;
+   }
+   fputs("5", clearRefs);
+   fclose(clearRefs);
+
+   return StatusKb("VmRSS");
+}
+
+static size_t CountTokens(I_List_t *tokens)
+{
+   Token_t *token;
+   size_t count = 0;
+
+   List_At(tokens, count, (void **)&token);
+   while(token != NULL)
+   {
+      count++;
+      List_At(tokens, count, (void **)&token);
+   }
+
+   return count;
+}
+
+/*
+ * Lex the source at least BENCH_MIN_ROUNDS times and for at least
+ * BENCH_MIN_SECONDS, keeping the best time. Memory is measured on the first round.
+ */
+static void Measure(const Bench_LexerKind_t *lexerKind, const Bench_ListKind_t *listKind, const char *source, size_t length, Bench_Result_t *result)
+{
+   Error_Count_t errors = { .interface.report = CountError };
+   Bench_Lexer_t lexer;
+   I_Lexer_t *lexerInterface = lexerKind->init(&lexer, &errors.interface);
+   double total = 0;
+
+   result->bytes = length;
+   result->seconds = 0;
+
+   for(result->rounds = 0; result->rounds < BENCH_MIN_ROUNDS || (total < BENCH_MIN_SECONDS && result->rounds < BENCH_MAX_ROUNDS); result->rounds++)
+   {
+      Bench_List_t list;
+      I_List_t *tokens;
+      AllocCount_t before = AllocCount_Get();
+      long residentKb = (result->rounds == 0) ? ResetPeak() : -1;
+      double start;
+      double elapsed;
+
+      errors.count = 0;
+
+      start = Seconds();
+      tokens = listKind->init(&list, source);
+      Lexer_LexSpan(lexerInterface, source, length, tokens);
+      elapsed = Seconds() - start;
+
+      if(result->rounds == 0)
+      {
+         long peakKb = StatusKb("VmHWM");
+
+         result->peakKb = (residentKb < 0 || peakKb < 0) ? -1 : peakKb - residentKb;
+         result->tokens = CountTokens(tokens);
+         result->errors = errors.count;
+      }
+
+      listKind->deinit(&list);
+      if(result->rounds == 0)
+      {
+         AllocCount_t after = AllocCount_Get();
+
+         result->allocations.calls = after.calls - before.calls;
+         result->allocations.bytes = after.bytes - before.bytes;
+      }
+
+      total += elapsed;
+      if(result->rounds == 0 || elapsed < result->seconds)
+      {
+         result->seconds = elapsed;
+      }
+   }
+
+   lexerKind->deinit(&lexer);
+}
+
+/*********************************
+ * Output
+ *********************************/
+static void PrintHeader(void)
+{
+   printf("%-12s %10s  %-12s %-12s %9s %10s %9s %10s %12s\n",
+      "kind", "bytes", "lexer", "list", "MB/s", "Mtokens/s", "ns/token", "peak kB", "allocations");
+}
+
+static void PrintResult(const Bench_Result_t *result, const char *lexer, const char *list)
+{
+   double tokens = (result->tokens > 0) ? result->tokens : 1;
+
+   printf("%-12s %10zu  %-12s %-12s %9.1f %10.2f %9.2f %10ld %12zu\n",
+      result->kind, result->bytes, lexer, list,
+      result->bytes / result->seconds / 1e6,
+      tokens / result->seconds / 1e6,
+      result->seconds * 1e9 / tokens,
+      result->peakKb,
+      result->allocations.calls);
+}
+
+static void WriteResult(FILE *out, const Bench_Options_t *options, time_t when, const Bench_Result_t *result, const char *lexer, const char *list)
+{
+   double tokens = (result->tokens > 0) ? result->tokens : 1;
+
+   fprintf(out, "%s\t%ld\t%s\t%zu\t%s\t%s\t%zu\t%.9f\t%.3f\t%zu\t%.0f\t%.3f\t%ld\t%zu\t%zu\t%zu\n",
+      options->label, (long)when, result->kind, result->bytes, lexer, list, result->rounds, result->seconds,
+      result->bytes / result->seconds / 1e6,
+      result->tokens, tokens / result->seconds,
+      result->seconds * 1e9 / tokens,
+      result->peakKb, result->allocations.calls, result->allocations.bytes, result->errors);
+}
+
+static FILE *OpenResults(const char *path)
+{
+   FILE *out = fopen(path, "a");
+
+   if(out != NULL && ftell(out) == 0)
+   {
+      fprintf(out, "label\ttime\tkind\tbytes\tlexer\tlist\trounds\tseconds\tmb_per_s\ttokens\ttokens_per_s\tns_per_token\tpeak_rss_kb\tallocations\tallocated_bytes\terrors\n");
+   }
+
+   return out;
+}
+
+/*********************************
+ * Options
+ *********************************/
+static void PrintUsage(const char *program)
+{
+   printf("Usage: %s [options]\n", program);
+   printf("  --kinds k,...    kinds of generated source (default all):");
+   for(Corpus_Kind_t kind = 0; kind < Corpus_Kind_Count; kind++)
+   {
+      printf(" %s", Corpus_KindName(kind));
+   }
+   printf("\n");
+   printf("  --sizes s,...    sizes of generated source, with K, M or G (default %s)\n", BENCH_DEFAULT_SIZES);
+   printf("  --lexers l,...   lexers to time (default all)\n");
+   printf("  --lists l,...    token lists to time (default all)\n");
+   printf("  --file path      lex this file instead of generated sources\n");
+   printf("  --out path       append results here (default %s)\n", BENCH_DEFAULT_RESULTS);
+   printf("  --label text     label for this run in the results\n");
+}
+
+// Whether name is one of the comma-separated names in list (NULL means all)
+static bool Listed(const char *list, const char *name)
+{
+   size_t length = strlen(name);
+   const char *at = list;
+
+   if(list == NULL)
+   {
+      return true;
+   }
+
+   while(at != NULL)
+   {
+      if(strncmp(at, name, length) == 0 && (at[length] == ',' || at[length] == '\0'))
+      {
+         return true;
+      }
+
+      at = strchr(at, ',');
+      at = (at != NULL) ? at + 1 : NULL;
+   }
+
+   return false;
+}
+
+static bool ParseSizes(const char *text, Bench_Options_t *options)
+{
+   char *end;
+
+   options->sizeCount = 0;
+   while(*text != '\0' && options->sizeCount < ARRAY_LENGTH(options->sizes))
+   {
+      size_t size = strtoull(text, &end, 10);
+
+      switch(*end)
+      {
+         case 'K': size <<= 10; end++; break;
+         case 'M': size <<= 20; end++; break;
+         case 'G': size <<= 30; end++; break;
+      }
+
+      if(end == text || size == 0 || (*end != ',' && *end != '\0'))
+      {
+         return false;
+      }
+
+      options->sizes[options->sizeCount++] = size;
+      text = (*end == ',') ? end + 1 : end;
+   }
+
+   return true;
+}
+
+static bool ParseOptions(int argc, char *argv[], Bench_Options_t *options)
+{
+   const char *kinds = NULL;
+
+   ParseSizes(BENCH_DEFAULT_SIZES, options);
+   options->lexers = NULL;
+   options->lists = NULL;
+   options->file = NULL;
+   options->results = BENCH_DEFAULT_RESULTS;
+   options->label = "";
+
+   for(int i = 1; i < argc; i++)
+   {
+      const char *value = (i + 1 < argc) ? argv[i + 1] : NULL;
+
+      if(value == NULL)
+      {
+         return false;
+      }
+      else if(strcmp(argv[i], "--kinds") == 0)
+      {
+         kinds = value;
+      }
+      else if(strcmp(argv[i], "--sizes") == 0)
+      {
+         if(!ParseSizes(value, options))
+         {
+            return false;
+         }
+      }
+      else if(strcmp(argv[i], "--lexers") == 0)
+      {
+         options->lexers = value;
+      }
+      else if(strcmp(argv[i], "--lists") == 0)
+      {
+         options->lists = value;
+      }
+      else if(strcmp(argv[i], "--file") == 0)
+      {
+         options->file = value;
+      }
+      else if(strcmp(argv[i], "--out") == 0)
+      {
+         options->results = value;
+      }
+      else if(strcmp(argv[i], "--label") == 0)
+      {
+         options->label = value;
+      }
+      else
+      {
+         return false;
+      }
+      i++;
+   }
+
+   for(Corpus_Kind_t kind = 0; kind < Corpus_Kind_Count; kind++)
+   {
+      options->kinds[kind] = Listed(kinds, Corpus_KindName(kind));
+   }
+
+   return true;
+}
+
+/*********************************
+ * Main
+ *********************************/
+static void BenchSource(const Bench_Options_t *options, FILE *out, time_t when, const char *kind, const char *source, size_t length)
+{
+   for(size_t lexer = 0; lexer < ARRAY_LENGTH(lexerKinds); lexer++)
+   {
+      for(size_t list = 0; list < ARRAY_LENGTH(listKinds); list++)
+      {
+         Bench_Result_t result = { .kind = kind };
+
+         if(!Listed(options->lexers, lexerKinds[lexer].name) || !Listed(options->lists, listKinds[list].name))
+         {
+            continue;
+         }
+
+         Measure(&lexerKinds[lexer], &listKinds[list], source, length, &result);
+         PrintResult(&result, lexerKinds[lexer].name, listKinds[list].name);
+         WriteResult(out, options, when, &result, lexerKinds[lexer].name, listKinds[list].name);
+         fflush(stdout);
+      }
+   }
+}
+
+int main(int argc, char *argv[])
+{
+   Bench_Options_t options;
+   time_t when = time(NULL);
+   FILE *out;
+
+   if(!ParseOptions(argc, argv, &options))
+   {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   out = OpenResults(options.results);
+   if(out == NULL)
+   {
+      perror(options.results);
+      return EXIT_FAILURE;
+   }
+
+   PrintHeader();
+   if(options.file != NULL)
+   {
+      SourceFile_t file;
+
+      if(!SourceFile_Open(&file, options.file))
+      {
+         perror(options.file);
+         fclose(out);
+         return EXIT_FAILURE;
+      }
+
+      BenchSource(&options, out, when, "file", file.data, file.length);
+      SourceFile_Close(&file);
+   }
+   else
+   {
+      for(Corpus_Kind_t kind = 0; kind < Corpus_Kind_Count; kind++)
+      {
+         for(size_t size = 0; size < options.sizeCount && options.kinds[kind]; size++)
+         {
+            char *source = Corpus_Generate(kind, options.sizes[size], BENCH_SEED);
+
+            BenchSource(&options, out, when, Corpus_KindName(kind), source, options.sizes[size]);
+            free(source);
+         }
+      }
+   }
+
+   fclose(out);
+   printf("Results appended to %s\n", options.results);
+   return EXIT_SUCCESS;
+}
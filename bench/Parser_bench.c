@@ -0,0 +1,260 @@
+/***
+ * File: Parser_bench.c
+ * Desc: Times the Parser over generated sources of each kind and size, or over
+ *       a file, on one thread or several. The source is lexed once up front;
+ *       only parsing is timed.
+ */
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdbool.h>
+#include <time.h>
+#include "Parser.h"
+#include "Parser_Parallel.h"
+#include "Lexer_StaticLookup.h"
+#include "List_Calloc.h"
+#include "SourceFile.h"
+#include "Token.h"
+#include "Corpus.h"
+#include "AllocCount.h"
+#include "util.h"
+
+#define BENCH_DEFAULT_SIZES "1M,16M"
+#define BENCH_SEED (20200503)
+#define BENCH_MIN_ROUNDS (3)
+#define BENCH_MAX_ROUNDS (1000)
+#define BENCH_MIN_SECONDS (0.25)
+
+typedef struct
+{
+   I_Error_t interface;
+   size_t count;
+} Error_Count_t;
+
+typedef struct
+{
+   const char *kind;
+   size_t bytes;
+   size_t tokens;
+   size_t nodes;
+   size_t nodeBytes;    // Allocated for the tree
+   size_t errors;
+   size_t parts;        // Parsed on their own threads
+   size_t rounds;
+   double seconds;      // Best round
+   AllocCount_t allocations;
+} Bench_Result_t;
+
+static void CountError(I_Error_t *interface, size_t line, const char *message)
+{
+   REINTERPRET(instance, interface, Error_Count_t *);
+   (void)line;
+   (void)message;
+   instance->count++;
+}
+
+static double Seconds(void)
+{
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static size_t threadCount = 1;
+
+/*
+ * Parse the tokens at least BENCH_MIN_ROUNDS times and for at least
+ * BENCH_MIN_SECONDS, keeping the best time. Each round starts from a new
+ * Parser, so the tree's allocation is timed too.
+ */
+static void Measure(const Token_t *tokens, size_t count, Bench_Result_t *result)
+{
+   double total = 0;
+
+   result->tokens = count;
+   for(result->rounds = 0; result->rounds < BENCH_MIN_ROUNDS || (total < BENCH_MIN_SECONDS && result->rounds < BENCH_MAX_ROUNDS); result->rounds++)
+   {
+      Error_Count_t errors = { .interface.report = CountError };
+      AllocCount_t before = AllocCount_Get();
+      Parser_Parallel_t parser;
+      double start;
+      double elapsed;
+
+      start = Seconds();
+      Parser_Parallel_Init(&parser, &errors.interface, threadCount);
+      Parser_Parallel_Parse(&parser, tokens, count);
+      elapsed = Seconds() - start;
+
+      if(result->rounds == 0)
+      {
+         AllocCount_t after = AllocCount_Get();
+
+         result->nodes = parser.parser.nodeCount;
+         result->nodeBytes = parser.parser.allocatedNodeCount * sizeof(Parser_Node_t);
+         result->errors = errors.count;
+         result->parts = parser.chunkCount;
+         result->allocations.calls = after.calls - before.calls;
+         result->allocations.bytes = after.bytes - before.bytes;
+      }
+      Parser_Parallel_Deinit(&parser);
+
+      total += elapsed;
+      if(result->rounds == 0 || elapsed < result->seconds)
+      {
+         result->seconds = elapsed;
+      }
+   }
+}
+
+static void PrintHeader(void)
+{
+   printf("%-12s %10s %10s %10s %9s %10s %9s %10s %10s %8s %6s\n",
+      "kind", "bytes", "tokens", "nodes", "MB/s", "Mnodes/s", "ns/node", "bytes/node", "errors", "allocs", "parts");
+}
+
+static void PrintResult(const Bench_Result_t *result)
+{
+   double nodes = (result->nodes > 0) ? result->nodes : 1;
+
+   printf("%-12s %10zu %10zu %10zu %9.1f %10.2f %9.2f %10.2f %10zu %8zu %6zu\n",
+      result->kind, result->bytes, result->tokens, result->nodes,
+      result->bytes / result->seconds / 1e6,
+      nodes / result->seconds / 1e6,
+      result->seconds * 1e9 / nodes,
+      result->nodeBytes / nodes,
+      result->errors,
+      result->allocations.calls,
+      result->parts);
+}
+
+static void BenchSource(const char *kind, const char *source, size_t length)
+{
+   Error_Count_t errors = { .interface.report = CountError };
+   Lexer_StaticLookup_t lexer;
+   List_Calloc_t tokens;
+   Bench_Result_t result = { .kind = kind, .bytes = length };
+
+   List_Calloc_Init(&tokens, sizeof(Token_t));
+   Lexer_StaticLookup_Init(&lexer, &errors.interface);
+   Lexer_LexSpan(&lexer.interface, source, length, &tokens.interface);
+   Lexer_StaticLookup_Deinit(&lexer);
+
+   Measure((const Token_t *)tokens.storage, tokens.usedSize, &result);
+   PrintResult(&result);
+   fflush(stdout);
+
+   List_Calloc_Deinit(&tokens);
+}
+
+static bool ParseSize(const char *text, const char **end, size_t *size)
+{
+   char *after;
+
+   *size = strtoull(text, &after, 10);
+   switch(*after)
+   {
+      case 'K': *size <<= 10; after++; break;
+      case 'M': *size <<= 20; after++; break;
+      case 'G': *size <<= 30; after++; break;
+   }
+
+   *end = after;
+   return after != text && *size > 0 && (*after == ',' || *after == '\0');
+}
+
+static void PrintUsage(const char *program)
+{
+   printf("Usage: %s [--sizes s,...] [--kinds k,...] [--file path] [--threads n]\n", program);
+   printf("  --sizes s,...    sizes of generated source, with K, M or G (default %s)\n", BENCH_DEFAULT_SIZES);
+   printf("  --kinds k,...    kinds of generated source (default all):");
+   for(Corpus_Kind_t kind = 0; kind < Corpus_Kind_Count; kind++)
+   {
+      printf(" %s", Corpus_KindName(kind));
+   }
+   printf("\n");
+   printf("  --file path      parse this file instead of generated sources\n");
+   printf("  --threads n      parse on up to n threads, split between top-level blocks (default 1, 0 = one per CPU)\n");
+}
+
+int main(int argc, char *argv[])
+{
+   const char *sizes = BENCH_DEFAULT_SIZES;
+   const char *kinds = NULL;
+   const char *path = NULL;
+
+   for(int i = 1; i + 1 < argc; i += 2)
+   {
+      if(strcmp(argv[i], "--sizes") == 0)
+      {
+         sizes = argv[i + 1];
+      }
+      else if(strcmp(argv[i], "--kinds") == 0)
+      {
+         kinds = argv[i + 1];
+      }
+      else if(strcmp(argv[i], "--file") == 0)
+      {
+         path = argv[i + 1];
+      }
+      else if(strcmp(argv[i], "--threads") == 0)
+      {
+         threadCount = strtoul(argv[i + 1], NULL, 10);
+      }
+      else
+      {
+         PrintUsage(argv[0]);
+         return EXIT_FAILURE;
+      }
+   }
+   if(argc % 2 == 0)
+   {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+   }
+
+   PrintHeader();
+   if(path != NULL)
+   {
+      SourceFile_t file;
+
+      if(!SourceFile_Open(&file, path))
+      {
+         perror(path);
+         return EXIT_FAILURE;
+      }
+
+      BenchSource("file", file.data, file.length);
+      SourceFile_Close(&file);
+      return EXIT_SUCCESS;
+   }
+
+   for(Corpus_Kind_t kind = 0; kind < Corpus_Kind_Count; kind++)
+   {
+      const char *at = sizes;
+      size_t size;
+
+      if(kinds != NULL && strstr(kinds, Corpus_KindName(kind)) == NULL)
+      {
+         continue;
+      }
+
+      while(*at != '\0')
+      {
+         char *source;
+
+         if(!ParseSize(at, &at, &size))
+         {
+            PrintUsage(argv[0]);
+            return EXIT_FAILURE;
+         }
+         at += (*at == ',') ? 1 : 0;
+
+         source = Corpus_Generate(kind, size, BENCH_SEED);
+         BenchSource(Corpus_KindName(kind), source, size);
+         free(source);
+      }
+   }
+
+   return EXIT_SUCCESS;
+}
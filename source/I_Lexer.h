@@ -20,9 +20,26 @@ typedef struct I_Lexer_t
     *          so deallocating source will invalidate the tokens
     */
    void (*lex)(struct I_Lexer_t *interface, const char *source, I_List_t *tokens);
+
+   /*
+    * Lex a buffer of known length into a list of tokens.
+    *
+    * @param source - source code characters, not necessarily null-terminated
+    * @param length - number of characters in source
+    * @param tokens - storage for the tokens
+    * @pre - tokens is an empty list
+    * @post - a null character inside the buffer is lexed like any other
+    *          unexpected character instead of ending the source
+    * @post - tokens that contain strings will point directly to source,
+    *          so deallocating source will invalidate the tokens
+    */
+   void (*lexSpan)(struct I_Lexer_t *interface, const char *source, size_t length, I_List_t *tokens);
 } I_Lexer_t;
 
 #define Lexer_Lex(interface, source, tokens) \
    (interface)->lex((interface), (source), (tokens))
 
+#define Lexer_LexSpan(interface, source, length, tokens) \
+   (interface)->lexSpan((interface), (source), (length), (tokens))
+
 #endif
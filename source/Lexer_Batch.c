@@ -0,0 +1,251 @@
+/***
+ * File: Lexer_Batch.c
+ *
+ * Every worker starts with an even share of the files as a range of indices.
+ * It takes files from the front of its range one at a time; a worker whose
+ * range is empty takes the back half of the biggest range left. Taking half at
+ * a time means a worker lexing small files rarely has to go looking for more.
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include "Lexer_Batch.h"
+#include "Threads.h"
+#include "util.h"
+
+// Batches smaller than this per thread are lexed on the calling thread
+#define LEXER_BATCH_MIN_FILES_PER_THREAD (4)
+
+/*
+ * Take the next file from the front of a worker's range.
+ *
+ * @return - false if the range is empty
+ */
+static bool TakeNext(Lexer_Batch_Worker_t *worker, size_t *index)
+{
+   bool taken = false;
+
+   pthread_mutex_lock(&worker->lock);
+   if(worker->next < worker->end)
+   {
+      *index = worker->next++;
+      taken = true;
+   }
+   pthread_mutex_unlock(&worker->lock);
+
+   return taken;
+}
+
+/*
+ * Move the back half of the biggest range left to thief's range.
+ *
+ * @return - false if there's nothing left to steal
+ */
+static bool Steal(Lexer_Batch_t *instance, Lexer_Batch_Worker_t *thief)
+{
+   for(;;)
+   {
+      Lexer_Batch_Worker_t *victim = NULL;
+      size_t most = 0;
+      size_t half;
+      size_t from;
+
+      // Ranges may change before the victim is locked again, so this is only a guess
+      for(size_t w = 0; w < instance->workerCount; w++)
+      {
+         Lexer_Batch_Worker_t *worker = &instance->workers[w];
+         size_t left;
+
+         pthread_mutex_lock(&worker->lock);
+         left = worker->end - worker->next;
+         pthread_mutex_unlock(&worker->lock);
+
+         if(worker != thief && left > most)
+         {
+            victim = worker;
+            most = left;
+         }
+      }
+
+      if(victim == NULL)
+      {
+         return false;
+      }
+
+      pthread_mutex_lock(&victim->lock);
+      half = (victim->end - victim->next + 1) / 2;
+      victim->end -= half;
+      from = victim->end;
+      pthread_mutex_unlock(&victim->lock);
+
+      if(half > 0)
+      {
+         pthread_mutex_lock(&thief->lock);
+         thief->next = from;
+         thief->end = from + half;
+         pthread_mutex_unlock(&thief->lock);
+         return true;
+      }
+   }
+}
+
+static void LexFile(Lexer_Batch_Worker_t *worker, size_t workerIndex, Lexer_Batch_File_t *file)
+{
+   file->worker = workerIndex;
+
+   if(!SourceFile_Open(&file->source, file->path))
+   {
+      file->openError = errno;
+      return;
+   }
+
+   file->openError = 0;
+   file->firstToken = worker->tokens.usedSize;
+   file->firstError = worker->errors.count;
+
+   // Lexer_StaticLookup only ever adds to the end of the list, so every file's
+   // tokens can share one list
+   Lexer_LexSpan(&worker->lexer.interface, file->source.data, file->source.length, &worker->tokens.interface);
+
+   file->tokenCount = worker->tokens.usedSize - file->firstToken;
+   file->errorCount = worker->errors.count - file->firstError;
+}
+
+typedef struct
+{
+   Lexer_Batch_t *batch;
+   size_t worker;
+} Work_Argument_t;
+
+static void *Work(void *argument)
+{
+   REINTERPRET(work, argument, Work_Argument_t *);
+   Lexer_Batch_Worker_t *worker = &work->batch->workers[work->worker];
+   size_t index;
+
+   do
+   {
+      while(TakeNext(worker, &index))
+      {
+         LexFile(worker, work->worker, &work->batch->files[index]);
+      }
+   } while(Steal(work->batch, worker));
+
+   return NULL;
+}
+
+void Lexer_Batch_Init(Lexer_Batch_t *instance, const char * const *paths, size_t pathCount, size_t threadCount)
+{
+   if(threadCount == 0)
+   {
+      threadCount = Threads_DefaultCount();
+   }
+
+   if(threadCount > pathCount / LEXER_BATCH_MIN_FILES_PER_THREAD)
+   {
+      threadCount = pathCount / LEXER_BATCH_MIN_FILES_PER_THREAD;
+   }
+
+   if(threadCount == 0)
+   {
+      threadCount = 1;
+   }
+
+   instance->fileCount = pathCount;
+   instance->files = calloc(pathCount, sizeof(Lexer_Batch_File_t));
+   for(size_t i = 0; i < pathCount; i++)
+   {
+      instance->files[i].path = paths[i];
+      instance->files[i].openError = ENOENT;
+   }
+
+   instance->workerCount = threadCount;
+   instance->workers = calloc(threadCount, sizeof(Lexer_Batch_Worker_t));
+   for(size_t w = 0; w < threadCount; w++)
+   {
+      Lexer_Batch_Worker_t *worker = &instance->workers[w];
+
+      List_Calloc_Init(&worker->tokens, sizeof(Token_t));
+      Error_Buffer_Init(&worker->errors);
+      Lexer_StaticLookup_Init(&worker->lexer, &worker->errors.interface);
+      pthread_mutex_init(&worker->lock, NULL);
+   }
+}
+
+void Lexer_Batch_Deinit(Lexer_Batch_t *instance)
+{
+   for(size_t i = 0; i < instance->fileCount; i++)
+   {
+      if(instance->files[i].openError == 0)
+      {
+         SourceFile_Close(&instance->files[i].source);
+      }
+   }
+
+   for(size_t w = 0; w < instance->workerCount; w++)
+   {
+      Lexer_Batch_Worker_t *worker = &instance->workers[w];
+
+      Lexer_StaticLookup_Deinit(&worker->lexer);
+      List_Calloc_Deinit(&worker->tokens);
+      Error_Buffer_Deinit(&worker->errors);
+      pthread_mutex_destroy(&worker->lock);
+   }
+
+   free(instance->workers);
+   free(instance->files);
+}
+
+void Lexer_Batch_Run(Lexer_Batch_t *instance)
+{
+   Work_Argument_t *arguments = malloc(instance->workerCount * sizeof(Work_Argument_t));
+
+   for(size_t w = 0; w < instance->workerCount; w++)
+   {
+      arguments[w].batch = instance;
+      arguments[w].worker = w;
+      instance->workers[w].next = instance->fileCount * w / instance->workerCount;
+      instance->workers[w].end = instance->fileCount * (w + 1) / instance->workerCount;
+   }
+
+   // The calling thread is worker 0. A worker whose thread couldn't be created
+   // runs after it, by which time the others have usually stolen its files.
+   Threads_RunAll(arguments, instance->workerCount, sizeof(Work_Argument_t), &Work);
+
+   free(arguments);
+}
+
+int Lexer_Batch_OpenError(Lexer_Batch_t *instance, size_t index)
+{
+   return instance->files[index].openError;
+}
+
+const Token_t *Lexer_Batch_Tokens(Lexer_Batch_t *instance, size_t index, size_t *count)
+{
+   Lexer_Batch_File_t *file = &instance->files[index];
+   Token_t *first = NULL;
+
+   // A file's tokens were added one after another to the same List_Calloc,
+   // so they sit next to each other in its storage
+   *count = 0;
+   if(file->openError == 0 && file->tokenCount > 0)
+   {
+      List_At(&instance->workers[file->worker].tokens.interface, file->firstToken, (void **)&first);
+      *count = file->tokenCount;
+   }
+
+   return first;
+}
+
+size_t Lexer_Batch_ReportErrors(Lexer_Batch_t *instance, size_t index, I_Error_t *errorHandler)
+{
+   Lexer_Batch_File_t *file = &instance->files[index];
+
+   if(file->openError != 0)
+   {
+      return 0;
+   }
+
+   Error_Buffer_ReplayRange(&instance->workers[file->worker].errors, errorHandler, file->firstError, file->errorCount, 0);
+   return file->errorCount;
+}
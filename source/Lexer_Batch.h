@@ -0,0 +1,95 @@
+/***
+ * File: Lexer_Batch.h
+ * Desc: Lexes many source files on a pool of threads. Each thread keeps one
+ *       Lexer_StaticLookup, token list and error buffer for every file it lexes,
+ *       and threads that run out of files steal half of another thread's.
+ */
+
+#ifndef _LEXER_BATCH_H
+#define _LEXER_BATCH_H
+
+#include <stdbool.h>
+#include <pthread.h>
+#include "Lexer_StaticLookup.h"
+#include "List_Calloc.h"
+#include "Error_Buffer.h"
+#include "SourceFile.h"
+#include "Token.h"
+
+typedef struct
+{
+   const char *path;
+   SourceFile_t source;
+   int openError;
+
+   // Where the results are kept, in the lists of the worker that lexed the file
+   size_t worker;
+   size_t firstToken;
+   size_t tokenCount;
+   size_t firstError;
+   size_t errorCount;
+} Lexer_Batch_File_t;
+
+typedef struct
+{
+   Lexer_StaticLookup_t lexer;
+   List_Calloc_t tokens;
+   Error_Buffer_t errors;
+
+   // Files this worker still has to lex; others may take from the back
+   pthread_mutex_t lock;
+   size_t next;
+   size_t end;
+} Lexer_Batch_Worker_t;
+
+typedef struct
+{
+   Lexer_Batch_File_t *files;
+   size_t fileCount;
+
+   Lexer_Batch_Worker_t *workers;
+   size_t workerCount;
+} Lexer_Batch_t;
+
+/*
+ * Initialize a Lexer_Batch.
+ *
+ * @param paths - files to lex; must stay valid until Lexer_Batch_Deinit
+ * @param threadCount - most threads to lex with, or 0 for one per online CPU
+ */
+void Lexer_Batch_Init(Lexer_Batch_t *instance, const char * const *paths, size_t pathCount, size_t threadCount);
+
+/*
+ * Close every file and free the results.
+ */
+void Lexer_Batch_Deinit(Lexer_Batch_t *instance);
+
+/*
+ * Lex every file. Returns once all of them are done.
+ */
+void Lexer_Batch_Run(Lexer_Batch_t *instance);
+
+/*
+ * Why a file couldn't be opened. A file that couldn't be opened has no tokens
+ * or errors.
+ *
+ * @return - 0 if the file was opened, errno from opening it otherwise
+ */
+int Lexer_Batch_OpenError(Lexer_Batch_t *instance, size_t index);
+
+/*
+ * The tokens of a file, in order. They point into the file's contents, which
+ * stay mapped until Lexer_Batch_Deinit.
+ *
+ * @param count - set to the number of tokens
+ */
+const Token_t *Lexer_Batch_Tokens(Lexer_Batch_t *instance, size_t index, size_t *count);
+
+/*
+ * Report the errors found in a file to an error handler, in order.
+ *
+ * @return - number of errors reported
+ */
+size_t Lexer_Batch_ReportErrors(Lexer_Batch_t *instance, size_t index, I_Error_t *errorHandler);
+
+#endif
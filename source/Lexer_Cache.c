@@ -0,0 +1,469 @@
+/***
+ * File: Lexer_Cache.c
+ *
+ * An entry keeps each token as an offset into the source, so it can be handed
+ * back for any buffer holding the same bytes.
+ *
+ * On disk an entry is one file named after the source's hash and length:
+ * a header, the tokens, and then the errors as Error_Buffer keeps them. Files
+ * are written under a temporary name and renamed into place, so a reader never
+ * sees half of one. They're only meant to be read by the build that wrote them,
+ * but every record is still checked before it's used, and a file that doesn't
+ * hold together is treated as a miss.
+ */
+
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include "Lexer_Cache.h"
+#include "Hash.h"
+#include "Token.h"
+#include "util.h"
+
+#define LEXER_CACHE_FIRST_BUCKET_COUNT (64)
+#define LEXER_CACHE_MAGIC ("LEXCACH1")
+
+typedef struct
+{
+   size_t offset;
+   size_t length;
+   size_t line;
+   Token_Type_t type;
+} Lexer_Cache_Token_t;
+
+struct Lexer_Cache_Entry_t
+{
+   uint64_t hash;
+   size_t length;                      // Of the source
+   Lexer_Cache_Entry_t *nextInBucket;
+   Lexer_Cache_Entry_t *newer;
+   Lexer_Cache_Entry_t *older;
+
+   Lexer_Cache_Token_t *tokens;
+   size_t tokenCount;
+   Error_Buffer_t errors;
+   size_t bytes;                       // Counted against the budget
+};
+
+typedef struct
+{
+   char magic[8];
+   uint64_t hash;
+   uint64_t length;
+   uint64_t tokenCount;
+   uint64_t errorCount;
+   uint64_t textSize;
+   uint64_t tokenSize;                 // Catches files from a build with a different token layout
+} Lexer_Cache_FileHeader_t;
+
+/*********************************
+ * Entries
+ *********************************/
+static Lexer_Cache_Entry_t *NewEntry(uint64_t hash, size_t length, size_t tokenCount)
+{
+   Lexer_Cache_Entry_t *entry = malloc(sizeof(Lexer_Cache_Entry_t));
+
+   entry->hash = hash;
+   entry->length = length;
+   entry->nextInBucket = NULL;
+   entry->newer = NULL;
+   entry->older = NULL;
+   entry->tokens = malloc(tokenCount * sizeof(Lexer_Cache_Token_t) + 1);
+   entry->tokenCount = tokenCount;
+   Error_Buffer_Init(&entry->errors);
+   entry->bytes = 0;
+
+   return entry;
+}
+
+static void CountBytes(Lexer_Cache_Entry_t *entry)
+{
+   entry->bytes = sizeof(Lexer_Cache_Entry_t) + entry->tokenCount * sizeof(Lexer_Cache_Token_t) +
+                  entry->errors.allocatedCount * sizeof(Error_Buffer_Entry_t) + entry->errors.textAllocated;
+}
+
+static void FreeEntry(Lexer_Cache_Entry_t *entry)
+{
+   Error_Buffer_Deinit(&entry->errors);
+   free(entry->tokens);
+   free(entry);
+}
+
+static size_t BucketOf(const Lexer_Cache_t *instance, uint64_t hash)
+{
+   return hash & (instance->bucketCount - 1);
+}
+
+static Lexer_Cache_Entry_t *Find(Lexer_Cache_t *instance, uint64_t hash, size_t length)
+{
+   Lexer_Cache_Entry_t *entry = instance->buckets[BucketOf(instance, hash)];
+
+   while(entry != NULL && (entry->hash != hash || entry->length != length))
+   {
+      entry = entry->nextInBucket;
+   }
+
+   return entry;
+}
+
+static void Unlink(Lexer_Cache_t *instance, Lexer_Cache_Entry_t *entry)
+{
+   *(entry->newer != NULL ? &entry->newer->older : &instance->newest) = entry->older;
+   *(entry->older != NULL ? &entry->older->newer : &instance->oldest) = entry->newer;
+}
+
+static void LinkAsNewest(Lexer_Cache_t *instance, Lexer_Cache_Entry_t *entry)
+{
+   entry->newer = NULL;
+   entry->older = instance->newest;
+   *(instance->newest != NULL ? &instance->newest->newer : &instance->oldest) = entry;
+   instance->newest = entry;
+}
+
+static void Evict(Lexer_Cache_t *instance, Lexer_Cache_Entry_t *entry)
+{
+   Lexer_Cache_Entry_t **link = &instance->buckets[BucketOf(instance, entry->hash)];
+
+   while(*link != entry)
+   {
+      link = &(*link)->nextInBucket;
+   }
+   *link = entry->nextInBucket;
+
+   Unlink(instance, entry);
+   instance->stats.entries--;
+   instance->stats.bytes -= entry->bytes;
+   instance->stats.evictions++;
+   FreeEntry(entry);
+}
+
+static void GrowBuckets(Lexer_Cache_t *instance)
+{
+   Lexer_Cache_Entry_t **old = instance->buckets;
+   size_t oldCount = instance->bucketCount;
+
+   instance->bucketCount = (oldCount > 0) ? oldCount * 2 : LEXER_CACHE_FIRST_BUCKET_COUNT;
+   instance->buckets = calloc(instance->bucketCount, sizeof(Lexer_Cache_Entry_t *));
+
+   for(size_t i = 0; i < oldCount; i++)
+   {
+      while(old[i] != NULL)
+      {
+         Lexer_Cache_Entry_t *entry = old[i];
+         size_t bucket = BucketOf(instance, entry->hash);
+
+         old[i] = entry->nextInBucket;
+         entry->nextInBucket = instance->buckets[bucket];
+         instance->buckets[bucket] = entry;
+      }
+   }
+
+   free(old);
+}
+
+/*
+ * Keep an entry in memory as the newest, dropping the oldest to stay within the
+ * budget.
+ *
+ * @return - false if the entry alone is over the budget and wasn't kept
+ */
+static bool Keep(Lexer_Cache_t *instance, Lexer_Cache_Entry_t *entry)
+{
+   size_t bucket;
+
+   if(entry->bytes > instance->budget)
+   {
+      return false;
+   }
+
+   while(instance->stats.bytes + entry->bytes > instance->budget)
+   {
+      Evict(instance, instance->oldest);
+   }
+
+   if(instance->stats.entries >= instance->bucketCount)
+   {
+      GrowBuckets(instance);
+   }
+
+   bucket = BucketOf(instance, entry->hash);
+   entry->nextInBucket = instance->buckets[bucket];
+   instance->buckets[bucket] = entry;
+   LinkAsNewest(instance, entry);
+
+   instance->stats.entries++;
+   instance->stats.bytes += entry->bytes;
+   return true;
+}
+
+/*********************************
+ * Disk
+ *********************************/
+static void PathOf(const Lexer_Cache_t *instance, uint64_t hash, size_t length, char *path, size_t size)
+{
+   snprintf(path, size, "%s/%016llx-%zx.tokens", instance->directory, (unsigned long long)hash, length);
+}
+
+/*
+ * Whether the counts in a header fit the size of its file exactly.
+ */
+static bool SizesFit(const Lexer_Cache_FileHeader_t *header, uint64_t size)
+{
+   if(size < sizeof(*header))
+   {
+      return false;
+   }
+   size -= sizeof(*header);
+
+   if(header->tokenCount > size / sizeof(Lexer_Cache_Token_t))
+   {
+      return false;
+   }
+   size -= header->tokenCount * sizeof(Lexer_Cache_Token_t);
+
+   if(header->errorCount > size / sizeof(Error_Buffer_Entry_t))
+   {
+      return false;
+   }
+   size -= header->errorCount * sizeof(Error_Buffer_Entry_t);
+
+   return header->textSize == size;
+}
+
+/*
+ * Whether every token lies within the source and every error's message within
+ * the text.
+ */
+static bool RecordsFit(const Lexer_Cache_Entry_t *entry)
+{
+   for(size_t i = 0; i < entry->tokenCount; i++)
+   {
+      const Lexer_Cache_Token_t *token = &entry->tokens[i];
+
+      if((unsigned)token->type >= Token_Type_Count || token->offset > entry->length || token->length > entry->length - token->offset)
+      {
+         return false;
+      }
+   }
+
+   for(size_t i = 0; i < entry->errors.count; i++)
+   {
+      if(entry->errors.entries[i].message >= entry->errors.textUsed)
+      {
+         return false;
+      }
+   }
+
+   return true;
+}
+
+static Lexer_Cache_Entry_t *Load(Lexer_Cache_t *instance, uint64_t hash, size_t length)
+{
+   char path[strlen(instance->directory) + 64];
+   Lexer_Cache_FileHeader_t header;
+   Lexer_Cache_Entry_t *entry;
+   FILE *file;
+   long size;
+   bool complete;
+
+   PathOf(instance, hash, length, path, sizeof(path));
+   file = fopen(path, "rb");
+   if(file == NULL)
+   {
+      return NULL;
+   }
+
+   if(fseek(file, 0, SEEK_END) != 0 || (size = ftell(file)) < 0 || fseek(file, 0, SEEK_SET) != 0 ||
+      fread(&header, sizeof(header), 1, file) != 1 || memcmp(header.magic, LEXER_CACHE_MAGIC, sizeof(header.magic)) != 0 ||
+      header.hash != hash || header.length != length || header.tokenSize != sizeof(Lexer_Cache_Token_t) ||
+      !SizesFit(&header, (uint64_t)size))
+   {
+      fclose(file);
+      return NULL;
+   }
+
+   entry = NewEntry(hash, length, header.tokenCount);
+   entry->errors.entries = malloc(header.errorCount * sizeof(Error_Buffer_Entry_t) + 1);
+   entry->errors.count = header.errorCount;
+   entry->errors.allocatedCount = header.errorCount;
+   entry->errors.text = malloc(header.textSize + 1);
+   entry->errors.textUsed = header.textSize;
+   entry->errors.textAllocated = header.textSize;
+
+   complete = fread(entry->tokens, sizeof(Lexer_Cache_Token_t), header.tokenCount, file) == header.tokenCount &&
+              fread(entry->errors.entries, sizeof(Error_Buffer_Entry_t), header.errorCount, file) == header.errorCount &&
+              fread(entry->errors.text, 1, header.textSize, file) == header.textSize;
+   fclose(file);
+   entry->errors.text[header.textSize] = '\0';
+
+   if(!complete || !RecordsFit(entry))
+   {
+      FreeEntry(entry);
+      return NULL;
+   }
+
+   CountBytes(entry);
+   return entry;
+}
+
+static void Save(Lexer_Cache_t *instance, const Lexer_Cache_Entry_t *entry)
+{
+   char path[strlen(instance->directory) + 64];
+   char temporary[sizeof(path) + 32];
+   Lexer_Cache_FileHeader_t header = { .hash = entry->hash, .length = entry->length, .tokenCount = entry->tokenCount,
+                                       .errorCount = entry->errors.count, .textSize = entry->errors.textUsed,
+                                       .tokenSize = sizeof(Lexer_Cache_Token_t) };
+   FILE *file;
+   bool written;
+
+   memcpy(header.magic, LEXER_CACHE_MAGIC, sizeof(header.magic));
+   PathOf(instance, entry->hash, entry->length, path, sizeof(path));
+   snprintf(temporary, sizeof(temporary), "%s.%ld", path, (long)getpid());
+
+   file = fopen(temporary, "wb");
+   if(file == NULL)
+   {
+      return;
+   }
+
+   written = fwrite(&header, sizeof(header), 1, file) == 1 &&
+             fwrite(entry->tokens, sizeof(Lexer_Cache_Token_t), entry->tokenCount, file) == entry->tokenCount &&
+             fwrite(entry->errors.entries, sizeof(Error_Buffer_Entry_t), entry->errors.count, file) == entry->errors.count &&
+             fwrite(entry->errors.text, 1, entry->errors.textUsed, file) == entry->errors.textUsed;
+   written = (fclose(file) == 0) && written;
+
+   // A cache that can't be written to is only slower, so failures are dropped
+   if(!written || rename(temporary, path) != 0)
+   {
+      remove(temporary);
+   }
+}
+
+/*********************************
+ * Lexing
+ *********************************/
+static Lexer_Cache_Entry_t *Lex(Lexer_Cache_t *instance, const char *source, size_t length, uint64_t hash)
+{
+   Lexer_Cache_Entry_t *entry;
+   size_t count;
+
+   // The lexer only adds to the list, so it can reuse the storage of the last miss
+   Error_Buffer_Clear(&instance->errors);
+   instance->tokens.usedSize = 0;
+   Lexer_LexSpan(instance->lexer, source, length, &instance->tokens.interface);
+
+   count = instance->tokens.usedSize;
+   entry = NewEntry(hash, length, count);
+   for(size_t i = 0; i < count; i++)
+   {
+      Token_t *token;
+
+      List_At(&instance->tokens.interface, i, (void **)&token);
+      entry->tokens[i].offset = token->lexeme - source;
+      entry->tokens[i].length = token->length;
+      entry->tokens[i].line = token->line;
+      entry->tokens[i].type = token->type;
+   }
+
+   Error_Buffer_Replay(&instance->errors, &entry->errors.interface, 0);
+   CountBytes(entry);
+   return entry;
+}
+
+static void Give(Lexer_Cache_t *instance, const Lexer_Cache_Entry_t *entry, const char *source, I_List_t *tokens)
+{
+   Token_t token;
+
+   for(size_t i = 0; i < entry->tokenCount; i++)
+   {
+      token.type = entry->tokens[i].type;
+      token.lexeme = source + entry->tokens[i].offset;
+      token.length = entry->tokens[i].length;
+      token.line = entry->tokens[i].line;
+      List_Add(tokens, &token);
+   }
+
+   Error_Buffer_Replay((Error_Buffer_t *)&entry->errors, instance->errorHandler, 0);
+}
+
+static void lexSpan(I_Lexer_t *interface, const char *source, size_t length, I_List_t *tokens)
+{
+   REINTERPRET(instance, interface, Lexer_Cache_t *);
+   uint64_t hash = Hash_Bytes(source, length, 0);
+   Lexer_Cache_Entry_t *entry = Find(instance, hash, length);
+
+   if(entry != NULL)
+   {
+      instance->stats.hits++;
+      Unlink(instance, entry);
+      LinkAsNewest(instance, entry);
+      Give(instance, entry, source, tokens);
+      return;
+   }
+
+   if(instance->directory != NULL && (entry = Load(instance, hash, length)) != NULL)
+   {
+      instance->stats.diskHits++;
+   }
+   else
+   {
+      instance->stats.misses++;
+      entry = Lex(instance, source, length, hash);
+      if(instance->directory != NULL)
+      {
+         Save(instance, entry);
+      }
+   }
+
+   Give(instance, entry, source, tokens);
+   if(!Keep(instance, entry))
+   {
+      FreeEntry(entry);
+   }
+}
+
+static void lex(I_Lexer_t *interface, const char *source, I_List_t *tokens)
+{
+   lexSpan(interface, source, strlen(source), tokens);
+}
+
+void Lexer_Cache_Init(Lexer_Cache_t *instance, I_Lexer_t *lexer, I_Error_t *errorHandler, size_t budget)
+{
+   instance->interface.lex = &lex;
+   instance->interface.lexSpan = &lexSpan;
+
+   instance->lexer = lexer;
+   instance->errorHandler = errorHandler;
+   Error_Buffer_Init(&instance->errors);
+   List_Calloc_Init(&instance->tokens, sizeof(Token_t));
+
+   instance->budget = budget;
+   instance->directory = NULL;
+
+   instance->buckets = NULL;
+   instance->bucketCount = 0;
+   instance->newest = NULL;
+   instance->oldest = NULL;
+   GrowBuckets(instance);
+
+   memset(&instance->stats, 0, sizeof(instance->stats));
+}
+
+void Lexer_Cache_Deinit(Lexer_Cache_t *instance)
+{
+   while(instance->oldest != NULL)
+   {
+      Evict(instance, instance->oldest);
+   }
+
+   free(instance->buckets);
+   List_Calloc_Deinit(&instance->tokens);
+   Error_Buffer_Deinit(&instance->errors);
+}
+
+void Lexer_Cache_SetDirectory(Lexer_Cache_t *instance, const char *directory)
+{
+   instance->directory = directory;
+}
@@ -0,0 +1,80 @@
+/***
+ * File: Lexer_Cache.h
+ * Desc: Implementation of I_Lexer that remembers the tokens and errors of each
+ *       source it lexes, by a hash of the source's bytes, and gives them back
+ *       without lexing when the same bytes come again. Wraps another I_Lexer,
+ *       which does the lexing when the source hasn't been seen.
+ *
+ *       Sources are told apart by their length and 64-bit hash alone.
+ */
+
+#ifndef _LEXER_CACHE_H
+#define _LEXER_CACHE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "I_Lexer.h"
+#include "I_Error.h"
+#include "Error_Buffer.h"
+#include "List_Calloc.h"
+
+typedef struct Lexer_Cache_Entry_t Lexer_Cache_Entry_t;
+
+typedef struct
+{
+   size_t hits;         // Sources found in memory
+   size_t diskHits;     // Sources found in the cache directory
+   size_t misses;       // Sources lexed
+   size_t evictions;    // Entries dropped to stay within the budget
+   size_t entries;      // Entries in memory now
+   size_t bytes;        // Memory they use
+} Lexer_Cache_Stats_t;
+
+typedef struct
+{
+   I_Lexer_t interface;
+
+   I_Lexer_t *lexer;
+   I_Error_t *errorHandler;
+   Error_Buffer_t errors;     // The wrapped lexer must report its errors here
+   List_Calloc_t tokens;      // What the wrapped lexer lexes into
+
+   size_t budget;             // Most bytes of entries kept in memory
+   const char *directory;     // Where entries are also kept on disk, or NULL
+
+   // Entries by hash, and from most to least recently used
+   Lexer_Cache_Entry_t **buckets;
+   size_t bucketCount;
+   Lexer_Cache_Entry_t *newest;
+   Lexer_Cache_Entry_t *oldest;
+
+   Lexer_Cache_Stats_t stats;
+} Lexer_Cache_t;
+
+/*
+ * Initialize a Lexer_Cache. The wrapped lexer must already be set up to report
+ * its errors to &instance->errors.interface, e.g.
+ *
+ *    Lexer_StaticLookup_Init(&lexer, &cache.errors.interface);
+ *    Lexer_Cache_Init(&cache, &lexer.interface, errorHandler, budget);
+ *
+ * @param lexer - does the lexing when a source isn't in the cache
+ * @param errorHandler - gets the errors of each source, whether lexed or cached
+ * @param budget - most bytes of tokens and errors to keep in memory
+ */
+void Lexer_Cache_Init(Lexer_Cache_t *instance, I_Lexer_t *lexer, I_Error_t *errorHandler, size_t budget);
+
+/*
+ * Free every entry kept in memory. Entries on disk stay.
+ */
+void Lexer_Cache_Deinit(Lexer_Cache_t *instance);
+
+/*
+ * Also keep entries as files in a directory, so they outlive the process and
+ * are shared with others using the same directory.
+ *
+ * @param directory - existing directory, or NULL to stop; must outlive the cache
+ */
+void Lexer_Cache_SetDirectory(Lexer_Cache_t *instance, const char *directory);
+
+#endif
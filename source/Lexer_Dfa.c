@@ -0,0 +1,511 @@
+/***
+ * File: Lexer_Dfa.c
+ *
+ * There is one state for each class of character that can start a token. Every
+ * state ends by jumping straight to the state for the character after its token,
+ * so each state has its own indirect branch for the CPU to learn, instead of
+ * every token sharing the one call through Lexer_StaticLookup's table. GCC and
+ * Clang get computed gotos; other compilers get a switch in a loop.
+ */
+
+#include <string.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include "Lexer_Dfa.h"
+#include "CharClass.h"
+#include "CharScan.h"
+#include "Diagnostics.h"
+#include "util.h"
+
+#if defined(__GNUC__) && !defined(LEXER_DFA_USE_SWITCH)
+#define LEXER_DFA_COMPUTED_GOTO
+#endif
+
+/*********************************
+ * Character tables
+ *********************************/
+enum
+{
+   Start_Unexpected = 0,
+   Start_NonAscii,
+   Start_Space,
+   Start_Newline,
+   Start_Word,          // Starts an identifier
+   Start_Digit,
+   Start_Quote,
+   Start_Bang,
+   Start_Pound,
+   Start_Dash,
+   Start_Dot,
+   Start_Colon,
+   Start_Digraph,       // Symbol that may be followed by '='
+   Start_Tilde,
+   Start_Symbol,
+
+   Start_Count
+};
+typedef uint8_t Start_t;
+
+static const Start_t starts[256] =
+{
+   [0 ... 8]   = Start_Unexpected,
+   ['\t']      = Start_Space,
+   ['\n']      = Start_Newline,
+   ['\v']      = Start_Space,
+   ['\f']      = Start_Space,
+   ['\r']      = Start_Space,
+   [14 ... 31] = Start_Unexpected,
+   [' ']       = Start_Space,
+   ['!']       = Start_Bang,
+   ['"']       = Start_Quote,
+   ['#']       = Start_Pound,
+   ['$']       = Start_Symbol,
+   ['(']       = Start_Symbol,
+   [')']       = Start_Symbol,
+   ['*']       = Start_Symbol,
+   ['+']       = Start_Symbol,
+   [',']       = Start_Symbol,
+   ['-']       = Start_Dash,
+   ['.']       = Start_Dot,
+   ['/']       = Start_Symbol,
+   ['0' ... '9'] = Start_Digit,
+   [':']       = Start_Colon,
+   ['<']       = Start_Digraph,
+   ['=']       = Start_Digraph,
+   ['>']       = Start_Digraph,
+   ['?']       = Start_Word,
+   ['@']       = Start_Symbol,
+   ['A' ... 'Z'] = Start_Word,
+   ['[']       = Start_Symbol,
+   [']']       = Start_Symbol,
+   ['_']       = Start_Word,
+   ['`']       = Start_Symbol,
+   ['a' ... 'z'] = Start_Word,
+   ['{']       = Start_Symbol,
+   ['}']       = Start_Symbol,
+   ['~']       = Start_Tilde,
+   [128 ... 255] = Start_NonAscii
+};
+
+static const Token_Type_t symbolTypes[128] =
+{
+   ['$'] = Token_Type_Dollar,
+   ['('] = Token_Type_Paren_Left,
+   [')'] = Token_Type_Paren_Right,
+   ['*'] = Token_Type_Asterisk,
+   ['+'] = Token_Type_Plus,
+   [','] = Token_Type_Comma,
+   ['/'] = Token_Type_Slash,
+   ['<'] = Token_Type_AngleBracket_Left,
+   ['='] = Token_Type_Equal,
+   ['>'] = Token_Type_AngleBracket_Right,
+   ['@'] = Token_Type_Arroba,
+   ['['] = Token_Type_SquareBrace_Left,
+   [']'] = Token_Type_SquareBrace_Right,
+   ['`'] = Token_Type_Backtick,
+   ['{'] = Token_Type_CurlyBrace_Left,
+   ['}'] = Token_Type_CurlyBrace_Right
+};
+
+static const Token_Type_t digraphTypes[128] =
+{
+   ['<'] = Token_Type_LessEqual,
+   ['='] = Token_Type_EqualEqual,
+   ['>'] = Token_Type_GreaterEqual
+};
+
+/*********************************
+ * Looking around a token
+ *********************************/
+// Character ahead of at, or a space past the end of the source
+static inline char Ahead(const Lexer_Dfa_t *instance, const char *at, size_t ahead)
+{
+   return ((size_t)(instance->end - at) > ahead) ? at[ahead] : ' ';
+}
+
+// Character before at, or a space at the start of the source
+static inline char Behind(const Lexer_Dfa_t *instance, const char *at)
+{
+   return (at == instance->beginning) ? ' ' : at[-1];
+}
+
+static void AddToken(Lexer_Dfa_t *instance, Token_Type_t type, const char *lexeme, size_t length, size_t line)
+{
+   if(instance->typedTokens != NULL)
+   {
+      *TokenList_Emplace(instance->typedTokens) = (Token_t){ type, lexeme, length, line };
+      return;
+   }
+
+   instance->token.type = type;
+   instance->token.lexeme = lexeme;
+   instance->token.length = length;
+   instance->token.line = line;
+
+   List_Add(instance->tokenList, &instance->token);
+}
+
+/*********************************
+ * Tokens longer than a character, and errors
+ *
+ * Each takes the start of its token and returns where the next one starts.
+ *********************************/
+/*
+ * Format an error and report it.
+ *
+ * @param lexeme - what the error is about, if its message quotes it
+ * @param first, second - characters the message needs besides the lexeme
+ */
+static void Report(Lexer_Dfa_t *instance, Diagnostic_Code_t code, const char *lexeme, size_t length, char first, char second, size_t line)
+{
+   Diagnostic_t diagnostic =
+   {
+      .code = code,
+      .extra = { first, second },
+      .length = length,
+      .offset = lexeme - instance->beginning,
+      .line = line
+   };
+
+   Diagnostic_Report(&diagnostic, instance->beginning, instance->errorHandler, line);
+}
+
+static void CheckSpacing(Lexer_Dfa_t *instance, const char *symbol, size_t length, size_t line)
+{
+   char left = Behind(instance, symbol);
+   char right = Ahead(instance, symbol, length);
+   bool touchyOnLeft = CharClass_Is(left, CharClass_Touchy);
+   bool touchyOnRight = CharClass_Is(right, CharClass_Touchy);
+
+   if(touchyOnLeft && touchyOnRight)
+   {
+      Report(instance, Diagnostic_Code_TouchySymbol, symbol, length, left, right, line);
+   }
+   else if(touchyOnLeft)
+   {
+      Report(instance, Diagnostic_Code_TouchySymbol, symbol, length, left, '\0', line);
+   }
+   else if(touchyOnRight)
+   {
+      Report(instance, Diagnostic_Code_TouchySymbol, symbol, length, right, '\0', line);
+   }
+}
+
+static const char *Symbol(Lexer_Dfa_t *instance, const char *symbol, size_t length, Token_Type_t type, bool touchy, size_t line)
+{
+   if(touchy)
+   {
+      CheckSpacing(instance, symbol, length, line);
+   }
+
+   AddToken(instance, type, symbol, length, line);
+   return symbol + length;
+}
+
+static const char *Identifier(Lexer_Dfa_t *instance, const char *beginning, size_t line)
+{
+   bool validIdentifier = false;
+   size_t length = CharScan_Identifier(beginning, instance->end, &validIdentifier);
+
+   if(validIdentifier)
+   {
+      AddToken(instance, Token_Type_Identifier, beginning, length, line);
+   }
+   else
+   {
+      Report(instance, Diagnostic_Code_IdentifierMissingLetter, beginning, length, '\0', '\0', line);
+   }
+
+   return beginning + length;
+}
+
+static const char *SymbolicLiteral(Lexer_Dfa_t *instance, const char *beginning, size_t line)
+{
+   bool validSymbolic = false;
+   size_t length = 1 + CharScan_Identifier(beginning + 1, instance->end, &validSymbolic);
+
+   if(validSymbolic)
+   {
+      AddToken(instance, Token_Type_Literal_Symbol, beginning, length, line);
+   }
+   else
+   {
+      Report(instance, Diagnostic_Code_SymbolMissingLetter, beginning, length, '\0', '\0', line);
+   }
+
+   return beginning + length;
+}
+
+static const char *Number(Lexer_Dfa_t *instance, const char *beginning, size_t line, bool missingSpaceBefore)
+{
+   Token_Type_t type = Token_Type_Literal_Number;
+   bool containsDecimalPoint = (*beginning == '.');
+   const char *current = beginning + 1;
+
+   current += CharScan_Digits(current, instance->end);
+
+   if(!containsDecimalPoint && current < instance->end && *current == '.')
+   {
+      containsDecimalPoint = true;
+      current++;
+      current += CharScan_Digits(current, instance->end);
+   }
+
+   if(!containsDecimalPoint && current < instance->end && (*current == '\'' || *current == '"'))
+   {
+      type = Token_Type_Identifier;
+      current++;
+   }
+
+   if(missingSpaceBefore)
+   {
+      Report(instance, Diagnostic_Code_MissingSpaceBeforeDecimal, beginning, 0, '\0', '\0', line);
+   }
+   AddToken(instance, type, beginning, current - beginning, line);
+   return current;
+}
+
+static const char *StringLiteral(Lexer_Dfa_t *instance, const char *beginning, size_t *line)
+{
+   const char *current = beginning + 1;
+   size_t lineBreaks = 0;
+
+   current += CharScan_StringBody(current, instance->end);
+   while(current < instance->end && *current == '\n')
+   {
+      lineBreaks++;
+      current++;
+      current += CharScan_StringBody(current, instance->end);
+   }
+
+   for(; lineBreaks > 0; lineBreaks--)
+   {
+      Report(instance, Diagnostic_Code_StringNotOnOneLine, beginning, 0, '\0', '\0', *line);
+      (*line)++;
+   }
+
+   if(current == instance->end || *current != '"')
+   {
+      Report(instance, Diagnostic_Code_StringMissingEnd, beginning, 0, '\0', '\0', *line);
+      return current;
+   }
+
+   current++;
+   AddToken(instance, Token_Type_Literal_String, beginning, current - beginning, *line);
+   return current;
+}
+
+static void ReportUnexpectedCharacter(Lexer_Dfa_t *instance, const char *at, size_t line)
+{
+   if(CharClass_Is(*at, CharClass_Control))
+   {
+      Report(instance, Diagnostic_Code_NonPrintableCharacter, at, 0, '\0', '\0', line);
+   }
+   else
+   {
+      Report(instance, Diagnostic_Code_UnexpectedCharacter, at, 1, *at, '\0', line);
+   }
+}
+
+/*********************************
+ * State machine
+ *********************************/
+#ifdef LEXER_DFA_COMPUTED_GOTO
+#define STATE(name) State_##name:
+#define NEXT() \
+   do \
+   { \
+      if(current >= end) goto Done; \
+      goto *states[starts[(uint8_t)*current]]; \
+   } while(0)
+#else
+#define STATE(name) case Start_##name:
+#define NEXT() continue
+#endif
+
+static void lexSpan(I_Lexer_t *interface, const char *source, size_t length, I_List_t *tokenList)
+{
+   REINTERPRET(instance, interface, Lexer_Dfa_t *);
+   const char *current = source;
+   const char *end = source + length;
+   size_t line = 1;
+
+#ifdef LEXER_DFA_COMPUTED_GOTO
+   static const void *states[Start_Count] =
+   {
+      [Start_Unexpected] = &&State_Unexpected,
+      [Start_NonAscii]   = &&State_NonAscii,
+      [Start_Space]      = &&State_Space,
+      [Start_Newline]    = &&State_Newline,
+      [Start_Word]       = &&State_Word,
+      [Start_Digit]      = &&State_Digit,
+      [Start_Quote]      = &&State_Quote,
+      [Start_Bang]       = &&State_Bang,
+      [Start_Pound]      = &&State_Pound,
+      [Start_Dash]       = &&State_Dash,
+      [Start_Dot]        = &&State_Dot,
+      [Start_Colon]      = &&State_Colon,
+      [Start_Digraph]    = &&State_Digraph,
+      [Start_Tilde]      = &&State_Tilde,
+      [Start_Symbol]     = &&State_Symbol
+   };
+#endif
+
+   instance->beginning = source;
+   instance->end = end;
+   instance->tokenList = tokenList;
+   instance->typedTokens = TokenList_Of(tokenList);
+
+#ifdef LEXER_DFA_COMPUTED_GOTO
+   NEXT();
+#else
+   while(current < end)
+   {
+      switch(starts[(uint8_t)*current])
+      {
+#endif
+
+   STATE(Space)
+      current++;
+      NEXT();
+
+   STATE(Newline)
+      line++;
+      current++;
+      NEXT();
+
+   STATE(Word)
+      current = Identifier(instance, current, line);
+      NEXT();
+
+   STATE(Digit)
+      current = Number(instance, current, line, false);
+      NEXT();
+
+   STATE(Quote)
+      current = StringLiteral(instance, current, &line);
+      NEXT();
+
+   STATE(Bang)
+      if(Ahead(instance, current, 1) == '=')
+      {
+         current = Symbol(instance, current, 2, Token_Type_BangEqual, true, line);
+      }
+      else
+      {
+         current = Identifier(instance, current, line);
+      }
+      NEXT();
+
+   STATE(Pound)
+      if(CharClass_Is(Ahead(instance, current, 1), CharClass_Identifier))
+      {
+         current = Identifier(instance, current, line);
+      }
+      else
+      {
+         current = Symbol(instance, current, 1, Token_Type_Pound, true, line);
+      }
+      NEXT();
+
+   STATE(Dash)
+      if(CharClass_Is(Ahead(instance, current, 1), CharClass_Identifier))
+      {
+         current = Identifier(instance, current, line);
+      }
+      else
+      {
+         current = Symbol(instance, current, 1, Token_Type_Dash, true, line);
+      }
+      NEXT();
+
+   STATE(Dot)
+      if(CharClass_Is(Ahead(instance, current, 1), CharClass_Digit))
+      {
+         current = Number(instance, current, line, Behind(instance, current) != ' ');
+      }
+      else if(Ahead(instance, current, 1) == '.')
+      {
+         if(Ahead(instance, current, 2) == '.')
+         {
+            current = Symbol(instance, current, 3, Token_Type_DotDotDot, false, line);
+         }
+         else
+         {
+            current = Symbol(instance, current, 2, Token_Type_DotDot, false, line);
+         }
+      }
+      else
+      {
+         current = Symbol(instance, current, 1, Token_Type_Dot, false, line);
+      }
+      NEXT();
+
+   STATE(Colon)
+      if(CharClass_Is(Ahead(instance, current, 1), CharClass_Identifier))
+      {
+         current = SymbolicLiteral(instance, current, line);
+      }
+      else
+      {
+         // Colon is allowed to touch on left as long as next is a space
+         if(!CharClass_Is(Ahead(instance, current, 1), CharClass_Space))
+         {
+            Report(instance, Diagnostic_Code_MissingSpaceAfterColon, current, 0, '\0', '\0', line);
+         }
+         current = Symbol(instance, current, 1, Token_Type_Colon, false, line);
+      }
+      NEXT();
+
+   STATE(Digraph)
+      if(Ahead(instance, current, 1) == '=')
+      {
+         current = Symbol(instance, current, 2, digraphTypes[(uint8_t)*current], true, line);
+      }
+      else
+      {
+         current = Symbol(instance, current, 1, symbolTypes[(uint8_t)*current], true, line);
+      }
+      NEXT();
+
+   STATE(Tilde)
+      current = Symbol(instance, current, 1, Token_Type_Identifier, true, line);
+      NEXT();
+
+   STATE(Symbol)
+      current = Symbol(instance, current, 1, symbolTypes[(uint8_t)*current], CharClass_Is(*current, CharClass_Touchy), line);
+      NEXT();
+
+   STATE(Unexpected)
+      ReportUnexpectedCharacter(instance, current, line);
+      current++;
+      NEXT();
+
+   STATE(NonAscii)
+      Report(instance, Diagnostic_Code_NonAsciiCharacter, current, 1, '\0', '\0', line);
+      current++;
+      NEXT();
+
+#ifdef LEXER_DFA_COMPUTED_GOTO
+Done:
+   return;
+#else
+      }
+   }
+#endif
+}
+
+#undef STATE
+#undef NEXT
+
+static void lex(I_Lexer_t *interface, const char *source, I_List_t *tokenList)
+{
+   lexSpan(interface, source, strlen(source), tokenList);
+}
+
+void Lexer_Dfa_Init(Lexer_Dfa_t *instance, I_Error_t *errorHandler)
+{
+   instance->interface.lex = &lex;
+   instance->interface.lexSpan = &lexSpan;
+   instance->errorHandler = errorHandler;
+}
@@ -0,0 +1,33 @@
+/***
+ * File: Lexer_Dfa.h
+ * Desc: Implementation of I_Lexer as a state machine over classes of characters,
+ *       jumping straight from state to state instead of calling through a table.
+ *       Produces the same tokens and errors as Lexer_StaticLookup.
+ */
+
+#ifndef _LEXER_DFA_H
+#define _LEXER_DFA_H
+
+#include "I_Lexer.h"
+#include "I_Error.h"
+#include "Token.h"
+#include "TokenList.h"
+
+typedef struct
+{
+   I_Lexer_t interface;
+
+   I_Error_t *errorHandler;
+   I_List_t *tokenList;
+   TokenList_t *typedTokens;  // tokenList, if it's a TokenList, so tokens are added without calling through it
+   Token_t token;
+   const char *beginning;
+   const char *end;
+} Lexer_Dfa_t;
+
+/*
+ * Initialize a Lexer_Dfa.
+ */
+void Lexer_Dfa_Init(Lexer_Dfa_t *instance, I_Error_t *errorHandler);
+
+#endif
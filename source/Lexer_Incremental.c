@@ -0,0 +1,490 @@
+/***
+ * File: Lexer_Incremental.c
+ *
+ * An edit can only change tokens from the start of the line it begins on: no
+ * token looks back past a line break. Going forward it can change everything
+ * up to a line break after the edit where the lexer is between tokens both
+ * before and after the edit, since from there on it sees the same text in the
+ * same state (the same line, just shifted). The one token that can cover a line
+ * break is a string, and a string missing its ending quote covers the rest of
+ * the text, so both move the start of re-lexing back to the line they begin on.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "Lexer_Incremental.h"
+
+#define NO_LINE_BREAK ((size_t)-1)
+
+/*********************************
+ * Text gap buffer
+ *********************************/
+static size_t TextLength(const Lexer_Incremental_t *instance)
+{
+   return instance->textCapacity - (instance->textGapEnd - instance->textGapStart);
+}
+
+static char TextAt(const Lexer_Incremental_t *instance, size_t offset)
+{
+   if(offset < instance->textGapStart)
+   {
+      return instance->text[offset];
+   }
+
+   return instance->text[offset + (instance->textGapEnd - instance->textGapStart)];
+}
+
+static void MoveTextGap(Lexer_Incremental_t *instance, size_t to)
+{
+   size_t gap = instance->textGapEnd - instance->textGapStart;
+
+   if(to < instance->textGapStart)
+   {
+      memmove(&instance->text[to + gap], &instance->text[to], instance->textGapStart - to);
+   }
+   else if(to > instance->textGapStart)
+   {
+      memmove(&instance->text[instance->textGapStart], &instance->text[instance->textGapEnd], to - instance->textGapStart);
+   }
+
+   instance->textGapStart = to;
+   instance->textGapEnd = to + gap;
+}
+
+static void ReserveText(Lexer_Incremental_t *instance, size_t needed)
+{
+   size_t after = instance->textCapacity - instance->textGapEnd;
+   size_t capacity = instance->textCapacity;
+
+   if(instance->textGapEnd - instance->textGapStart >= needed)
+   {
+      return;
+   }
+
+   while(capacity - TextLength(instance) < needed)
+   {
+      capacity = (capacity + needed) * 3 / 2;
+   }
+
+   instance->text = realloc(instance->text, capacity);
+   memmove(&instance->text[capacity - after], &instance->text[instance->textGapEnd], after);
+   instance->textGapEnd = capacity - after;
+   instance->textCapacity = capacity;
+}
+
+static size_t CountCharacter(const char *text, size_t length, char c)
+{
+   size_t count = 0;
+
+   if(length == 0)
+   {
+      return 0;
+   }
+
+   for(const char *found = memchr(text, c, length); found != NULL; found = memchr(found + 1, c, text + length - found - 1))
+   {
+      count++;
+   }
+
+   return count;
+}
+
+static size_t CountLineBreaksBetween(const Lexer_Incremental_t *instance, size_t from, size_t to)
+{
+   size_t gap = instance->textGapEnd - instance->textGapStart;
+   size_t count = 0;
+
+   if(from < instance->textGapStart)
+   {
+      size_t end = (to < instance->textGapStart) ? to : instance->textGapStart;
+      count += CountCharacter(&instance->text[from], end - from, '\n');
+      from = end;
+   }
+
+   if(from < to)
+   {
+      count += CountCharacter(&instance->text[from + gap], to - from, '\n');
+   }
+
+   return count;
+}
+
+static size_t LineStart(const Lexer_Incremental_t *instance, size_t offset)
+{
+   while(offset > 0 && TextAt(instance, offset - 1) != '\n')
+   {
+      offset--;
+   }
+
+   return offset;
+}
+
+/*********************************
+ * Token gap buffer
+ *
+ * Tokens after the gap keep their offset from the end of the text and their
+ * line from the last line. Flipping turns one form into the other.
+ *********************************/
+static Lexer_Incremental_Token_t Flip(const Lexer_Incremental_t *instance, Lexer_Incremental_Token_t token)
+{
+   token.offset = TextLength(instance) - token.offset;
+   token.line = instance->lineBreaks + 1 - token.line;
+   return token;
+}
+
+static void MoveTokenGap(Lexer_Incremental_t *instance, size_t to)
+{
+   while(instance->tokenGapStart > to)
+   {
+      instance->tokenGapStart--;
+      instance->tokenGapEnd--;
+      instance->tokens[instance->tokenGapEnd] = Flip(instance, instance->tokens[instance->tokenGapStart]);
+   }
+
+   while(instance->tokenGapStart < to)
+   {
+      instance->tokens[instance->tokenGapStart] = Flip(instance, instance->tokens[instance->tokenGapEnd]);
+      instance->tokenGapStart++;
+      instance->tokenGapEnd++;
+   }
+}
+
+static void ReserveTokens(Lexer_Incremental_t *instance, size_t needed)
+{
+   size_t after = instance->tokenCapacity - instance->tokenGapEnd;
+   size_t capacity = instance->tokenCapacity;
+
+   if(instance->tokenGapEnd - instance->tokenGapStart >= needed)
+   {
+      return;
+   }
+
+   while(capacity - Lexer_Incremental_Count(instance) < needed)
+   {
+      capacity = (capacity + needed) * 3 / 2;
+   }
+
+   instance->tokens = realloc(instance->tokens, capacity * sizeof(Lexer_Incremental_Token_t));
+   memmove(&instance->tokens[capacity - after], &instance->tokens[instance->tokenGapEnd], after * sizeof(Lexer_Incremental_Token_t));
+   instance->tokenGapEnd = capacity - after;
+   instance->tokenCapacity = capacity;
+}
+
+// Offset of a token after the gap, in the current text
+static size_t OffsetAfterGap(const Lexer_Incremental_t *instance, size_t slot)
+{
+   return TextLength(instance) - instance->tokens[slot].offset;
+}
+
+/*
+ * Index of the first token that ends after offset.
+ */
+static size_t FirstTokenEndingAfter(const Lexer_Incremental_t *instance, size_t offset)
+{
+   size_t low = 0;
+   size_t high = Lexer_Incremental_Count(instance);
+
+   while(low < high)
+   {
+      size_t middle = low + (high - low) / 2;
+      Lexer_Incremental_Token_t token;
+
+      Lexer_Incremental_At(instance, middle, &token);
+      if(token.offset + token.length > offset)
+      {
+         high = middle;
+      }
+      else
+      {
+         low = middle + 1;
+      }
+   }
+
+   return low;
+}
+
+/*
+ * Line number at offset, counting from the token before it.
+ */
+static size_t LineAt(const Lexer_Incremental_t *instance, size_t offset, size_t nextToken)
+{
+   Lexer_Incremental_Token_t token;
+
+   if(nextToken == 0)
+   {
+      return 1 + CountLineBreaksBetween(instance, 0, offset);
+   }
+
+   // A token's line is the one it ends on
+   Lexer_Incremental_At(instance, nextToken - 1, &token);
+   return token.line + CountLineBreaksBetween(instance, token.offset + token.length, offset);
+}
+
+/*********************************
+ * Re-lexing
+ *********************************/
+static void AddFresh(Lexer_Incremental_t *instance, const Lexer_Incremental_Token_t *token)
+{
+   if(instance->freshCount == instance->freshCapacity)
+   {
+      instance->freshCapacity = (instance->freshCapacity + 1) * 3 / 2;
+      instance->fresh = realloc(instance->fresh, instance->freshCapacity * sizeof(Lexer_Incremental_Token_t));
+   }
+
+   instance->fresh[instance->freshCount++] = *token;
+}
+
+/*
+ * Last line break in text[from, to), or NO_LINE_BREAK.
+ */
+static size_t LastLineBreak(const char *text, size_t from, size_t to)
+{
+   while(to > from)
+   {
+      to--;
+      if(text[to] == '\n')
+      {
+         return to;
+      }
+   }
+
+   return NO_LINE_BREAK;
+}
+
+/*
+ * Lex text[start, window) into fresh, which must be in one piece, until a new
+ * token lines up with an old one after the gap.
+ *
+ * @param keep - set to the slot of the first old token still good
+ * @param resync - set to the offset where the new tokens stop
+ * @return - false if window ended first without reaching the end of the text
+ */
+static bool Relex(Lexer_Incremental_t *instance, size_t start, size_t editEnd, size_t window, size_t line, size_t *keep, size_t *resync)
+{
+   Token_t token;
+   size_t previousEnd = start;
+   size_t old = instance->tokenGapEnd;
+
+   instance->freshCount = 0;
+   Diagnostics_Clear(&instance->diagnostics);
+   Lexer_StaticLookup_Open(&instance->lexer, &instance->text[start], window - start);
+
+   while(Lexer_StaticLookup_NextToken(&instance->lexer, &token))
+   {
+      size_t offset = token.lexeme - instance->text;
+      size_t lineBreak = LastLineBreak(instance->text, (previousEnd > editEnd) ? previousEnd : editEnd, offset);
+      Lexer_Incremental_Token_t fresh = { token.type, offset, token.length, line + token.line - 1 };
+
+      // Between tokens on a line after the edit: see if the old tokens were between tokens here too
+      if(lineBreak != NO_LINE_BREAK)
+      {
+         while(old < instance->tokenCapacity && OffsetAfterGap(instance, old) < offset)
+         {
+            old++;
+         }
+
+         if(old < instance->tokenCapacity && OffsetAfterGap(instance, old) == offset &&
+            (old == instance->tokenGapEnd || OffsetAfterGap(instance, old - 1) + instance->tokens[old - 1].length <= lineBreak))
+         {
+            *keep = old;
+            *resync = offset;
+            return true;
+         }
+      }
+
+      AddFresh(instance, &fresh);
+      previousEnd = offset + token.length;
+   }
+
+   if(window < TextLength(instance))
+   {
+      return false;
+   }
+
+   *keep = instance->tokenCapacity;
+   *resync = window;
+   return true;
+}
+
+/*
+ * Remember whether the re-lexed text ended inside a string, from the last error.
+ */
+static void NoteUnterminatedString(Lexer_Incremental_t *instance, size_t start)
+{
+   size_t count = instance->diagnostics.count;
+   const Diagnostic_t *last = (count > 0) ? Diagnostics_At(&instance->diagnostics, count - 1) : NULL;
+
+   instance->unterminated = 0;
+   if(last != NULL && last->code == Diagnostic_Code_StringMissingEnd)
+   {
+      instance->unterminated = TextLength(instance) - (start + last->offset);
+   }
+}
+
+static void ReportErrors(Lexer_Incremental_t *instance, size_t start, size_t resync, size_t line)
+{
+   for(size_t i = 0; i < instance->diagnostics.count; i++)
+   {
+      const Diagnostic_t *diagnostic = Diagnostics_At(&instance->diagnostics, i);
+
+      if(start + diagnostic->offset < resync)
+      {
+         Diagnostic_Report(diagnostic, &instance->text[start], instance->errorHandler, line + diagnostic->line - 1);
+      }
+   }
+}
+
+/*********************************
+ * Interface
+ *********************************/
+void Lexer_Incremental_Init(Lexer_Incremental_t *instance, I_Error_t *errorHandler)
+{
+   Lexer_StaticLookup_Init(&instance->lexer, errorHandler);
+   Diagnostics_Init(&instance->diagnostics, LEXER_INCREMENTAL_MAX_ERRORS, 0);
+   Lexer_StaticLookup_SetDiagnostics(&instance->lexer, &instance->diagnostics);
+   instance->errorHandler = errorHandler;
+
+   instance->text = NULL;
+   instance->textCapacity = 0;
+   instance->textGapStart = 0;
+   instance->textGapEnd = 0;
+   instance->lineBreaks = 0;
+
+   instance->tokens = NULL;
+   instance->tokenCapacity = 0;
+   instance->tokenGapStart = 0;
+   instance->tokenGapEnd = 0;
+
+   instance->unterminated = 0;
+
+   instance->fresh = NULL;
+   instance->freshCount = 0;
+   instance->freshCapacity = 0;
+}
+
+void Lexer_Incremental_Deinit(Lexer_Incremental_t *instance)
+{
+   Lexer_StaticLookup_Deinit(&instance->lexer);
+   Diagnostics_Deinit(&instance->diagnostics);
+   free(instance->text);
+   free(instance->tokens);
+   free(instance->fresh);
+}
+
+void Lexer_Incremental_Load(Lexer_Incremental_t *instance, const char *text, size_t length)
+{
+   Lexer_Incremental_Edit(instance, 0, TextLength(instance), text, length);
+}
+
+Lexer_Incremental_Change_t Lexer_Incremental_Edit(Lexer_Incremental_t *instance, size_t offset, size_t removed, const char *replacement, size_t length)
+{
+   Lexer_Incremental_Change_t change;
+   size_t start = LineStart(instance, offset);
+   size_t editEnd = offset + length;
+   size_t first;
+   size_t line;
+   size_t window;
+   size_t keep;
+   size_t resync;
+
+   // Everything after the quote of an unfinished string belongs to it
+   if(instance->unterminated > 0 && TextLength(instance) - instance->unterminated < offset + removed)
+   {
+      size_t quoteLine = LineStart(instance, TextLength(instance) - instance->unterminated);
+      start = (quoteLine < start) ? quoteLine : start;
+   }
+
+   // Start on the line where the first token to re-lex begins, in case it's a string covering line breaks
+   first = FirstTokenEndingAfter(instance, start);
+   while(first < Lexer_Incremental_Count(instance))
+   {
+      Lexer_Incremental_Token_t token;
+
+      Lexer_Incremental_At(instance, first, &token);
+      if(token.offset >= start)
+      {
+         break;
+      }
+
+      start = LineStart(instance, token.offset);
+      first = FirstTokenEndingAfter(instance, start);
+   }
+
+   line = LineAt(instance, start, first);
+   MoveTokenGap(instance, first);
+
+   // Put the new text in; the gap ends up right after it
+   MoveTextGap(instance, offset);
+   instance->lineBreaks -= CountCharacter(&instance->text[instance->textGapEnd], removed, '\n');
+   instance->textGapEnd += removed;
+   if(length > 0)
+   {
+      ReserveText(instance, length);
+      memcpy(&instance->text[instance->textGapStart], replacement, length);
+      instance->textGapStart += length;
+   }
+   instance->lineBreaks += CountCharacter(replacement, length, '\n');
+
+   // Without old tokens after the edit there's nothing to line up with, so lex the rest in one go
+   window = TextLength(instance);
+   if(instance->tokenGapEnd < instance->tokenCapacity && editEnd + LEXER_INCREMENTAL_FIRST_WINDOW < window)
+   {
+      window = editEnd + LEXER_INCREMENTAL_FIRST_WINDOW;
+   }
+
+   for(;;)
+   {
+      MoveTextGap(instance, window);
+      if(Relex(instance, start, editEnd, window, line, &keep, &resync))
+      {
+         break;
+      }
+
+      window = (window - start < TextLength(instance) - window) ? window + (window - start) : TextLength(instance);
+   }
+
+   if(resync == TextLength(instance))
+   {
+      NoteUnterminatedString(instance, start);
+   }
+   ReportErrors(instance, start, resync, line);
+
+   // Swap the old tokens for the new
+   change.first = first;
+   change.removed = keep - instance->tokenGapEnd;
+   change.added = instance->freshCount;
+
+   instance->tokenGapEnd = keep;
+   if(instance->freshCount > 0)
+   {
+      ReserveTokens(instance, instance->freshCount);
+      memcpy(&instance->tokens[instance->tokenGapStart], instance->fresh, instance->freshCount * sizeof(Lexer_Incremental_Token_t));
+      instance->tokenGapStart += instance->freshCount;
+   }
+
+   return change;
+}
+
+size_t Lexer_Incremental_Count(const Lexer_Incremental_t *instance)
+{
+   return instance->tokenCapacity - (instance->tokenGapEnd - instance->tokenGapStart);
+}
+
+void Lexer_Incremental_At(const Lexer_Incremental_t *instance, size_t index, Lexer_Incremental_Token_t *token)
+{
+   if(index < instance->tokenGapStart)
+   {
+      *token = instance->tokens[index];
+   }
+   else
+   {
+      *token = Flip(instance, instance->tokens[index + (instance->tokenGapEnd - instance->tokenGapStart)]);
+   }
+}
+
+const char *Lexer_Incremental_Text(Lexer_Incremental_t *instance, size_t *length)
+{
+   *length = TextLength(instance);
+   MoveTextGap(instance, *length);
+   return instance->text;
+}
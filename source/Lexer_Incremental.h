@@ -0,0 +1,117 @@
+/***
+ * File: Lexer_Incremental.h
+ * Desc: Keeps the tokens of a source that is being edited, e.g. behind an
+ *       editor, and re-lexes only the lines an edit can have changed.
+ *
+ *       Text and tokens are both kept in gap buffers with the gap at the last
+ *       edit. Tokens after the gap count their offset and line back from the
+ *       end of the text, so they follow an edit without being touched; the cost
+ *       of an edit depends on its size and how far it is from the last one, not
+ *       on the size of the text.
+ */
+
+#ifndef _LEXER_INCREMENTAL_H
+#define _LEXER_INCREMENTAL_H
+
+#include <stddef.h>
+#include "Lexer_StaticLookup.h"
+#include "Diagnostics.h"
+#include "I_Error.h"
+#include "Token.h"
+
+#define LEXER_INCREMENTAL_FIRST_WINDOW (4096)  // Characters past an edit re-lexed before trying more
+#define LEXER_INCREMENTAL_MAX_ERRORS (1024)    // Errors kept from one edit; earlier ones are dropped
+
+typedef struct
+{
+   Token_Type_t type;
+   size_t offset;       // Of the lexeme in the text
+   size_t length;
+   size_t line;
+} Lexer_Incremental_Token_t;
+
+// Which tokens an edit replaced
+typedef struct
+{
+   size_t first;        // Index of the first token that changed
+   size_t removed;      // Old tokens taken out from there
+   size_t added;        // New tokens put in their place
+} Lexer_Incremental_Change_t;
+
+typedef struct
+{
+   Lexer_StaticLookup_t lexer;
+   Diagnostics_t diagnostics;
+   I_Error_t *errorHandler;
+
+   // Text, with a gap from textGapStart to textGapEnd
+   char *text;
+   size_t textCapacity;
+   size_t textGapStart;
+   size_t textGapEnd;
+   size_t lineBreaks;
+
+   // Tokens in order, with a gap; those after it count back from the end of the text
+   Lexer_Incremental_Token_t *tokens;
+   size_t tokenCapacity;
+   size_t tokenGapStart;
+   size_t tokenGapEnd;
+
+   // Distance of the quote of a string that runs to the end of the text from the end, 0 if none
+   size_t unterminated;
+
+   // Tokens from re-lexing, before they replace the old ones
+   Lexer_Incremental_Token_t *fresh;
+   size_t freshCount;
+   size_t freshCapacity;
+} Lexer_Incremental_t;
+
+/*
+ * Initialize a Lexer_Incremental with no text.
+ *
+ * @param errorHandler - gets the errors on the lines each edit re-lexes
+ */
+void Lexer_Incremental_Init(Lexer_Incremental_t *instance, I_Error_t *errorHandler);
+
+/*
+ * Deinitialize a Lexer_Incremental.
+ */
+void Lexer_Incremental_Deinit(Lexer_Incremental_t *instance);
+
+/*
+ * Replace all of the text and lex it.
+ */
+void Lexer_Incremental_Load(Lexer_Incremental_t *instance, const char *text, size_t length);
+
+/*
+ * Replace part of the text and re-lex from the start of the first line it
+ * touches until the new tokens line up with the old ones again. Errors on the
+ * re-lexed lines are reported again.
+ *
+ * @param offset - where the replaced text starts
+ * @param removed - number of characters replaced (offset + removed must be within the text)
+ * @param replacement - text put in their place
+ * @return - which tokens changed
+ */
+Lexer_Incremental_Change_t Lexer_Incremental_Edit(Lexer_Incremental_t *instance, size_t offset, size_t removed, const char *replacement, size_t length);
+
+/*
+ * Number of tokens in the text.
+ */
+size_t Lexer_Incremental_Count(const Lexer_Incremental_t *instance);
+
+/*
+ * Get a token of the text.
+ *
+ * @param index - from 0 to Lexer_Incremental_Count - 1
+ */
+void Lexer_Incremental_At(const Lexer_Incremental_t *instance, size_t index, Lexer_Incremental_Token_t *token);
+
+/*
+ * The whole text, in one piece. The pointer is valid until the next edit.
+ *
+ * @param length - set to the length of the text
+ */
+const char *Lexer_Incremental_Text(Lexer_Incremental_t *instance, size_t *length);
+
+#endif
@@ -0,0 +1,283 @@
+/***
+ * File: Lexer_Parallel.c
+ *
+ * A token can only run past a newline if it's a string literal missing its
+ * ending, so every chunk starts just after a newline and is lexed on its own.
+ * Each chunk is lexed starting from the newline before it, so the lexer sees
+ * the same previous character it would have seen lexing the whole source; that
+ * newline is counted as line 1, putting the chunk's first line at line 2.
+ *
+ * If a string literal does run past the end of a chunk, the worker for that
+ * chunk lexes it again together with the chunks after it until it ends cleanly,
+ * and the results of the workers for the chunks it took over are thrown away.
+ *
+ * Once every chunk is lexed, each worker moves its tokens' lines to count from
+ * the start of the source on its own thread. When the output is a TokenList
+ * they are copied straight into their place in it there too.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "Lexer_Parallel.h"
+#include "Lexer_StaticLookup.h"
+#include "TokenList.h"
+#include "Error_Buffer.h"
+#include "Threads.h"
+#include "Token.h"
+#include "util.h"
+
+typedef struct
+{
+   Lexer_StaticLookup_t lexer;
+   Error_Buffer_t errors;
+   TokenList_t tokens;
+
+   const char *source;
+   const size_t *splits;   // Chunk k is source[splits[k]] up to source[splits[k + 1]]
+   size_t chunkCount;
+
+   size_t first;           // Chunk this worker was given
+   size_t last;            // One past the last chunk it ended up lexing
+   size_t newlines;        // Number of newlines in its own chunk
+
+   size_t lineOffset;      // Added to the line of each of its tokens
+   TokenList_t *out;       // Where its tokens are copied to, if not NULL
+   size_t base;            // Index in out of its first token
+} Worker_t;
+
+static size_t CountNewlines(const char *source, const char *end)
+{
+   size_t count = 0;
+
+   while((source = memchr(source, '\n', end - source)) != NULL)
+   {
+      count++;
+      source++;
+   }
+
+   return count;
+}
+
+/*
+ * Lex the worker's chunk and every chunk after it up to (not including) last.
+ */
+static void LexChunks(Worker_t *worker, size_t last)
+{
+   const char *from = worker->source + worker->splits[worker->first] - ((worker->first > 0) ? 1 : 0);
+   const char *to = worker->source + worker->splits[last];
+
+   Error_Buffer_Clear(&worker->errors);
+   TokenList_Clear(&worker->tokens);
+
+   Lexer_StaticLookup_Begin(&worker->lexer, &worker->tokens.interface);
+   if(last == worker->chunkCount)
+   {
+      Lexer_LexSpan(&worker->lexer.interface, from, to - from, &worker->tokens.interface);
+   }
+   else
+   {
+      Lexer_StaticLookup_Feed(&worker->lexer, from, to - from);
+   }
+
+   worker->last = last;
+}
+
+static void *Work(void *argument)
+{
+   Worker_t *worker = argument;
+   size_t extra = 1;
+
+   worker->newlines = CountNewlines(worker->source + worker->splits[worker->first], worker->source + worker->splits[worker->first + 1]);
+
+   LexChunks(worker, worker->first + 1);
+   while(worker->last < worker->chunkCount && Lexer_StaticLookup_Pending(&worker->lexer) > 0)
+   {
+      size_t last = worker->last + extra;
+      LexChunks(worker, (last < worker->chunkCount) ? last : worker->chunkCount);
+      extra *= 2;
+   }
+
+   return NULL;
+}
+
+/*
+ * Move the worker's tokens to the lines they are on in the whole source, into
+ * out if there is one.
+ */
+static void *Relocate(void *argument)
+{
+   Worker_t *worker = argument;
+   const Token_t *from = worker->tokens.tokens;
+   Token_t *to = (worker->out != NULL) ? &worker->out->tokens[worker->base] : worker->tokens.tokens;
+
+   for(size_t i = 0; i < worker->tokens.count; i++)
+   {
+      Token_t token = from[i];
+      token.line += worker->lineOffset;
+      to[i] = token;
+   }
+
+   return NULL;
+}
+
+/*
+ * Split the source into at most maxChunks chunks, each (but the first) starting
+ * just after a newline.
+ *
+ * @return - number of chunks
+ */
+static size_t Split(const char *source, size_t length, size_t maxChunks, size_t *splits)
+{
+   size_t count = 0;
+
+   splits[0] = 0;
+   for(size_t k = 1; k < maxChunks; k++)
+   {
+      size_t target = length / maxChunks * k;
+      const char *newline;
+
+      if(target < splits[count])
+      {
+         continue;
+      }
+
+      newline = memchr(source + target, '\n', length - target);
+      if(newline == NULL || (size_t)(newline + 1 - source) == length)
+      {
+         break;
+      }
+
+      splits[++count] = newline + 1 - source;
+   }
+
+   splits[++count] = length;
+   return count;
+}
+
+/*
+ * Put each worker's tokens and errors in order, moving their lines from the
+ * start of their chunk to the start of the source.
+ */
+static void Stitch(Lexer_Parallel_t *instance, Worker_t *workers, size_t chunkCount, I_List_t *tokenList)
+{
+   TokenList_t *out = TokenList_Of(tokenList);
+   size_t linesBefore = 0;
+   size_t base = (out != NULL) ? out->count : 0;
+   size_t next = 0;        // Next worker whose tokens are kept
+
+   for(size_t k = 0; k < chunkCount; k++)
+   {
+      Worker_t *worker = &workers[k];
+
+      if(k == next)
+      {
+         next = worker->last;
+      }
+      else
+      {
+         TokenList_Clear(&worker->tokens);
+      }
+
+      worker->lineOffset = (k == 0) ? 0 : linesBefore - 1;
+      worker->out = out;
+      worker->base = base;
+      base += worker->tokens.count;
+      linesBefore += worker->newlines;
+   }
+
+   if(out != NULL)
+   {
+      TokenList_Reserve(out, base);
+   }
+   Threads_RunAll(workers, chunkCount, sizeof(Worker_t), &Relocate);
+
+   for(size_t k = 0; k < chunkCount; k = workers[k].last)
+   {
+      Worker_t *worker = &workers[k];
+
+      if(out == NULL)
+      {
+         for(size_t i = 0; i < worker->tokens.count; i++)
+         {
+            List_Add(tokenList, &worker->tokens.tokens[i]);
+         }
+      }
+
+      Error_Buffer_Replay(&worker->errors, instance->errorHandler, worker->lineOffset);
+   }
+
+   if(out != NULL)
+   {
+      out->count = base;
+   }
+}
+
+static void lexSpan(I_Lexer_t *interface, const char *source, size_t length, I_List_t *tokenList)
+{
+   REINTERPRET(instance, interface, Lexer_Parallel_t *);
+   size_t maxChunks = length / instance->minChunkSize;
+   size_t *splits;
+   Worker_t *workers;
+   size_t chunkCount;
+
+   if(maxChunks > instance->threadCount)
+   {
+      maxChunks = instance->threadCount;
+   }
+
+   if(maxChunks <= 1)
+   {
+      Lexer_StaticLookup_t lexer;
+      Lexer_StaticLookup_Init(&lexer, instance->errorHandler);
+      Lexer_LexSpan(&lexer.interface, source, length, tokenList);
+      Lexer_StaticLookup_Deinit(&lexer);
+      return;
+   }
+
+   splits = malloc((maxChunks + 1) * sizeof(size_t));
+   workers = malloc(maxChunks * sizeof(Worker_t));
+   chunkCount = Split(source, length, maxChunks, splits);
+
+   for(size_t k = 0; k < chunkCount; k++)
+   {
+      Error_Buffer_Init(&workers[k].errors);
+      TokenList_Init(&workers[k].tokens);
+      Lexer_StaticLookup_Init(&workers[k].lexer, &workers[k].errors.interface);
+
+      workers[k].source = source;
+      workers[k].splits = splits;
+      workers[k].chunkCount = chunkCount;
+      workers[k].first = k;
+   }
+
+   Threads_RunAll(workers, chunkCount, sizeof(Worker_t), &Work);
+   Stitch(instance, workers, chunkCount, tokenList);
+
+   for(size_t k = 0; k < chunkCount; k++)
+   {
+      Lexer_StaticLookup_Deinit(&workers[k].lexer);
+      TokenList_Deinit(&workers[k].tokens);
+      Error_Buffer_Deinit(&workers[k].errors);
+   }
+   free(workers);
+   free(splits);
+}
+
+static void lex(I_Lexer_t *interface, const char *source, I_List_t *tokenList)
+{
+   lexSpan(interface, source, strlen(source), tokenList);
+}
+
+void Lexer_Parallel_Init(Lexer_Parallel_t *instance, I_Error_t *errorHandler, size_t threadCount)
+{
+   instance->interface.lex = &lex;
+   instance->interface.lexSpan = &lexSpan;
+   instance->errorHandler = errorHandler;
+
+   if(threadCount == 0)
+   {
+      threadCount = Threads_DefaultCount();
+   }
+   instance->threadCount = threadCount;
+   instance->minChunkSize = LEXER_PARALLEL_MIN_CHUNK_SIZE;
+}
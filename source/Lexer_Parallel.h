@@ -0,0 +1,33 @@
+/***
+ * File: Lexer_Parallel.h
+ * Desc: Implementation of I_Lexer that splits the source at newlines and lexes
+ *       each part on its own thread with a Lexer_StaticLookup.
+ */
+
+#ifndef _LEXER_PARALLEL_H
+#define _LEXER_PARALLEL_H
+
+#include "I_Lexer.h"
+#include "I_Error.h"
+
+#define LEXER_PARALLEL_MIN_CHUNK_SIZE (64 * 1024)
+
+typedef struct
+{
+   I_Lexer_t interface;
+
+   I_Error_t *errorHandler;
+   size_t threadCount;
+   size_t minChunkSize;    // Least source per thread worth splitting it up for
+} Lexer_Parallel_t;
+
+/*
+ * Initialize a Lexer_Parallel. The tokens and errors it produces are the same
+ * as Lexer_StaticLookup's, in the same order.
+ *
+ * @param threadCount - most threads to lex with, or 0 for one per online CPU
+ * @post minChunkSize is LEXER_PARALLEL_MIN_CHUNK_SIZE
+ */
+void Lexer_Parallel_Init(Lexer_Parallel_t *instance, I_Error_t *errorHandler, size_t threadCount);
+
+#endif
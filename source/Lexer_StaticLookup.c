@@ -2,26 +2,31 @@
  * File: Lexer_StaticLookup.c
  */
 
-#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 #include <stdbool.h>
 #include <stdint.h>
-#include <ctype.h>
 #include "Lexer_StaticLookup.h"
+#include "CharClass.h"
+#include "CharScan.h"
+#include "Stats.h"
 #include "util.h"
 
-enum
+#define LEXER_STATICLOOKUP_SPILL_BLOCK_SIZE (4096)
+#define LEXER_STATICLOOKUP_FIRST_TAKE (64)
+
+struct Lexer_StaticLookup_Spill_t
 {
-   Touchy_DontCare = 0,
-   Touchy_Yes,
-   Touchy_No
+   struct Lexer_StaticLookup_Spill_t *next;
+   size_t used;
+   size_t size;
+   char bytes[];
 };
-typedef uint8_t Touchiness_t;
 
 typedef struct
 {
    void (*what)(Lexer_StaticLookup_t *instance);
    Token_Type_t type;
-   Touchiness_t touchiness;
    Token_Type_t digraphType;
 } CharacterInfo_Entry_t;
 
@@ -43,28 +48,62 @@ static void StringLiteral(Lexer_StaticLookup_t *instance);
 static void Symbol(Lexer_StaticLookup_t *instance);
 static void SymbolicLiteral(Lexer_StaticLookup_t *instance);
 static void Tilde(Lexer_StaticLookup_t *instance);
+static inline char PeekAhead(Lexer_StaticLookup_t *instance, size_t ahead);
 
 /*********************************
  * Movement through source string
+ *
+ * Looking past the end of a chunk that isn't the last one "starves" the
+ * current action: it can't know what the token is yet. Its tokens and errors
+ * are dropped, and it's run again once more of the stream has arrived.
  *********************************/
+static inline void Starve(Lexer_StaticLookup_t *instance)
+{
+   if(!instance->final)
+   {
+      instance->starved = true;
+   }
+}
+
 static inline char Peek(Lexer_StaticLookup_t *instance)
 {
-   return *instance->current;
+   if(instance->current < instance->end)
+   {
+      return *instance->current;
+   }
+
+   Starve(instance);
+   return '\0';
 }
 
 static inline char PeekNext(Lexer_StaticLookup_t *instance)
 {
-   return (instance->current[1] == '\0') ? ' ' : instance->current[1];
+   return PeekAhead(instance, 1);
 }
 
 static inline char PeekPrevious(Lexer_StaticLookup_t *instance)
 {
-   return (instance->current == instance->beginning) ? ' ' : *(instance->current - 1);
+   return (instance->current == instance->beginning) ? instance->previous : *(instance->current - 1);
 }
 
 static inline char PeekAhead(Lexer_StaticLookup_t *instance, size_t ahead)
 {
-   return (instance->current[ahead] == '\0') ? ' ' : instance->current[ahead];
+   if((size_t)(instance->end - instance->current) > ahead)
+   {
+      return instance->current[ahead];
+   }
+
+   Starve(instance);
+   return ' ';
+}
+
+// Call after scanning a run that could carry on into the next chunk
+static inline void StarveIfAtEnd(Lexer_StaticLookup_t *instance)
+{
+   if(instance->current == instance->end)
+   {
+      Starve(instance);
+   }
 }
 
 static inline void AdvanceOne(Lexer_StaticLookup_t *instance)
@@ -77,14 +116,166 @@ static inline void AdvanceMany(Lexer_StaticLookup_t *instance, size_t many)
    instance->current += many;
 }
 
+static const char *Spill(Lexer_StaticLookup_t *instance, const char *lexeme, size_t length)
+{
+   Lexer_StaticLookup_Spill_t *block = instance->spill;
+
+   if(block == NULL || block->size - block->used < length)
+   {
+      size_t size = (length > LEXER_STATICLOOKUP_SPILL_BLOCK_SIZE) ? length : LEXER_STATICLOOKUP_SPILL_BLOCK_SIZE;
+
+      block = malloc(sizeof(Lexer_StaticLookup_Spill_t) + size);
+      block->next = instance->spill;
+      block->used = 0;
+      block->size = size;
+      instance->spill = block;
+   }
+
+   memcpy(&block->bytes[block->used], lexeme, length);
+   block->used += length;
+   return &block->bytes[block->used - length];
+}
+
+/*
+ * Record an error in the diagnostics sink, or format it and report it straight
+ * away if there isn't one. A full sink halts the lexer.
+ *
+ * @param lexeme - what the error is about, if its message quotes it
+ * @param first, second - characters the message needs besides the lexeme
+ * @param line - where the error is reported
+ */
+static void DiagnoseAt(Lexer_StaticLookup_t *instance, Diagnostic_Code_t code, const char *lexeme, size_t length, char first, char second, size_t line)
+{
+   if(instance->starved)
+   {
+      return;
+   }
+
+   Diagnostic_t diagnostic =
+   {
+      .code = code,
+      .extra = { first, second },
+      .length = length,
+      .offset = lexeme - instance->beginning,
+      .line = line
+   };
+
+   if(instance->recordDiagnostics)
+   {
+      instance->halted = !Diagnostics_Add(instance->diagnostics, &diagnostic);
+   }
+   else
+   {
+      Diagnostic_Report(&diagnostic, instance->beginning, instance->errorHandler, line);
+   }
+}
+
+/*
+ * The line being lexed. Without line numbers in tokens, line stays 0 and the
+ * newlines passed so far are in the line index instead.
+ */
+static inline size_t CurrentLine(Lexer_StaticLookup_t *instance)
+{
+   return instance->omitLines ? instance->lineIndex->count + 1 : instance->line;
+}
+
+/*
+ * Count the newline at current, before advancing past it.
+ */
+static inline void CountNewline(Lexer_StaticLookup_t *instance)
+{
+   if(instance->omitLines)
+   {
+      LineIndex_Add(instance->lineIndex, instance->current - instance->beginning);
+   }
+   else
+   {
+      instance->line++;
+   }
+}
+
+static void Diagnose(Lexer_StaticLookup_t *instance, Diagnostic_Code_t code, const char *lexeme, size_t length, char first, char second)
+{
+   DiagnoseAt(instance, code, lexeme, length, first, second, CurrentLine(instance));
+}
+
+static void ReportUnclosed(Lexer_StaticLookup_t *instance, const BracketIndex_Pending_t *pending)
+{
+   DiagnoseAt(instance, Diagnostic_Code_UnclosedBracket, instance->beginning + pending->offset, 1, '\0', '\0', pending->line);
+}
+
+/*
+ * Match a bracket about to be added as the next token. A closer of a different
+ * type than the innermost open bracket closes the nearest one of its own type,
+ * leaving the ones inside it unclosed, or is unmatched if there isn't one.
+ */
+static void TrackBracket(Lexer_StaticLookup_t *instance, Token_Type_t type, const char *lexeme, size_t line)
+{
+   BracketIndex_t *brackets = instance->brackets;
+   uint32_t token = (uint32_t)instance->tokenCount;
+   Token_Type_t opener;
+
+   switch(type)
+   {
+      case Token_Type_Paren_Left:
+      case Token_Type_SquareBrace_Left:
+      case Token_Type_CurlyBrace_Left:
+         BracketIndex_Open(brackets, token, type, lexeme - instance->beginning, line);
+         return;
+
+      case Token_Type_Paren_Right: opener = Token_Type_Paren_Left; break;
+      case Token_Type_SquareBrace_Right: opener = Token_Type_SquareBrace_Left; break;
+      case Token_Type_CurlyBrace_Right: opener = Token_Type_CurlyBrace_Left; break;
+      default: return;
+   }
+
+   if(!BracketIndex_IsOpen(brackets, opener))
+   {
+      DiagnoseAt(instance, Diagnostic_Code_UnmatchedBracket, lexeme, 1, '\0', '\0', line);
+      return;
+   }
+
+   while(BracketIndex_Top(brackets)->type != opener)
+   {
+      ReportUnclosed(instance, BracketIndex_Top(brackets));
+      BracketIndex_Abandon(brackets);
+   }
+   BracketIndex_Close(brackets, token);
+}
+
 static void AddToken(Lexer_StaticLookup_t *instance, Token_Type_t type, const char *lexeme, size_t length, size_t line)
 {
+   if(instance->starved)
+   {
+      return;
+   }
+
+   // Tokens that spanned two chunks were lexed from a scratch copy
+   if(instance->copyLexemes)
+   {
+      lexeme = Spill(instance, lexeme, length);
+   }
+
    instance->token.type = type;
    instance->token.lexeme = lexeme;
    instance->token.length = length;
+   if(instance->trackBrackets)
+   {
+      TrackBracket(instance, type, lexeme, CurrentLine(instance));
+   }
+   instance->tokenCount++;
+
    instance->token.line = line;
 
-   List_Add(instance->tokenList, &instance->token);
+   if(instance->typedTokens != NULL)
+   {
+      TokenList_Add(instance->typedTokens, &instance->token);
+   }
+   else
+   {
+      List_Add(instance->tokenList, &instance->token);
+   }
+   STATS(if(instance->stats != NULL) instance->stats->tokens[type]++;)
 }
 
 static const CharacterInfo_Entry_t characterInfoTable[128] =
@@ -122,104 +313,104 @@ static const CharacterInfo_Entry_t characterInfoTable[128] =
    { .what = ReportUnexpectedCharacter }, // record separator
    { .what = ReportUnexpectedCharacter }, // unit separator
 
-   { .what = Ignore                                                                                     }, // Space
-   { .what = Exclamation,               .type = Token_Type_Unused,             .touchiness = Touchy_Yes, .digraphType = Token_Type_BangEqual }, // !
-   { .what = StringLiteral,                                                    .touchiness = Touchy_Yes }, // "
-   { .what = Pound,                     .type = Token_Type_Pound,              .touchiness = Touchy_Yes }, // #
-   { .what = Symbol,                    .type = Token_Type_Dollar,             .touchiness = Touchy_Yes }, // $
-   { .what = ReportUnexpectedCharacter                                                                  }, // %
-   { .what = ReportUnexpectedCharacter                                                                  }, // &
-   { .what = ReportUnexpectedCharacter                                                                  }, // '
-   { .what = Symbol,                    .type = Token_Type_Paren_Left,         .touchiness = Touchy_No  }, // (
-   { .what = Symbol,                    .type = Token_Type_Paren_Right,        .touchiness = Touchy_No  }, // )
-   { .what = Symbol,                    .type = Token_Type_Asterisk,           .touchiness = Touchy_Yes }, // *
-   { .what = Symbol,                    .type = Token_Type_Plus,               .touchiness = Touchy_Yes }, // +
-   { .what = Symbol,                    .type = Token_Type_Comma,              .touchiness = Touchy_No  }, // ,
-   { .what = Dash,                      .type = Token_Type_Dash,               .touchiness = Touchy_Yes }, // -
-   { .what = Dot,                                                              .touchiness = Touchy_No  }, // .
-   { .what = Symbol,                    .type = Token_Type_Slash,              .touchiness = Touchy_Yes }, // /
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 0
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 1
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 2
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 3
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 4
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 5
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 6
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 7
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 8
-   { .what = NumberLiteralOrIdentifier,                                        .touchiness = Touchy_Yes }, // 9
-   { .what = Colon,                                                            .touchiness = Touchy_No  }, // :
-   { .what = ReportUnexpectedCharacter                                                                  }, // ;
-   { .what = DigraphOrSymbol,           .type = Token_Type_AngleBracket_Left,  .touchiness = Touchy_Yes, .digraphType = Token_Type_LessEqual }, // <
-   { .what = DigraphOrSymbol,           .type = Token_Type_Equal,              .touchiness = Touchy_Yes, .digraphType = Token_Type_EqualEqual }, // =
-   { .what = DigraphOrSymbol,           .type = Token_Type_AngleBracket_Right, .touchiness = Touchy_Yes, .digraphType = Token_Type_GreaterEqual }, // >
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // ?
-
-   { .what = Symbol,                    .type = Token_Type_Arroba,             .touchiness = Touchy_Yes }, // @
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // A
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // B
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // C
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // D
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // E
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // F
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // G
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // H
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // I
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // J
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // K
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // L
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // M
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // N
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // O
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // P
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // Q
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // R
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // S
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // T
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // U
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // V
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // W
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // X
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // Y
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // Z
-   { .what = Symbol,                    .type = Token_Type_SquareBrace_Left,   .touchiness = Touchy_No  }, // [
-   { .what = ReportUnexpectedCharacter                                                                  }, // backslash
-   { .what = Symbol,                    .type = Token_Type_SquareBrace_Right,  .touchiness = Touchy_No  }, // ]
-   { .what = ReportUnexpectedCharacter                                                                  }, // ^
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // _
-
-   { .what = Symbol,                    .type = Token_Type_Backtick                                     }, // `
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // a
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // b
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // c
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // d
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // e
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // f
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // g
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // h
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // i
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // j
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // k
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // l
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // m
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // n
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // o
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // p
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // q
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // r
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // s
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // t
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // u
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // v
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // w
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // x
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // y
-   { .what = Identifier,                                                       .touchiness = Touchy_Yes }, // z
-   { .what = Symbol,                    .type = Token_Type_CurlyBrace_Left,    .touchiness = Touchy_No  }, // {
-   { .what = ReportUnexpectedCharacter                                                                  }, // |
-   { .what = Symbol,                    .type = Token_Type_CurlyBrace_Right,   .touchiness = Touchy_No  }, // }
-   { .what = Tilde,                                                            .touchiness = Touchy_Yes }, // ~
-   { .what = ReportUnexpectedCharacter                                                                  } // DEL
+   { .what = Ignore                                                          }, // Space
+   { .what = Exclamation,               .type = Token_Type_Unused,             .digraphType = Token_Type_BangEqual }, // !
+   { .what = StringLiteral                                                   }, // "
+   { .what = Pound,                     .type = Token_Type_Pound             }, // #
+   { .what = Symbol,                    .type = Token_Type_Dollar            }, // $
+   { .what = ReportUnexpectedCharacter                                       }, // %
+   { .what = ReportUnexpectedCharacter                                       }, // &
+   { .what = ReportUnexpectedCharacter                                       }, // '
+   { .what = Symbol,                    .type = Token_Type_Paren_Left        }, // (
+   { .what = Symbol,                    .type = Token_Type_Paren_Right       }, // )
+   { .what = Symbol,                    .type = Token_Type_Asterisk          }, // *
+   { .what = Symbol,                    .type = Token_Type_Plus              }, // +
+   { .what = Symbol,                    .type = Token_Type_Comma             }, // ,
+   { .what = Dash,                      .type = Token_Type_Dash              }, // -
+   { .what = Dot                                                             }, // .
+   { .what = Symbol,                    .type = Token_Type_Slash             }, // /
+   { .what = NumberLiteralOrIdentifier                                       }, // 0
+   { .what = NumberLiteralOrIdentifier                                       }, // 1
+   { .what = NumberLiteralOrIdentifier                                       }, // 2
+   { .what = NumberLiteralOrIdentifier                                       }, // 3
+   { .what = NumberLiteralOrIdentifier                                       }, // 4
+   { .what = NumberLiteralOrIdentifier                                       }, // 5
+   { .what = NumberLiteralOrIdentifier                                       }, // 6
+   { .what = NumberLiteralOrIdentifier                                       }, // 7
+   { .what = NumberLiteralOrIdentifier                                       }, // 8
+   { .what = NumberLiteralOrIdentifier                                       }, // 9
+   { .what = Colon                                                           }, // :
+   { .what = ReportUnexpectedCharacter                                       }, // ;
+   { .what = DigraphOrSymbol,           .type = Token_Type_AngleBracket_Left,  .digraphType = Token_Type_LessEqual }, // <
+   { .what = DigraphOrSymbol,           .type = Token_Type_Equal,              .digraphType = Token_Type_EqualEqual }, // =
+   { .what = DigraphOrSymbol,           .type = Token_Type_AngleBracket_Right, .digraphType = Token_Type_GreaterEqual }, // >
+   { .what = Identifier                                                      }, // ?
+
+   { .what = Symbol,                    .type = Token_Type_Arroba            }, // @
+   { .what = Identifier                                                      }, // A
+   { .what = Identifier                                                      }, // B
+   { .what = Identifier                                                      }, // C
+   { .what = Identifier                                                      }, // D
+   { .what = Identifier                                                      }, // E
+   { .what = Identifier                                                      }, // F
+   { .what = Identifier                                                      }, // G
+   { .what = Identifier                                                      }, // H
+   { .what = Identifier                                                      }, // I
+   { .what = Identifier                                                      }, // J
+   { .what = Identifier                                                      }, // K
+   { .what = Identifier                                                      }, // L
+   { .what = Identifier                                                      }, // M
+   { .what = Identifier                                                      }, // N
+   { .what = Identifier                                                      }, // O
+   { .what = Identifier                                                      }, // P
+   { .what = Identifier                                                      }, // Q
+   { .what = Identifier                                                      }, // R
+   { .what = Identifier                                                      }, // S
+   { .what = Identifier                                                      }, // T
+   { .what = Identifier                                                      }, // U
+   { .what = Identifier                                                      }, // V
+   { .what = Identifier                                                      }, // W
+   { .what = Identifier                                                      }, // X
+   { .what = Identifier                                                      }, // Y
+   { .what = Identifier                                                      }, // Z
+   { .what = Symbol,                    .type = Token_Type_SquareBrace_Left  }, // [
+   { .what = ReportUnexpectedCharacter                                       }, // backslash
+   { .what = Symbol,                    .type = Token_Type_SquareBrace_Right }, // ]
+   { .what = ReportUnexpectedCharacter                                       }, // ^
+   { .what = Identifier                                                      }, // _
+
+   { .what = Symbol,                    .type = Token_Type_Backtick          }, // `
+   { .what = Identifier                                                      }, // a
+   { .what = Identifier                                                      }, // b
+   { .what = Identifier                                                      }, // c
+   { .what = Identifier                                                      }, // d
+   { .what = Identifier                                                      }, // e
+   { .what = Identifier                                                      }, // f
+   { .what = Identifier                                                      }, // g
+   { .what = Identifier                                                      }, // h
+   { .what = Identifier                                                      }, // i
+   { .what = Identifier                                                      }, // j
+   { .what = Identifier                                                      }, // k
+   { .what = Identifier                                                      }, // l
+   { .what = Identifier                                                      }, // m
+   { .what = Identifier                                                      }, // n
+   { .what = Identifier                                                      }, // o
+   { .what = Identifier                                                      }, // p
+   { .what = Identifier                                                      }, // q
+   { .what = Identifier                                                      }, // r
+   { .what = Identifier                                                      }, // s
+   { .what = Identifier                                                      }, // t
+   { .what = Identifier                                                      }, // u
+   { .what = Identifier                                                      }, // v
+   { .what = Identifier                                                      }, // w
+   { .what = Identifier                                                      }, // x
+   { .what = Identifier                                                      }, // y
+   { .what = Identifier                                                      }, // z
+   { .what = Symbol,                    .type = Token_Type_CurlyBrace_Left   }, // {
+   { .what = ReportUnexpectedCharacter                                       }, // |
+   { .what = Symbol,                    .type = Token_Type_CurlyBrace_Right  }, // }
+   { .what = Tilde                                                           }, // ~
+   { .what = ReportUnexpectedCharacter                                       } // DEL
 };
 
 /*********************************
@@ -232,21 +423,19 @@ static void Ignore(Lexer_StaticLookup_t *instance)
 
 static void IncrementLineCounter(Lexer_StaticLookup_t *instance)
 {
-   instance->line++;
+   CountNewline(instance);
    AdvanceOne(instance);
 }
 
 static void ReportUnexpectedCharacter(Lexer_StaticLookup_t *instance)
 {
-   if(iscntrl(Peek(instance)))
+   if(CharClass_Is(Peek(instance), CharClass_Control))
    {
-      Error_Report(instance->errorHandler, instance->line, "Unexpected non-printable character");
+      Diagnose(instance, Diagnostic_Code_NonPrintableCharacter, instance->current, 0, '\0', '\0');
    }
    else
    {
-      char message[25] = "Unexpected character ' '";
-      message[22] = Peek(instance);
-      Error_Report(instance->errorHandler, instance->line, message);
+      Diagnose(instance, Diagnostic_Code_UnexpectedCharacter, instance->current, 1, Peek(instance), '\0');
    }
 
    AdvanceOne(instance);
@@ -255,17 +444,11 @@ static void ReportUnexpectedCharacter(Lexer_StaticLookup_t *instance)
 static void Identifier(Lexer_StaticLookup_t *instance)
 {
    const char *beginning = instance->current;
-   size_t length = 0;
    bool validIdentifier = false;
+   size_t length = CharScan_Identifier(beginning, instance->end, &validIdentifier);
 
-   while(isalpha(Peek(instance)) || Peek(instance) == '_' || Peek(instance) == '-'
-         || Peek(instance) == '#' || Peek(instance) == '!' || Peek(instance) == '?')
-   {
-      validIdentifier = validIdentifier || (isalpha(Peek(instance)) || Peek(instance) == '?');
-
-      AdvanceOne(instance);
-      length++;
-   }
+   AdvanceMany(instance, length);
+   StarveIfAtEnd(instance);
 
    if(validIdentifier)
    {
@@ -273,38 +456,32 @@ static void Identifier(Lexer_StaticLookup_t *instance)
    }
    else
    {
-      char message[38+length];
-      sprintf(message, "Identifier name missing [a-zA-Z?]: '%.*s'", (int)length, beginning);
-      Error_Report(instance->errorHandler, instance->line, message);
+      Diagnose(instance, Diagnostic_Code_IdentifierMissingLetter, beginning, length, '\0', '\0');
    }
 }
 
 static void CheckSpacing(Lexer_StaticLookup_t *instance, uint8_t length)
 {
-   char message[66];
-   bool touchyOnLeft = characterInfoTable[PeekPrevious(instance)].touchiness == Touchy_Yes;
-   bool touchyOnRight = characterInfoTable[PeekAhead(instance, length)].touchiness == Touchy_Yes;
+   bool touchyOnLeft = CharClass_Is(PeekPrevious(instance), CharClass_Touchy);
+   bool touchyOnRight = CharClass_Is(PeekAhead(instance, length), CharClass_Touchy);
 
    if(touchyOnLeft && touchyOnRight)
    {
-      sprintf(message, "\"Touchy\" symbol '%.*s' next to other touchy symbols '%c' and '%c'",  length, instance->current, PeekPrevious(instance), PeekAhead(instance, length));
-      Error_Report(instance->errorHandler, instance->line, message);
+      Diagnose(instance, Diagnostic_Code_TouchySymbol, instance->current, length, PeekPrevious(instance), PeekAhead(instance, length));
    }
    else if(touchyOnLeft)
    {
-      sprintf(message, "\"Touchy\" symbol '%.*s' next to another touchy symbol '%c'",  length, instance->current, PeekPrevious(instance));
-      Error_Report(instance->errorHandler, instance->line, message);
+      Diagnose(instance, Diagnostic_Code_TouchySymbol, instance->current, length, PeekPrevious(instance), '\0');
    }
    else if(touchyOnRight)
    {
-      sprintf(message, "\"Touchy\" symbol '%.*s' next to another touchy symbol '%c'",  length, instance->current, PeekAhead(instance, length));
-      Error_Report(instance->errorHandler, instance->line, message);
+      Diagnose(instance, Diagnostic_Code_TouchySymbol, instance->current, length, PeekAhead(instance, length), '\0');
    }
 }
 
-static void WideSymbol(Lexer_StaticLookup_t *instance, uint8_t width, Token_Type_t type, Touchiness_t touchiness)
+static void WideSymbol(Lexer_StaticLookup_t *instance, uint8_t width, Token_Type_t type, bool touchy)
 {
-   if(touchiness == Touchy_Yes)
+   if(touchy)
    {
       CheckSpacing(instance, width);
    }
@@ -315,81 +492,104 @@ static void WideSymbol(Lexer_StaticLookup_t *instance, uint8_t width, Token_Type
 
 static void Symbol(Lexer_StaticLookup_t *instance)
 {
-   WideSymbol(instance, 1, characterInfoTable[Peek(instance)].type, characterInfoTable[Peek(instance)].touchiness);
+   WideSymbol(instance, 1, characterInfoTable[Peek(instance)].type, CharClass_Is(Peek(instance), CharClass_Touchy));
 }
 
 static void DigraphOrSymbol(Lexer_StaticLookup_t *instance)
 {
    if(PeekNext(instance) == '=')
    {
-      WideSymbol(instance, 2, characterInfoTable[Peek(instance)].digraphType, Touchy_Yes);
+      WideSymbol(instance, 2, characterInfoTable[Peek(instance)].digraphType, true);
    }
    else
    {
-      WideSymbol(instance, 1, characterInfoTable[Peek(instance)].type, characterInfoTable[Peek(instance)].touchiness);
+      WideSymbol(instance, 1, characterInfoTable[Peek(instance)].type, CharClass_Is(Peek(instance), CharClass_Touchy));
    }
 }
 
-static void NumberLiteralOrIdentifier(Lexer_StaticLookup_t *instance)
+/*
+ * Errors are only reported once the whole number has been seen, so that
+ * missingSpaceBefore (found by Dot) isn't reported twice if the number starves.
+ */
+static void Number(Lexer_StaticLookup_t *instance, bool missingSpaceBefore)
 {
    Token_Type_t type = Token_Type_Literal_Number;
    const char *beginning = instance->current;
-   size_t length = 1;
 
    bool containsDecimalPoint = (Peek(instance) == '.');
    AdvanceOne(instance);
+   AdvanceMany(instance, CharScan_Digits(instance->current, instance->end));
+   StarveIfAtEnd(instance);
 
-   while(isdigit(Peek(instance)) || (!containsDecimalPoint && (Peek(instance) == '.')))
+   if(!containsDecimalPoint && Peek(instance) == '.')
    {
-      containsDecimalPoint = containsDecimalPoint || Peek(instance) == '.';
+      containsDecimalPoint = true;
       AdvanceOne(instance);
-      length++;
+      AdvanceMany(instance, CharScan_Digits(instance->current, instance->end));
+      StarveIfAtEnd(instance);
    }
 
    if(!containsDecimalPoint && (Peek(instance) == '\'' || Peek(instance) == '"'))
    {
       type = Token_Type_Identifier;
       AdvanceOne(instance);
-      length++;
    }
-   AddToken(instance, type, beginning, length, instance->line);
+
+   if(missingSpaceBefore)
+   {
+      Diagnose(instance, Diagnostic_Code_MissingSpaceBeforeDecimal, beginning, 0, '\0', '\0');
+   }
+   if(instance->trackNumbers && !instance->starved)
+   {
+      NumberTable_Add(instance->numbers, (uint32_t)instance->tokenCount, beginning, instance->current - beginning);
+   }
+   AddToken(instance, type, beginning, instance->current - beginning, instance->line);
+}
+
+static void NumberLiteralOrIdentifier(Lexer_StaticLookup_t *instance)
+{
+   Number(instance, false);
 }
 
 static void StringLiteral(Lexer_StaticLookup_t *instance)
 {
    const char *beginning = instance->current;
-   size_t line = instance->line;
-   size_t length = 1;
+   size_t firstLine = CurrentLine(instance);
+   size_t lineBreaks = 0;
 
    AdvanceOne(instance);   // Past opening "
-   while(Peek(instance) != '"')
-   {
-      if(Peek(instance) == '\0')
-      {
-         Error_Report(instance->errorHandler, instance->line, "String literal missing ending \"");
-         return;
-      }
-      if(Peek(instance) == '\n')
-      {
-         Error_Report(instance->errorHandler, instance->line, "String literal not contained on one line.");
-         instance->line++;
-      }
+   AdvanceMany(instance, CharScan_StringBody(instance->current, instance->end));
 
+   while(Peek(instance) == '\n')
+   {
+      lineBreaks++;
+      CountNewline(instance);
       AdvanceOne(instance);
-      length++;
+      AdvanceMany(instance, CharScan_StringBody(instance->current, instance->end));
+   }
+
+   // Only report line breaks once the end of the string has been found
+   for(size_t i = 0; i < lineBreaks; i++)
+   {
+      DiagnoseAt(instance, Diagnostic_Code_StringNotOnOneLine, beginning, 0, '\0', '\0', firstLine + i);
+   }
+
+   if(Peek(instance) != '"')
+   {
+      Diagnose(instance, Diagnostic_Code_StringMissingEnd, beginning, 0, '\0', '\0');
+      return;
    }
 
    AdvanceOne(instance);   // Past closing "
-   length++;
 
-   AddToken(instance, Token_Type_Literal_String, beginning, length, instance->line);
+   AddToken(instance, Token_Type_Literal_String, beginning, instance->current - beginning, instance->line);
 }
 
 static void Exclamation(Lexer_StaticLookup_t *instance)
 {
    if(PeekNext(instance) == '=')
    {
-      WideSymbol(instance, 2, characterInfoTable['!'].digraphType, Touchy_Yes);
+      WideSymbol(instance, 2, characterInfoTable['!'].digraphType, true);
    }
    else
    {
@@ -399,113 +599,87 @@ static void Exclamation(Lexer_StaticLookup_t *instance)
 
 static void Pound(Lexer_StaticLookup_t *instance)
 {
-   if(isalpha(PeekNext(instance))
-      || PeekNext(instance) == '_'
-      || PeekNext(instance) == '-'
-      || PeekNext(instance) == '#'
-      || PeekNext(instance) == '!'
-      || PeekNext(instance) == '?')
+   if(CharClass_Is(PeekNext(instance), CharClass_Identifier))
    {
       Identifier(instance);
    }
    else
    {
-      WideSymbol(instance, 1, Token_Type_Pound, characterInfoTable['#'].touchiness);
+      WideSymbol(instance, 1, Token_Type_Pound, CharClass_Is(Peek(instance), CharClass_Touchy));
    }
 }
 
 static void Dot(Lexer_StaticLookup_t *instance)
 {
-   if(isdigit(PeekNext(instance)))
+   if(CharClass_Is(PeekNext(instance), CharClass_Digit))
    {
-      if(PeekPrevious(instance) != ' ')
-      {
-         Error_Report(instance->errorHandler, instance->line, "Missing space before decimal number with no leading zero");
-      }
-
-      NumberLiteralOrIdentifier(instance);
+      Number(instance, PeekPrevious(instance) != ' ');
    }
    else if(PeekNext(instance) == '.')
    {
       if(PeekAhead(instance, 2) == '.')
       {
-         WideSymbol(instance, 3, Token_Type_DotDotDot, characterInfoTable['.'].touchiness);
+         WideSymbol(instance, 3, Token_Type_DotDotDot, CharClass_Is(Peek(instance), CharClass_Touchy));
       }
       else
       {
-         WideSymbol(instance, 2, Token_Type_DotDot, characterInfoTable['.'].touchiness);
+         WideSymbol(instance, 2, Token_Type_DotDot, CharClass_Is(Peek(instance), CharClass_Touchy));
       }
    }
    else
    {
-      WideSymbol(instance, 1, Token_Type_Dot, characterInfoTable['.'].touchiness);
+      WideSymbol(instance, 1, Token_Type_Dot, CharClass_Is(Peek(instance), CharClass_Touchy));
    }
 }
 
 static void Colon(Lexer_StaticLookup_t *instance)
 {
-   if(isalpha(PeekNext(instance))
-      || PeekNext(instance) == '_'
-      || PeekNext(instance) == '-'
-      || PeekNext(instance) == '#'
-      || PeekNext(instance) == '!'
-      || PeekNext(instance) == '?')
+   if(CharClass_Is(PeekNext(instance), CharClass_Identifier))
    {
       SymbolicLiteral(instance);
    }
    else
    {
       // Colon is allowed to touch on left as long as next is a space
-      if(isspace(PeekNext(instance)))
+      if(CharClass_Is(PeekNext(instance), CharClass_Space))
       {
-         WideSymbol(instance, 1, Token_Type_Colon, Touchy_No);
+         WideSymbol(instance, 1, Token_Type_Colon, false);
       }
       else
       {
-         Error_Report(instance->errorHandler, instance->line, "Missing space after ':'");
+         Diagnose(instance, Diagnostic_Code_MissingSpaceAfterColon, instance->current, 0, '\0', '\0');
+         WideSymbol(instance, 1, Token_Type_Colon, false);
       }
    }
 }
 
 static void Dash(Lexer_StaticLookup_t *instance)
 {
-   if(isalpha(PeekNext(instance))
-      || PeekNext(instance) == '_'
-      || PeekNext(instance) == '-'
-      || PeekNext(instance) == '#'
-      || PeekNext(instance) == '!'
-      || PeekNext(instance) == '?')
+   if(CharClass_Is(PeekNext(instance), CharClass_Identifier))
    {
       Identifier(instance);
    }
    else
    {
-      WideSymbol(instance, 1, Token_Type_Dash, characterInfoTable['-'].touchiness);
+      WideSymbol(instance, 1, Token_Type_Dash, CharClass_Is(Peek(instance), CharClass_Touchy));
    }
 }
 
 static void Tilde(Lexer_StaticLookup_t *instance)
 {
-   WideSymbol(instance, 1, Token_Type_Identifier, characterInfoTable['~'].touchiness);
+   WideSymbol(instance, 1, Token_Type_Identifier, CharClass_Is(Peek(instance), CharClass_Touchy));
 }
 
 // TODO: merge overlap with literal function so there isn't as much copied code
 static void SymbolicLiteral(Lexer_StaticLookup_t *instance)
 {
    const char *beginning = instance->current;
-   size_t length = 1;
    bool validSymbolic = false;
 
    AdvanceOne(instance); // Past :
-
-   while(isalpha(Peek(instance)) || Peek(instance) == '_' || Peek(instance) == '-'
-         || Peek(instance) == '#' || Peek(instance) == '!' || Peek(instance) == '?')
-   {
-      validSymbolic = validSymbolic || (isalpha(Peek(instance)) || Peek(instance) == '?');
-
-      AdvanceOne(instance);
-      length++;
-   }
+   size_t length = 1 + CharScan_Identifier(instance->current, instance->end, &validSymbolic);
+   AdvanceMany(instance, length - 1);
+   StarveIfAtEnd(instance);
 
    if(validSymbolic)
    {
@@ -513,39 +687,516 @@ static void SymbolicLiteral(Lexer_StaticLookup_t *instance)
    }
    else
    {
-      char message[34+length];
-      sprintf(message, "Symbol name missing [a-zA-Z?]: '%.*s'", (int)length, beginning);
-      Error_Report(instance->errorHandler, instance->line, message);
+      Diagnose(instance, Diagnostic_Code_SymbolMissingLetter, beginning, length, '\0', '\0');
    }
 }
 
 /*********************************
  * Top-level functions
  *********************************/
-static void lex(I_Lexer_t *interface, const char *source, I_List_t *tokenList)
+static void DispatchUncounted(Lexer_StaticLookup_t *instance)
+{
+   if(Peek(instance) >= 0)
+   {
+      characterInfoTable[Peek(instance)].what(instance);
+   }
+   else
+   {
+      Diagnose(instance, Diagnostic_Code_NonAsciiCharacter, instance->current, 1, '\0', '\0');
+      AdvanceOne(instance);
+   }
+}
+
+#ifdef PARSER_STATS
+static void (*const actions[Lexer_StaticLookup_Action_Count])(Lexer_StaticLookup_t *instance) =
+{
+   [Lexer_StaticLookup_Action_Ignore]                    = Ignore,
+   [Lexer_StaticLookup_Action_IncrementLineCounter]      = IncrementLineCounter,
+   [Lexer_StaticLookup_Action_ReportUnexpectedCharacter] = ReportUnexpectedCharacter,
+   [Lexer_StaticLookup_Action_Identifier]                = Identifier,
+   [Lexer_StaticLookup_Action_Symbol]                    = Symbol,
+   [Lexer_StaticLookup_Action_DigraphOrSymbol]           = DigraphOrSymbol,
+   [Lexer_StaticLookup_Action_NumberLiteralOrIdentifier] = NumberLiteralOrIdentifier,
+   [Lexer_StaticLookup_Action_StringLiteral]             = StringLiteral,
+   [Lexer_StaticLookup_Action_Exclamation]               = Exclamation,
+   [Lexer_StaticLookup_Action_Pound]                     = Pound,
+   [Lexer_StaticLookup_Action_Dot]                       = Dot,
+   [Lexer_StaticLookup_Action_Colon]                     = Colon,
+   [Lexer_StaticLookup_Action_Dash]                      = Dash,
+   [Lexer_StaticLookup_Action_Tilde]                     = Tilde
+};
+
+static const char *actionNames[Lexer_StaticLookup_Action_Count] =
+{
+   [Lexer_StaticLookup_Action_Ignore]                    = "Ignore",
+   [Lexer_StaticLookup_Action_IncrementLineCounter]      = "IncrementLineCounter",
+   [Lexer_StaticLookup_Action_ReportUnexpectedCharacter] = "ReportUnexpectedCharacter",
+   [Lexer_StaticLookup_Action_Identifier]                = "Identifier",
+   [Lexer_StaticLookup_Action_Symbol]                    = "Symbol",
+   [Lexer_StaticLookup_Action_DigraphOrSymbol]           = "DigraphOrSymbol",
+   [Lexer_StaticLookup_Action_NumberLiteralOrIdentifier] = "NumberLiteralOrIdentifier",
+   [Lexer_StaticLookup_Action_StringLiteral]             = "StringLiteral",
+   [Lexer_StaticLookup_Action_Exclamation]               = "Exclamation",
+   [Lexer_StaticLookup_Action_Pound]                     = "Pound",
+   [Lexer_StaticLookup_Action_Dot]                       = "Dot",
+   [Lexer_StaticLookup_Action_Colon]                     = "Colon",
+   [Lexer_StaticLookup_Action_Dash]                      = "Dash",
+   [Lexer_StaticLookup_Action_Tilde]                     = "Tilde",
+   [Lexer_StaticLookup_Action_NonAscii]                  = "NonAscii"
+};
+
+static Lexer_StaticLookup_Action_t ActionOf(char c)
+{
+   Lexer_StaticLookup_Action_t action = 0;
+
+   if(c < 0)
+   {
+      return Lexer_StaticLookup_Action_NonAscii;
+   }
+
+   while(actions[action] != characterInfoTable[c].what)
+   {
+      action++;
+   }
+
+   return action;
+}
+
+/*
+ * Dispatch, timing the handler and counting what it got through. Work thrown
+ * away because the handler starved only counts towards its time.
+ */
+static void DispatchCounted(Lexer_StaticLookup_t *instance)
+{
+   Lexer_StaticLookup_Action_t action = ActionOf(*instance->current);
+   const char *start = instance->current;
+   uint64_t ticks = Stats_Ticks();
+
+   DispatchUncounted(instance);
+
+   instance->stats->ticks[action] += Stats_Ticks() - ticks;
+   if(instance->starved)
+   {
+      instance->stats->starves++;
+   }
+   else
+   {
+      instance->stats->calls[action]++;
+      instance->stats->bytes[action] += instance->current - start;
+   }
+}
+#endif
+
+static void Dispatch(Lexer_StaticLookup_t *instance)
+{
+#ifdef PARSER_STATS
+   if(instance->stats != NULL)
+   {
+      DispatchCounted(instance);
+      return;
+   }
+#endif
+
+   DispatchUncounted(instance);
+}
+
+/*
+ * Lex from current up to stop. If an action starves, everything it did is
+ * undone and current is left at the start of its token.
+ */
+static void Run(Lexer_StaticLookup_t *instance, const char *stop)
+{
+   instance->starved = false;
+
+   while(instance->current < stop && !instance->halted)
+   {
+      const char *start = instance->current;
+      size_t line = instance->line;
+
+      Dispatch(instance);
+
+      if(instance->starved)
+      {
+         instance->current = start;
+         instance->line = line;
+         return;
+      }
+   }
+}
+
+static void SetSource(Lexer_StaticLookup_t *instance, const char *source, size_t length, char previous, bool final)
 {
-   REINTERPRET(instance, interface, Lexer_StaticLookup_t *);
    instance->beginning = source;
    instance->current = source;
+   instance->end = source + length;
+   instance->previous = previous;
+   instance->final = final;
+}
+
+static void lexSpan(I_Lexer_t *interface, const char *source, size_t length, I_List_t *tokenList)
+{
+   REINTERPRET(instance, interface, Lexer_StaticLookup_t *);
+   SetSource(instance, source, length, ' ', true);
    instance->tokenList = tokenList;
-   instance->line = 1;
+   instance->typedTokens = TokenList_Of(tokenList);
+   instance->copyLexemes = false;
+   instance->omitLines = (instance->lineIndex != NULL);
+   instance->line = instance->omitLines ? 0 : 1;
+   instance->recordDiagnostics = (instance->diagnostics != NULL);
+   instance->halted = false;
+
+   instance->trackBrackets = (instance->brackets != NULL);
+   instance->trackNumbers = (instance->numbers != NULL);
+   instance->tokenCount = 0;
+
+   if(instance->omitLines)
+   {
+      LineIndex_Clear(instance->lineIndex);
+      LineIndex_Reserve(instance->lineIndex, length / 32 + 16);
+   }
+   if(instance->trackBrackets)
+   {
+      BracketIndex_Clear(instance->brackets);
+   }
+   if(instance->trackNumbers)
+   {
+      NumberTable_Clear(instance->numbers);
+   }
 
-   while(Peek(instance) != '\0')
+   Run(instance, instance->end);
+
+   if(instance->trackBrackets)
    {
-      if(Peek(instance) > 0)
+      // Outermost first, so they're reported in the order they were opened. If
+      // lexing halted, the rest of the source might have closed them.
+      for(size_t i = 0; i < instance->brackets->stackCount && !instance->halted; i++)
       {
-         characterInfoTable[Peek(instance)].what(instance);
+         ReportUnclosed(instance, &instance->brackets->stack[i]);
       }
-      else
+      while(BracketIndex_Top(instance->brackets) != NULL)
       {
-         Error_Report(instance->errorHandler, instance->line, "Unexpected non-ascii character");
-         AdvanceOne(instance);
+         BracketIndex_Abandon(instance->brackets);
       }
    }
 }
 
+static void lex(I_Lexer_t *interface, const char *source, I_List_t *tokenList)
+{
+   lexSpan(interface, source, strlen(source), tokenList);
+}
+
+/*
+ * Make sure a scratch buffer can hold size bytes without losing its contents.
+ */
+static char *Reserve(char **buffer, size_t *capacity, size_t size)
+{
+   if(*capacity < size)
+   {
+      *capacity = size;
+      *buffer = realloc(*buffer, size);
+   }
+
+   return *buffer;
+}
+
+static void pullAdd(I_List_t *interface, void *item)
+{
+   REINTERPRET(pull, interface, Lexer_StaticLookup_Pull_t *);
+   (void)item;   // Always the lexer's own token, which is read from there
+   pull->added = true;
+}
+
+/*
+ * Lex until the next token, each action adding at most one.
+ *
+ * @return - false if the source ran out first
+ */
+static bool Pull(Lexer_StaticLookup_t *instance, Token_t *token)
+{
+   instance->pull.added = false;
+
+   while(!instance->pull.added)
+   {
+      if(instance->current >= instance->end || instance->halted)
+      {
+         return false;
+      }
+
+      Dispatch(instance);
+   }
+
+   *token = instance->token;
+   return true;
+}
+
+static void HoldBack(Lexer_StaticLookup_t *instance, const char *from, const char *to, char previous)
+{
+   // from may point into the carry buffer itself, so move rather than copy
+   memmove(Reserve(&instance->carry, &instance->carryCapacity, to - from), from, to - from);
+   instance->carryLength = to - from;
+   instance->carryPrevious = previous;
+}
+
+/*
+ * Finish the token held back from the previous chunk by lexing it from a
+ * scratch copy with the start of this chunk appended, appending more of the
+ * chunk until the token is complete.
+ *
+ * @return - number of characters of the chunk that were used up
+ */
+static size_t FinishHeldBackToken(Lexer_StaticLookup_t *instance, const char *chunk, size_t length)
+{
+   size_t take = (length < LEXER_STATICLOOKUP_FIRST_TAKE) ? length : LEXER_STATICLOOKUP_FIRST_TAKE;
+
+   for(;;)
+   {
+      char *joined = Reserve(&instance->joined, &instance->joinedCapacity, instance->carryLength + take);
+      memcpy(joined, instance->carry, instance->carryLength);
+      memcpy(joined + instance->carryLength, chunk, take);
+
+      SetSource(instance, joined, instance->carryLength + take, instance->carryPrevious, false);
+      instance->copyLexemes = true;
+      Run(instance, joined + instance->carryLength);
+      instance->copyLexemes = false;
+
+      if(!instance->starved)
+      {
+         size_t used = instance->current - (joined + instance->carryLength);
+         instance->carryLength = 0;
+         instance->previous = PeekPrevious(instance);
+         return used;
+      }
+
+      if(take == length)
+      {
+         // Still not finished, so all of this chunk becomes part of the held back token
+         HoldBack(instance, instance->current, instance->end, PeekPrevious(instance));
+         return length;
+      }
+
+      // Keep only what's left of the old held back characters and try with more of the chunk
+      HoldBack(instance, instance->current, joined + instance->carryLength, PeekPrevious(instance));
+      take = (take * 2 < length) ? take * 2 : length;
+   }
+}
+
 void Lexer_StaticLookup_Init(Lexer_StaticLookup_t *instance, I_Error_t *errorHandler)
 {
    instance->interface.lex = &lex;
+   instance->interface.lexSpan = &lexSpan;
    instance->errorHandler = errorHandler;
+
+   instance->carry = NULL;
+   instance->carryLength = 0;
+   instance->carryCapacity = 0;
+   instance->joined = NULL;
+   instance->joinedCapacity = 0;
+   instance->spill = NULL;
+   instance->lineIndex = NULL;
+   instance->omitLines = false;
+   instance->diagnostics = NULL;
+   instance->recordDiagnostics = false;
+   instance->halted = false;
+   instance->brackets = NULL;
+   instance->trackBrackets = false;
+   instance->tokenCount = 0;
+   instance->numbers = NULL;
+   instance->trackNumbers = false;
+
+   // Only add is ever used by the lexer
+   instance->pull.interface.at = NULL;
+   instance->pull.interface.set = NULL;
+   instance->pull.interface.add = &pullAdd;
+   instance->lookaheadFirst = 0;
+   instance->lookaheadCount = 0;
+
+   STATS(instance->stats = NULL;)
+}
+
+void Lexer_StaticLookup_SetLineIndex(Lexer_StaticLookup_t *instance, LineIndex_t *lineIndex)
+{
+   instance->lineIndex = lineIndex;
+}
+
+void Lexer_StaticLookup_SetBracketIndex(Lexer_StaticLookup_t *instance, BracketIndex_t *brackets)
+{
+   instance->brackets = brackets;
+}
+
+void Lexer_StaticLookup_SetNumberTable(Lexer_StaticLookup_t *instance, NumberTable_t *numbers)
+{
+   instance->numbers = numbers;
+}
+
+void Lexer_StaticLookup_SetDiagnostics(Lexer_StaticLookup_t *instance, Diagnostics_t *diagnostics)
+{
+   instance->diagnostics = diagnostics;
+}
+
+bool Lexer_StaticLookup_Halted(const Lexer_StaticLookup_t *instance)
+{
+   return instance->halted;
+}
+
+#ifdef PARSER_STATS
+void Lexer_StaticLookup_SetStats(Lexer_StaticLookup_t *instance, Lexer_StaticLookup_Stats_t *stats)
+{
+   instance->stats = stats;
+}
+
+const char *Lexer_StaticLookup_ActionName(Lexer_StaticLookup_Action_t action)
+{
+   return actionNames[action];
+}
+#endif
+
+/*
+ * Free every spill block but the newest, which is emptied to be filled again.
+ */
+static void RecycleSpill(Lexer_StaticLookup_t *instance)
+{
+   if(instance->spill == NULL)
+   {
+      return;
+   }
+
+   while(instance->spill->next != NULL)
+   {
+      Lexer_StaticLookup_Spill_t *next = instance->spill->next->next;
+      free(instance->spill->next);
+      instance->spill->next = next;
+   }
+   instance->spill->used = 0;
+}
+
+void Lexer_StaticLookup_Deinit(Lexer_StaticLookup_t *instance)
+{
+   RecycleSpill(instance);
+   free(instance->spill);
+
+   free(instance->carry);
+   free(instance->joined);
+   Lexer_StaticLookup_Init(instance, instance->errorHandler);
+}
+
+void Lexer_StaticLookup_Begin(Lexer_StaticLookup_t *instance, I_List_t *tokens)
+{
+   RecycleSpill(instance);
+
+   instance->tokenList = tokens;
+   instance->typedTokens = TokenList_Of(tokens);
+   instance->line = 1;
+   instance->previous = ' ';
+   instance->carryLength = 0;
+   instance->copyLexemes = false;
+   instance->omitLines = false;
+   instance->recordDiagnostics = false;
+   instance->halted = false;
+   instance->trackBrackets = false;
+   instance->trackNumbers = false;
+}
+
+void Lexer_StaticLookup_Feed(Lexer_StaticLookup_t *instance, const char *chunk, size_t length)
+{
+   size_t used = 0;
+
+   if(length == 0)
+   {
+      return;
+   }
+
+   if(instance->carryLength > 0)
+   {
+      used = FinishHeldBackToken(instance, chunk, length);
+      if(used == length)
+      {
+         return;
+      }
+   }
+
+   SetSource(instance, chunk + used, length - used, instance->previous, false);
+   Run(instance, instance->end);
+
+   if(instance->starved)
+   {
+      HoldBack(instance, instance->current, instance->end, PeekPrevious(instance));
+   }
+   else
+   {
+      instance->previous = chunk[length - 1];
+   }
+}
+
+void Lexer_StaticLookup_End(Lexer_StaticLookup_t *instance)
+{
+   if(instance->carryLength > 0)
+   {
+      SetSource(instance, instance->carry, instance->carryLength, instance->carryPrevious, true);
+      instance->copyLexemes = true;
+      Run(instance, instance->end);
+      instance->copyLexemes = false;
+      instance->carryLength = 0;
+   }
+}
+
+void Lexer_StaticLookup_ReleaseSpill(Lexer_StaticLookup_t *instance)
+{
+   RecycleSpill(instance);
+}
+
+void Lexer_StaticLookup_Open(Lexer_StaticLookup_t *instance, const char *source, size_t length)
+{
+   SetSource(instance, source, length, ' ', true);
+   instance->tokenList = &instance->pull.interface;
+   instance->typedTokens = NULL;
+   instance->line = 1;
+   instance->starved = false;
+   instance->copyLexemes = false;
+   instance->omitLines = false;
+   instance->recordDiagnostics = (instance->diagnostics != NULL);
+   instance->halted = false;
+   instance->trackBrackets = false;
+   instance->trackNumbers = false;
+   instance->lookaheadFirst = 0;
+   instance->lookaheadCount = 0;
+}
+
+bool Lexer_StaticLookup_NextToken(Lexer_StaticLookup_t *instance, Token_t *token)
+{
+   if(instance->lookaheadCount > 0)
+   {
+      *token = instance->lookahead[instance->lookaheadFirst];
+      instance->lookaheadFirst = (instance->lookaheadFirst + 1) % LEXER_STATICLOOKUP_LOOKAHEAD;
+      instance->lookaheadCount--;
+      return true;
+   }
+
+   return Pull(instance, token);
+}
+
+bool Lexer_StaticLookup_PeekToken(Lexer_StaticLookup_t *instance, size_t ahead, Token_t *token)
+{
+   if(ahead >= LEXER_STATICLOOKUP_LOOKAHEAD)
+   {
+      return false;
+   }
+
+   while(instance->lookaheadCount <= ahead)
+   {
+      size_t slot = (instance->lookaheadFirst + instance->lookaheadCount) % LEXER_STATICLOOKUP_LOOKAHEAD;
+
+      if(!Pull(instance, &instance->lookahead[slot]))
+      {
+         return false;
+      }
+      instance->lookaheadCount++;
+   }
+
+   *token = instance->lookahead[(instance->lookaheadFirst + ahead) % LEXER_STATICLOOKUP_LOOKAHEAD];
+   return true;
+}
+
+size_t Lexer_StaticLookup_Pending(const Lexer_StaticLookup_t *instance)
+{
+   return instance->carryLength;
 }
@@ -6,9 +6,62 @@
 #ifndef _LEXER_STATICLOOKUP_H
 #define _LEXER_STATICLOOKUP_H
 
+#include <stdbool.h>
 #include "I_Lexer.h"
 #include "I_Error.h"
 #include "Token.h"
+#include "LineIndex.h"
+#include "Diagnostics.h"
+#include "BracketIndex.h"
+#include "NumberTable.h"
+#include "TokenList.h"
+
+#define LEXER_STATICLOOKUP_LOOKAHEAD (4)
+
+typedef struct Lexer_StaticLookup_Spill_t Lexer_StaticLookup_Spill_t;
+
+// Stands in for the token list while tokens are pulled one at a time
+typedef struct
+{
+   I_List_t interface;
+   bool added;                // The lexer's token was filled in since this was last cleared
+} Lexer_StaticLookup_Pull_t;
+
+#ifdef PARSER_STATS
+#include <stdint.h>
+
+// Handlers in the lexer's table, plus the one for non-ascii characters
+enum
+{
+   Lexer_StaticLookup_Action_Ignore = 0,
+   Lexer_StaticLookup_Action_IncrementLineCounter,
+   Lexer_StaticLookup_Action_ReportUnexpectedCharacter,
+   Lexer_StaticLookup_Action_Identifier,
+   Lexer_StaticLookup_Action_Symbol,
+   Lexer_StaticLookup_Action_DigraphOrSymbol,
+   Lexer_StaticLookup_Action_NumberLiteralOrIdentifier,
+   Lexer_StaticLookup_Action_StringLiteral,
+   Lexer_StaticLookup_Action_Exclamation,
+   Lexer_StaticLookup_Action_Pound,
+   Lexer_StaticLookup_Action_Dot,
+   Lexer_StaticLookup_Action_Colon,
+   Lexer_StaticLookup_Action_Dash,
+   Lexer_StaticLookup_Action_Tilde,
+   Lexer_StaticLookup_Action_NonAscii,
+
+   Lexer_StaticLookup_Action_Count
+};
+typedef int Lexer_StaticLookup_Action_t;
+
+typedef struct
+{
+   size_t calls[Lexer_StaticLookup_Action_Count];
+   size_t bytes[Lexer_StaticLookup_Action_Count];     // Scanned by each handler
+   uint64_t ticks[Lexer_StaticLookup_Action_Count];   // See Stats_Ticks
+   size_t tokens[Token_Type_Count];
+   size_t starves;   // Handlers run again because they reached the end of a chunk
+} Lexer_StaticLookup_Stats_t;
+#endif
 
 typedef struct
 {
@@ -16,10 +69,49 @@ typedef struct
 
    I_Error_t *errorHandler;
    I_List_t *tokenList;
+   TokenList_t *typedTokens;  // tokenList, if it's a TokenList, so tokens are added without calling through it
    Token_t token;
    const char *beginning;
    const char *current;
+   const char *end;
    size_t line;
+
+   LineIndex_t *lineIndex;    // Filled instead of giving tokens a line, if not NULL
+   bool omitLines;            // Tokens get line 0, and newlines go in lineIndex
+
+   Diagnostics_t *diagnostics;   // Errors are recorded here instead of reported, if not NULL
+   bool recordDiagnostics;       // Errors go to diagnostics rather than errorHandler
+   bool halted;                  // diagnostics reached its limit, so lexing stopped
+
+   BracketIndex_t *brackets;     // Filled with where each bracket closes, if not NULL
+   bool trackBrackets;           // Brackets are matched for this source
+   size_t tokenCount;            // Added since the source began
+
+   NumberTable_t *numbers;       // Filled with the value of each number, if not NULL
+   bool trackNumbers;            // Numbers are decoded for this source
+
+   // Streaming state
+   char previous;             // Character before beginning
+   bool final;                // No more source comes after end
+   bool starved;              // Current action needs characters past end
+   bool copyLexemes;          // Lexemes point into scratch memory and must be copied
+   char *carry;               // Unfinished token held back from the last chunk
+   size_t carryLength;
+   size_t carryCapacity;
+   char carryPrevious;
+   char *joined;              // Held back token with the start of the next chunk appended
+   size_t joinedCapacity;
+   Lexer_StaticLookup_Spill_t *spill;  // Copies of lexemes that spanned two chunks
+
+   // Pull state
+   Lexer_StaticLookup_Pull_t pull;
+   Token_t lookahead[LEXER_STATICLOOKUP_LOOKAHEAD];  // Ring of tokens peeked at but not taken yet
+   size_t lookaheadFirst;
+   size_t lookaheadCount;
+
+#ifdef PARSER_STATS
+   Lexer_StaticLookup_Stats_t *stats;  // Counted into, if not NULL
+#endif
 } Lexer_StaticLookup_t;
 
 /*
@@ -27,4 +119,150 @@ typedef struct
  */
 void Lexer_StaticLookup_Init(Lexer_StaticLookup_t *instance, I_Error_t *errorHandler);
 
+/*
+ * Stop giving tokens a line number (they all get line 0) and fill lineIndex with
+ * the newlines of each source as it is lexed instead, to find the line and
+ * column of a token from its offset with LineIndex_Locate. Errors still get
+ * line numbers.
+ *
+ * Only affects lex and lexSpan, not Lexer_StaticLookup_Feed.
+ *
+ * @param lineIndex - initialized index to fill, or NULL to give tokens lines again
+ */
+void Lexer_StaticLookup_SetLineIndex(Lexer_StaticLookup_t *instance, LineIndex_t *lineIndex);
+
+/*
+ * Match the brackets of each source lexed, filling brackets with where each
+ * opener is closed and how deeply it is nested. Token indices count from the
+ * first token added for the source. A closer that matches no open bracket is
+ * reported as unmatched and skipped; brackets it or the end of the source
+ * leaves open are reported as unclosed, at the line of their opener.
+ *
+ * Only affects lex and lexSpan, not Lexer_StaticLookup_Feed or
+ * Lexer_StaticLookup_Open.
+ *
+ * @param brackets - initialized index to fill, or NULL to stop matching brackets
+ */
+void Lexer_StaticLookup_SetBracketIndex(Lexer_StaticLookup_t *instance, BracketIndex_t *brackets);
+
+/*
+ * Decode the number literals of each source lexed into numbers, including byte
+ * and bit widths like 6' and 3". Token indices count from the first token added
+ * for the source.
+ *
+ * Only affects lex and lexSpan, not Lexer_StaticLookup_Feed or
+ * Lexer_StaticLookup_Open.
+ *
+ * @param numbers - initialized table to fill, or NULL to stop decoding numbers
+ */
+void Lexer_StaticLookup_SetNumberTable(Lexer_StaticLookup_t *instance, NumberTable_t *numbers);
+
+/*
+ * Record errors found by lex and lexSpan in diagnostics instead of formatting
+ * them and reporting them to the error handler. Lexing stops early once
+ * diagnostics reaches its maxErrors (see Lexer_StaticLookup_Halted). Records
+ * point into the source by offset, so replay them with the same source.
+ *
+ * Affects lex, lexSpan and Lexer_StaticLookup_Open; Lexer_StaticLookup_Feed
+ * always reports errors.
+ *
+ * @param diagnostics - initialized sink, or NULL to report errors again
+ */
+void Lexer_StaticLookup_SetDiagnostics(Lexer_StaticLookup_t *instance, Diagnostics_t *diagnostics);
+
+/*
+ * Whether the last lex, lexSpan or pulled source stopped early because its
+ * diagnostics were full.
+ */
+bool Lexer_StaticLookup_Halted(const Lexer_StaticLookup_t *instance);
+
+#ifdef PARSER_STATS
+/*
+ * Count what the lexer does into stats from now on. Counts are added to
+ * whatever is already there.
+ *
+ * @param stats - where to count, or NULL to stop counting
+ */
+void Lexer_StaticLookup_SetStats(Lexer_StaticLookup_t *instance, Lexer_StaticLookup_Stats_t *stats);
+
+/*
+ * Name of a handler, e.g. "Identifier".
+ */
+const char *Lexer_StaticLookup_ActionName(Lexer_StaticLookup_Action_t action);
+#endif
+
+/*
+ * Free memory held by a Lexer_StaticLookup. Tokens from Lexer_StaticLookup_Feed
+ * whose lexemes spanned two chunks become invalid.
+ */
+void Lexer_StaticLookup_Deinit(Lexer_StaticLookup_t *instance);
+
+/*
+ * Start lexing a source that arrives in chunks, e.g. from a pipe or socket.
+ *
+ * @param tokens - list the tokens are added to
+ * @post Tokens from an earlier source whose lexemes spanned two chunks become
+ *       invalid, as with Lexer_StaticLookup_ReleaseSpill.
+ */
+void Lexer_StaticLookup_Begin(Lexer_StaticLookup_t *instance, I_List_t *tokens);
+
+/*
+ * Lex the next chunk of the source. A token that might carry on into the next
+ * chunk is held back until it does (or until Lexer_StaticLookup_End).
+ *
+ * Tokens point into the chunk, so it must outlive them. Tokens that spanned two
+ * chunks point into memory owned by the lexer instead, which stays valid until
+ * Lexer_StaticLookup_ReleaseSpill, the next Lexer_StaticLookup_Begin or
+ * Lexer_StaticLookup_Deinit, whichever comes first.
+ */
+void Lexer_StaticLookup_Feed(Lexer_StaticLookup_t *instance, const char *chunk, size_t length);
+
+/*
+ * Finish the source, adding any token still held back.
+ */
+void Lexer_StaticLookup_End(Lexer_StaticLookup_t *instance);
+
+/*
+ * Give back the memory holding lexemes of tokens that spanned two chunks, once
+ * the caller is done with every token fed so far. Without it that memory grows
+ * with the number of such tokens until the next source begins. Lexing can go
+ * on after it; a token still held back isn't affected.
+ *
+ * @post Tokens from Lexer_StaticLookup_Feed or Lexer_StaticLookup_End whose
+ *       lexemes spanned two chunks become invalid.
+ */
+void Lexer_StaticLookup_ReleaseSpill(Lexer_StaticLookup_t *instance);
+
+/*
+ * Start lexing a source one token at a time, without a token list. Tokens are
+ * only lexed when Lexer_StaticLookup_NextToken or Lexer_StaticLookup_PeekToken
+ * asks for them, and errors are reported (or recorded) as they are reached.
+ *
+ * Tokens point into the source, so it must outlive them.
+ */
+void Lexer_StaticLookup_Open(Lexer_StaticLookup_t *instance, const char *source, size_t length);
+
+/*
+ * Take the next token of the source opened with Lexer_StaticLookup_Open.
+ *
+ * @return - false if there are no tokens left (token is left alone)
+ */
+bool Lexer_StaticLookup_NextToken(Lexer_StaticLookup_t *instance, Token_t *token);
+
+/*
+ * Look at a token coming up without taking it.
+ *
+ * @param ahead - 0 for the token Lexer_StaticLookup_NextToken would return next,
+ *                1 for the one after, and so on, up to LEXER_STATICLOOKUP_LOOKAHEAD - 1
+ * @return - false if the source ends before that token, or ahead is too far
+ *           (token is left alone)
+ */
+bool Lexer_StaticLookup_PeekToken(Lexer_StaticLookup_t *instance, size_t ahead, Token_t *token);
+
+/*
+ * Number of characters at the end of the last chunk fed that are being held
+ * back because the token there might carry on into the next chunk.
+ */
+size_t Lexer_StaticLookup_Pending(const Lexer_StaticLookup_t *instance);
+
 #endif
@@ -0,0 +1,490 @@
+/***
+ * File: Parser.c
+ *
+ * Every construct that can go wrong reports it and goes on: a token that can't
+ * start an expression becomes an Error node, and a missing closer is reported
+ * and assumed. So one parse finds every error it can, and the tree always
+ * covers the whole source.
+ *
+ * Nodes are referred to by index only, since the array moves as it grows.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Parser.h"
+
+#define PARSER_ERROR_LEXEME_LENGTH (32)   // Most of a lexeme quoted in an error message
+
+// How tightly operators hold their operands; higher binds first
+enum
+{
+   Parser_Power_None = 0,
+   Parser_Power_Assignment = 10,
+   Parser_Power_Type = 20,
+   Parser_Power_Range = 30,
+   Parser_Power_Comparison = 40,
+   Parser_Power_Sum = 50,
+   Parser_Power_Product = 60,
+   Parser_Power_Prefix = 70,
+   Parser_Power_Postfix = 80
+};
+
+typedef struct
+{
+   uint8_t left;        // Taken by the operator from what's before it
+   uint8_t right;       // Given to what's after it; one less than left for right-associative
+} Parser_Binding_t;
+
+static const Parser_Binding_t infixBindings[Token_Type_Count] =
+{
+   [Token_Type_Equal]              = { Parser_Power_Assignment, Parser_Power_Assignment - 1 },
+   [Token_Type_Colon]              = { Parser_Power_Type,       Parser_Power_Type - 1       },
+   [Token_Type_DotDot]             = { Parser_Power_Range,      Parser_Power_Range          },
+   [Token_Type_DotDotDot]          = { Parser_Power_Range,      Parser_Power_Range          },
+   [Token_Type_EqualEqual]         = { Parser_Power_Comparison, Parser_Power_Comparison     },
+   [Token_Type_BangEqual]          = { Parser_Power_Comparison, Parser_Power_Comparison     },
+   [Token_Type_AngleBracket_Left]  = { Parser_Power_Comparison, Parser_Power_Comparison     },
+   [Token_Type_AngleBracket_Right] = { Parser_Power_Comparison, Parser_Power_Comparison     },
+   [Token_Type_LessEqual]          = { Parser_Power_Comparison, Parser_Power_Comparison     },
+   [Token_Type_GreaterEqual]       = { Parser_Power_Comparison, Parser_Power_Comparison     },
+   [Token_Type_Plus]               = { Parser_Power_Sum,        Parser_Power_Sum            },
+   [Token_Type_Dash]               = { Parser_Power_Sum,        Parser_Power_Sum            },
+   [Token_Type_Asterisk]           = { Parser_Power_Product,    Parser_Power_Product        },
+   [Token_Type_Slash]              = { Parser_Power_Product,    Parser_Power_Product        },
+   [Token_Type_Dot]                = { Parser_Power_Postfix,    Parser_Power_Postfix        }
+};
+
+// Tokens that start an expression, and the kind of node those that are one token make
+static const Parser_Node_Kind_t leafKinds[Token_Type_Count] =
+{
+   [Token_Type_Identifier]         = Parser_Node_Kind_Identifier,
+   [Token_Type_Literal_Number]     = Parser_Node_Kind_Number,
+   [Token_Type_Literal_String]     = Parser_Node_Kind_String,
+   [Token_Type_Literal_Symbol]     = Parser_Node_Kind_Symbol
+};
+
+static const bool startsExpression[Token_Type_Count] =
+{
+   [Token_Type_Identifier]         = true,
+   [Token_Type_Literal_Number]     = true,
+   [Token_Type_Literal_String]     = true,
+   [Token_Type_Literal_Symbol]     = true,
+   [Token_Type_Dash]               = true,
+   [Token_Type_Dollar]             = true,
+   [Token_Type_Pound]              = true,
+   [Token_Type_Arroba]             = true,
+   [Token_Type_Paren_Left]         = true,
+   [Token_Type_SquareBrace_Left]   = true,
+   [Token_Type_CurlyBrace_Left]    = true
+};
+
+static const char *kindNames[Parser_Node_Kind_Count] =
+{
+   [Parser_Node_Kind_Program]    = "Program",
+   [Parser_Node_Kind_Block]      = "Block",
+   [Parser_Node_Kind_Phrase]     = "Phrase",
+   [Parser_Node_Kind_Group]      = "Group",
+   [Parser_Node_Kind_List]       = "List",
+   [Parser_Node_Kind_Call]       = "Call",
+   [Parser_Node_Kind_Index]      = "Index",
+   [Parser_Node_Kind_Unary]      = "Unary",
+   [Parser_Node_Kind_Binary]     = "Binary",
+   [Parser_Node_Kind_Identifier] = "Identifier",
+   [Parser_Node_Kind_Number]     = "Number",
+   [Parser_Node_Kind_String]     = "String",
+   [Parser_Node_Kind_Symbol]     = "Symbol",
+   [Parser_Node_Kind_Error]      = "Error"
+};
+
+// Children of a node being built, in order
+typedef struct
+{
+   uint32_t first;
+   uint32_t last;
+} Parser_Children_t;
+
+static uint32_t ParseExpression(Parser_t *instance, uint8_t power);
+static uint32_t ParseStatement(Parser_t *instance);
+static void ParseStatements(Parser_t *instance, Parser_Children_t *children, Token_Type_t closer);
+
+/*********************************
+ * Tokens
+ *********************************/
+static const Token_t *Peek(const Parser_t *instance)
+{
+   return (instance->position < instance->count) ? &instance->tokens[instance->position] : NULL;
+}
+
+static bool At(const Parser_t *instance, Token_Type_t type)
+{
+   return instance->position < instance->count && instance->tokens[instance->position].type == type;
+}
+
+// Whether the next token starts a new line where lines end statements
+static bool AtNewLine(const Parser_t *instance)
+{
+   return instance->groupDepth == 0 && instance->position > 0 && instance->position < instance->count &&
+          instance->tokens[instance->position].line != instance->tokens[instance->position - 1].line;
+}
+
+// Whether the next token follows the one before with nothing between them
+static bool AtTouching(const Parser_t *instance)
+{
+   const Token_t *previous = &instance->tokens[instance->position - 1];
+
+   return instance->tokens[instance->position].lexeme == previous->lexeme + previous->length;
+}
+
+// Report an error about a token, quoting it where format has its '%.*s'
+static void ReportAt(Parser_t *instance, const Token_t *token, const char *format)
+{
+   char message[128];
+   int length = (token->length < PARSER_ERROR_LEXEME_LENGTH) ? (int)token->length : PARSER_ERROR_LEXEME_LENGTH;
+
+   snprintf(message, sizeof(message), format, length, token->lexeme);
+   instance->errorCount++;
+   Error_Report(instance->errorHandler, token->line, message);
+}
+
+// Report an error found after the last token, on the line of the last token
+static void ReportAtEnd(Parser_t *instance, const char *message)
+{
+   instance->errorCount++;
+   Error_Report(instance->errorHandler, (instance->count > 0) ? instance->tokens[instance->count - 1].line : 1, message);
+}
+
+/*********************************
+ * Nodes
+ *********************************/
+static uint32_t AddNode(Parser_t *instance, Parser_Node_Kind_t kind, Token_Type_t op, size_t token, uint32_t first)
+{
+   Parser_Node_t *node;
+
+   if(instance->nodeCount == instance->allocatedNodeCount)
+   {
+      instance->allocatedNodeCount = (instance->allocatedNodeCount + 1) * 3 / 2;
+      instance->nodes = realloc(instance->nodes, instance->allocatedNodeCount * sizeof(Parser_Node_t));
+   }
+
+   node = &instance->nodes[instance->nodeCount];
+   node->kind = kind;
+   node->op = op;
+   node->token = (token < instance->count) ? (uint32_t)token : PARSER_NONE;
+   node->first = first;
+   node->next = PARSER_NONE;
+   return (uint32_t)instance->nodeCount++;
+}
+
+static void AddChild(Parser_t *instance, Parser_Children_t *children, uint32_t child)
+{
+   if(children->first == PARSER_NONE)
+   {
+      children->first = child;
+   }
+   else
+   {
+      instance->nodes[children->last].next = child;
+   }
+   children->last = child;
+}
+
+/*********************************
+ * Grammar
+ *********************************/
+
+/*
+ * Parse the entries between an opened bracket and its closer, separated by
+ * commas.
+ *
+ * @return - number of entries plus commas, so one entry alone can be told apart
+ */
+static size_t ParseEntries(Parser_t *instance, Parser_Children_t *children, size_t opener, Token_Type_t closer)
+{
+   size_t parts = 0;
+
+   instance->groupDepth++;
+   while(true)
+   {
+      const Token_t *token = Peek(instance);
+
+      if(token == NULL || token->type == Token_Type_CurlyBrace_Right || token->type == Token_Type_Paren_Right ||
+         token->type == Token_Type_SquareBrace_Right)
+      {
+         if(token != NULL && token->type == closer)
+         {
+            instance->position++;
+         }
+         else
+         {
+            char format[64];
+
+            snprintf(format, sizeof(format), "Missing '%c' to close the '%%.*s' on line %zu",
+                     (closer == Token_Type_Paren_Right) ? ')' : ']', instance->tokens[opener].line);
+            ReportAt(instance, &instance->tokens[opener], format);
+         }
+         break;
+      }
+      else if(token->type == Token_Type_Comma)
+      {
+         instance->position++;
+         parts++;
+      }
+      else if(startsExpression[token->type])
+      {
+         AddChild(instance, children, ParseStatement(instance));
+         parts++;
+      }
+      else
+      {
+         ReportAt(instance, token, "Unexpected '%.*s'");
+         instance->position++;
+      }
+   }
+   instance->groupDepth--;
+
+   return parts;
+}
+
+static uint32_t ParseBlock(Parser_t *instance, size_t opener)
+{
+   Parser_Children_t children = { PARSER_NONE, PARSER_NONE };
+   size_t groupDepth = instance->groupDepth;
+
+   instance->groupDepth = 0;
+   ParseStatements(instance, &children, Token_Type_CurlyBrace_Right);
+   instance->groupDepth = groupDepth;
+
+   if(At(instance, Token_Type_CurlyBrace_Right))
+   {
+      instance->position++;
+   }
+   else
+   {
+      char format[64];
+
+      snprintf(format, sizeof(format), "Missing '}' to close the '%%.*s' on line %zu", instance->tokens[opener].line);
+      ReportAt(instance, &instance->tokens[opener], format);
+   }
+
+   return AddNode(instance, Parser_Node_Kind_Block, Token_Type_CurlyBrace_Left, opener, children.first);
+}
+
+static uint32_t ParsePrefix(Parser_t *instance)
+{
+   size_t start = instance->position;
+   const Token_t *token = Peek(instance);
+   Parser_Children_t children = { PARSER_NONE, PARSER_NONE };
+   size_t parts;
+
+   if(token == NULL)
+   {
+      ReportAtEnd(instance, "Expected an expression at the end");
+      return AddNode(instance, Parser_Node_Kind_Error, Token_Type_Unused, start, PARSER_NONE);
+   }
+
+   if(!startsExpression[token->type])
+   {
+      // Closers and commas are left for whatever opened the entries or block to deal with
+      if(token->type == Token_Type_Comma || token->type == Token_Type_Paren_Right ||
+         token->type == Token_Type_SquareBrace_Right || token->type == Token_Type_CurlyBrace_Right)
+      {
+         ReportAt(instance, token, "Expected an expression before '%.*s'");
+      }
+      else
+      {
+         ReportAt(instance, token, "Unexpected '%.*s'");
+         instance->position++;
+      }
+      return AddNode(instance, Parser_Node_Kind_Error, token->type, start, PARSER_NONE);
+   }
+
+   instance->position++;
+   switch(token->type)
+   {
+      case Token_Type_Paren_Left:
+         parts = ParseEntries(instance, &children, start, Token_Type_Paren_Right);
+
+         // Parentheses around one entry only group it
+         if(parts == 1 && children.first != PARSER_NONE)
+         {
+            return children.first;
+         }
+         return AddNode(instance, Parser_Node_Kind_Group, token->type, start, children.first);
+
+      case Token_Type_SquareBrace_Left:
+         ParseEntries(instance, &children, start, Token_Type_SquareBrace_Right);
+         return AddNode(instance, Parser_Node_Kind_List, token->type, start, children.first);
+
+      case Token_Type_CurlyBrace_Left:
+         return ParseBlock(instance, start);
+
+      case Token_Type_Dash:
+      case Token_Type_Dollar:
+      case Token_Type_Pound:
+      case Token_Type_Arroba:
+         return AddNode(instance, Parser_Node_Kind_Unary, token->type, start, ParseExpression(instance, Parser_Power_Prefix));
+
+      default:
+         return AddNode(instance, leafKinds[token->type], token->type, start, PARSER_NONE);
+   }
+}
+
+static uint32_t ParseExpression(Parser_t *instance, uint8_t power)
+{
+   uint32_t left;
+
+   if(instance->depth >= PARSER_MAX_DEPTH)
+   {
+      const Token_t *token = Peek(instance);
+
+      if(!instance->tooDeep)
+      {
+         instance->tooDeepError = instance->errorCount;
+         if(token != NULL)
+         {
+            ReportAt(instance, token, "Nested too deeply at '%.*s'");
+         }
+         else
+         {
+            ReportAtEnd(instance, "Nested too deeply at the end");
+         }
+         instance->tooDeep = true;
+      }
+      instance->position += (token != NULL) ? 1 : 0;
+      return AddNode(instance, Parser_Node_Kind_Error, (token != NULL) ? token->type : Token_Type_Unused, instance->position - 1, PARSER_NONE);
+   }
+
+   instance->depth++;
+   left = ParsePrefix(instance);
+
+   while(instance->position < instance->count && !AtNewLine(instance))
+   {
+      size_t start = instance->position;
+      Token_Type_t type = instance->tokens[start].type;
+      Parser_Children_t children = { left, left };
+
+      if((type == Token_Type_Paren_Left || type == Token_Type_SquareBrace_Left) && power < Parser_Power_Postfix && AtTouching(instance))
+      {
+         instance->position++;
+         ParseEntries(instance, &children, start, (type == Token_Type_Paren_Left) ? Token_Type_Paren_Right : Token_Type_SquareBrace_Right);
+         left = AddNode(instance, (type == Token_Type_Paren_Left) ? Parser_Node_Kind_Call : Parser_Node_Kind_Index, type, start, left);
+      }
+      else if(infixBindings[type].left > power)
+      {
+         instance->position++;
+         AddChild(instance, &children, ParseExpression(instance, infixBindings[type].right));
+         left = AddNode(instance, Parser_Node_Kind_Binary, type, start, left);
+      }
+      else
+      {
+         break;
+      }
+   }
+
+   instance->depth--;
+   return left;
+}
+
+// Expressions side by side, up to the end of the line (outside brackets) or anything else
+static uint32_t ParseStatement(Parser_t *instance)
+{
+   size_t start = instance->position;
+   uint32_t first = ParseExpression(instance, Parser_Power_None);
+   Parser_Children_t children = { first, first };
+
+   while(instance->position < instance->count && startsExpression[instance->tokens[instance->position].type] && !AtNewLine(instance))
+   {
+      AddChild(instance, &children, ParseExpression(instance, Parser_Power_None));
+   }
+
+   return (children.last == first) ? first : AddNode(instance, Parser_Node_Kind_Phrase, instance->tokens[start].type, start, first);
+}
+
+/*
+ * Parse statements up to a closer, or the end of the tokens if closer is
+ * Token_Type_Unused. The closer is left for the caller.
+ */
+static void ParseStatements(Parser_t *instance, Parser_Children_t *children, Token_Type_t closer)
+{
+   const Token_t *token;
+
+   while((token = Peek(instance)) != NULL && token->type != closer)
+   {
+      if(token->type == Token_Type_Comma)
+      {
+         instance->position++;
+      }
+      else if(startsExpression[token->type])
+      {
+         AddChild(instance, children, ParseStatement(instance));
+      }
+      else
+      {
+         ReportAt(instance, token, "Unexpected '%.*s'");
+         instance->position++;
+      }
+   }
+}
+
+/*********************************
+ * Public functions
+ *********************************/
+void Parser_Init(Parser_t *instance, I_Error_t *errorHandler)
+{
+   instance->errorHandler = errorHandler;
+   instance->tokens = NULL;
+   instance->count = 0;
+   instance->position = 0;
+   instance->groupDepth = 0;
+   instance->depth = 0;
+   instance->tooDeep = false;
+   instance->tooDeepError = 0;
+
+   instance->nodes = NULL;
+   instance->nodeCount = 0;
+   instance->allocatedNodeCount = 0;
+   instance->root = PARSER_NONE;
+   instance->errorCount = 0;
+}
+
+void Parser_Deinit(Parser_t *instance)
+{
+   free(instance->nodes);
+}
+
+uint32_t Parser_Parse(Parser_t *instance, const Token_t *tokens, size_t count)
+{
+   Parser_Children_t children = { PARSER_NONE, PARSER_NONE };
+
+   instance->tokens = tokens;
+   instance->count = count;
+   instance->position = 0;
+   instance->groupDepth = 0;
+   instance->depth = 0;
+   instance->tooDeep = false;
+   instance->tooDeepError = 0;
+   instance->nodeCount = 0;
+   instance->errorCount = 0;
+
+   // Most sources make a little more than one node per token, so this is usually the only allocation
+   if(instance->allocatedNodeCount < count + count / 4 + 1)
+   {
+      instance->allocatedNodeCount = count + count / 4 + 1;
+      free(instance->nodes);
+      instance->nodes = malloc(instance->allocatedNodeCount * sizeof(Parser_Node_t));
+   }
+
+   ParseStatements(instance, &children, Token_Type_Unused);
+   instance->root = AddNode(instance, Parser_Node_Kind_Program, Token_Type_Unused, 0, children.first);
+   return instance->root;
+}
+
+const Parser_Node_t *Parser_Node(const Parser_t *instance, uint32_t index)
+{
+   return &instance->nodes[index];
+}
+
+const char *Parser_KindName(Parser_Node_Kind_t kind)
+{
+   return kindNames[kind];
+}
@@ -0,0 +1,119 @@
+/***
+ * File: Parser.h
+ * Desc: Builds a syntax tree from the tokens of a source. Operators are parsed
+ *       by precedence from a table (Pratt parsing); everything else is
+ *       recursive descent.
+ *
+ *       The tree is one flat array of 16-byte nodes, children before their
+ *       parents, linked by 32-bit indices: each node points at its first child
+ *       and its next sibling. Keywords and built-ins aren't told apart from
+ *       other identifiers yet; a statement like `if x != 0 { ... }` is a Phrase
+ *       of the expressions side by side in it, for a later pass to bind.
+ *
+ *       Grammar, loosely:
+ *
+ *          program     statement*
+ *          statement   expression+            side by side make a Phrase
+ *          expression  prefix (infix expression | postfix)*
+ *          prefix      leaf | op expression | ( entries ) | [ entries ] | { statement* }
+ *          postfix     ( entries ) | [ entries ]    touching what's before them
+ *          entries     statement? (, statement?)*
+ *
+ *       Outside ( ) and [ ], a token on a new line starts a new statement,
+ *       unless the line before ended with an operator. Commas also separate
+ *       statements.
+ */
+
+#ifndef _PARSER_H
+#define _PARSER_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "I_Error.h"
+#include "Token.h"
+
+#define PARSER_NONE (UINT32_MAX)      // No node, e.g. the first child of a leaf
+#define PARSER_MAX_DEPTH (1024)       // Most nested expressions before the parser stops going deeper
+
+enum
+{
+   Parser_Node_Kind_Program = 0,      // Statements of the whole source
+   Parser_Node_Kind_Block,            // { statements }
+   Parser_Node_Kind_Phrase,           // Expressions side by side
+   Parser_Node_Kind_Group,            // ( entries ), unless it's one entry with no comma
+   Parser_Node_Kind_List,             // [ entries ]
+   Parser_Node_Kind_Call,             // Callee, then the entries of ( )
+   Parser_Node_Kind_Index,            // Target, then the entries of [ ]
+   Parser_Node_Kind_Unary,            // Operand
+   Parser_Node_Kind_Binary,           // Left, then right
+   Parser_Node_Kind_Identifier,
+   Parser_Node_Kind_Number,
+   Parser_Node_Kind_String,
+   Parser_Node_Kind_Symbol,
+   Parser_Node_Kind_Error,            // Something that couldn't be parsed
+
+   Parser_Node_Kind_Count
+};
+typedef uint8_t Parser_Node_Kind_t;
+
+typedef struct
+{
+   Parser_Node_Kind_t kind;
+   Token_Type_t op;                   // Type of the token, e.g. the operator of a Unary or Binary
+   uint32_t token;                    // Index of the token it starts at (the operator for Unary and Binary), or PARSER_NONE
+   uint32_t first;                    // First child, or PARSER_NONE
+   uint32_t next;                     // Next sibling, or PARSER_NONE
+} Parser_Node_t;
+
+typedef struct
+{
+   I_Error_t *errorHandler;
+
+   const Token_t *tokens;
+   size_t count;
+   size_t position;                   // Of the next token to parse
+   size_t groupDepth;                 // ( and [ open since the innermost { or the start
+   size_t depth;
+   bool tooDeep;                      // Nesting reached PARSER_MAX_DEPTH, which is only reported once
+   size_t tooDeepError;               // Index among the errors of that report, if tooDeep
+
+   Parser_Node_t *nodes;
+   size_t nodeCount;
+   size_t allocatedNodeCount;
+   uint32_t root;
+   size_t errorCount;
+} Parser_t;
+
+/*
+ * Initialize a Parser.
+ *
+ * @param errorHandler - gets the syntax errors
+ */
+void Parser_Init(Parser_t *instance, I_Error_t *errorHandler);
+
+/*
+ * Deinitialize a Parser.
+ */
+void Parser_Deinit(Parser_t *instance);
+
+/*
+ * Parse a source's tokens, replacing the tree from the last parse.
+ *
+ * @param tokens - in order, as a lexer gives them; must outlive the tree
+ * @pre - fewer than 2^32 - 1 tokens
+ * @return - index of the Program node, which is the last node
+ */
+uint32_t Parser_Parse(Parser_t *instance, const Token_t *tokens, size_t count);
+
+/*
+ * Point at a node of the tree.
+ */
+const Parser_Node_t *Parser_Node(const Parser_t *instance, uint32_t index);
+
+/*
+ * Name of a kind of node, for printing.
+ */
+const char *Parser_KindName(Parser_Node_Kind_t kind);
+
+#endif
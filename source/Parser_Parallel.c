@@ -0,0 +1,292 @@
+/***
+ * File: Parser_Parallel.c
+ *
+ * The tokens are split just after a '}' that closes a top-level '{' and ends
+ * its line. Parser would have finished a statement there, with no bracket
+ * open and nothing deeper on its stack, so parsing what follows on its own
+ * builds the same nodes it would have. Splits are only made while every
+ * bracket before them has been matched; once one is mismatched, Parser's
+ * recovery might pair the brackets differently, so the rest is one part.
+ *
+ * Each part is parsed by its own Parser into its own array of nodes. Since
+ * Parser adds nodes in source order and the Program node last, the serial tree
+ * is the parts' nodes one after another, each part moved up by the nodes
+ * before it, with the last statement of each part linked to the first of the
+ * next, and one Program node at the end. The nodes are moved on the same
+ * threads that parsed them.
+ */
+
+#include <stdlib.h>
+#include <stdbool.h>
+#include "Parser_Parallel.h"
+#include "Error_Buffer.h"
+#include "Threads.h"
+
+typedef struct
+{
+   Parser_t parser;
+   Error_Buffer_t errors;
+
+   const Token_t *tokens;  // Of this part only
+   size_t count;
+   size_t first;           // Index of its first token in the whole source
+
+   Parser_Node_t *out;     // Where the joined tree's nodes go
+   uint32_t base;          // Index in out of its first node
+   uint32_t nextStatement; // First top-level statement of the parts after it, or PARSER_NONE
+} Worker_t;
+
+static void *Parse(void *argument)
+{
+   Worker_t *worker = argument;
+
+   Parser_Parse(&worker->parser, worker->tokens, worker->count);
+   return NULL;
+}
+
+static uint32_t Move(uint32_t index, uint32_t by)
+{
+   return (index == PARSER_NONE) ? PARSER_NONE : index + by;
+}
+
+/*
+ * Copy the worker's nodes, all but its Program, into the joined tree.
+ */
+static void *Relocate(void *argument)
+{
+   Worker_t *worker = argument;
+   const Parser_Node_t *from = worker->parser.nodes;
+   Parser_Node_t *to = worker->out + worker->base;
+   size_t count = worker->parser.nodeCount - 1;
+
+   for(size_t i = 0; i < count; i++)
+   {
+      to[i].kind = from[i].kind;
+      to[i].op = from[i].op;
+      to[i].token = Move(from[i].token, (uint32_t)worker->first);
+      to[i].first = Move(from[i].first, worker->base);
+      to[i].next = Move(from[i].next, worker->base);
+   }
+
+   // The last node before Program is the last top-level statement
+   if(from[count].first != PARSER_NONE)
+   {
+      to[count - 1].next = worker->nextStatement;
+   }
+
+   return NULL;
+}
+
+static Token_Type_t OpenerOf(Token_Type_t closer)
+{
+   switch(closer)
+   {
+      case Token_Type_Paren_Right: return Token_Type_Paren_Left;
+      case Token_Type_SquareBrace_Right: return Token_Type_SquareBrace_Left;
+      default: return Token_Type_CurlyBrace_Left;
+   }
+}
+
+/*
+ * Split the tokens into at most maxChunks parts, each (but the first) starting
+ * on the line after a top-level '}'. Tracks which brackets are open with a
+ * stack of their types.
+ *
+ * @return - number of parts
+ */
+static size_t Split(const Token_t *tokens, size_t count, size_t maxChunks, size_t *splits)
+{
+   Token_Type_t *stack = NULL;
+   size_t depth = 0;
+   size_t allocatedDepth = 0;
+   size_t chunkCount = 0;
+   bool mismatched = false;
+
+   splits[0] = 0;
+   for(size_t i = 0; i + 1 < count && chunkCount + 1 < maxChunks && !mismatched; i++)
+   {
+      switch(tokens[i].type)
+      {
+         case Token_Type_Paren_Left:
+         case Token_Type_SquareBrace_Left:
+         case Token_Type_CurlyBrace_Left:
+            if(depth == allocatedDepth)
+            {
+               allocatedDepth = (allocatedDepth + 1) * 3 / 2;
+               stack = realloc(stack, allocatedDepth * sizeof(Token_Type_t));
+            }
+            stack[depth++] = tokens[i].type;
+            continue;
+
+         case Token_Type_Paren_Right:
+         case Token_Type_SquareBrace_Right:
+         case Token_Type_CurlyBrace_Right:
+            if(depth == 0 || stack[depth - 1] != OpenerOf(tokens[i].type))
+            {
+               mismatched = true;
+               continue;
+            }
+            depth--;
+            break;
+
+         default:
+            continue;
+      }
+
+      if(depth == 0 && tokens[i].type == Token_Type_CurlyBrace_Right && tokens[i + 1].line != tokens[i].line &&
+         i + 1 >= count / maxChunks * (chunkCount + 1))
+      {
+         splits[++chunkCount] = i + 1;
+      }
+   }
+
+   free(stack);
+   splits[++chunkCount] = count;
+   return chunkCount;
+}
+
+/*
+ * Join the workers' trees into the instance's parser, and report their errors
+ * in order. Nesting too deeply is only reported for the first part it happens in.
+ */
+static void Stitch(Parser_Parallel_t *instance, Worker_t *workers, size_t chunkCount)
+{
+   Parser_t *parser = &instance->parser;
+   size_t nodeCount = 1;
+   uint32_t firstStatement = PARSER_NONE;
+
+   parser->tooDeep = false;
+   parser->errorCount = 0;
+   for(size_t k = 0; k < chunkCount; k++)
+   {
+      Worker_t *worker = &workers[k];
+      Parser_t *part = &worker->parser;
+      bool repeated = part->tooDeep && parser->tooDeep;   // Reported for an earlier part already
+
+      worker->base = (uint32_t)(nodeCount - 1);
+      nodeCount += part->nodeCount - 1;
+
+      if(part->tooDeep && !parser->tooDeep)
+      {
+         parser->tooDeep = true;
+         parser->tooDeepError = parser->errorCount + part->tooDeepError;
+      }
+
+      if(repeated)
+      {
+         Error_Buffer_ReplayRange(&worker->errors, parser->errorHandler, 0, part->tooDeepError, 0);
+         Error_Buffer_ReplayRange(&worker->errors, parser->errorHandler, part->tooDeepError + 1, part->errorCount - part->tooDeepError - 1, 0);
+         parser->errorCount += part->errorCount - 1;
+      }
+      else
+      {
+         Error_Buffer_Replay(&worker->errors, parser->errorHandler, 0);
+         parser->errorCount += part->errorCount;
+      }
+   }
+
+   for(size_t k = chunkCount; k-- > 0;)
+   {
+      const Parser_t *part = &workers[k].parser;
+
+      workers[k].nextStatement = firstStatement;
+      if(part->nodes[part->nodeCount - 1].first != PARSER_NONE)
+      {
+         firstStatement = workers[k].base + part->nodes[part->nodeCount - 1].first;
+      }
+   }
+
+   if(parser->allocatedNodeCount < nodeCount)
+   {
+      parser->allocatedNodeCount = nodeCount;
+      free(parser->nodes);
+      parser->nodes = malloc(nodeCount * sizeof(Parser_Node_t));
+   }
+
+   for(size_t k = 0; k < chunkCount; k++)
+   {
+      workers[k].out = parser->nodes;
+   }
+   Threads_RunAll(workers, chunkCount, sizeof(Worker_t), &Relocate);
+
+   parser->nodes[nodeCount - 1] = (Parser_Node_t){ Parser_Node_Kind_Program, Token_Type_Unused, 0, firstStatement, PARSER_NONE };
+   parser->nodeCount = nodeCount;
+   parser->root = (uint32_t)(nodeCount - 1);
+}
+
+void Parser_Parallel_Init(Parser_Parallel_t *instance, I_Error_t *errorHandler, size_t threadCount)
+{
+   Parser_Init(&instance->parser, errorHandler);
+
+   if(threadCount == 0)
+   {
+      threadCount = Threads_DefaultCount();
+   }
+   instance->threadCount = threadCount;
+   instance->minChunkTokens = PARSER_PARALLEL_MIN_CHUNK_TOKENS;
+   instance->chunkCount = 0;
+}
+
+void Parser_Parallel_Deinit(Parser_Parallel_t *instance)
+{
+   Parser_Deinit(&instance->parser);
+}
+
+uint32_t Parser_Parallel_Parse(Parser_Parallel_t *instance, const Token_t *tokens, size_t count)
+{
+   Parser_t *parser = &instance->parser;
+   size_t maxChunks = count / instance->minChunkTokens;
+   size_t *splits;
+   Worker_t *workers;
+   size_t chunkCount;
+
+   if(maxChunks > instance->threadCount)
+   {
+      maxChunks = instance->threadCount;
+   }
+
+   instance->chunkCount = 1;
+   if(maxChunks <= 1)
+   {
+      return Parser_Parse(parser, tokens, count);
+   }
+
+   splits = malloc((maxChunks + 1) * sizeof(size_t));
+   chunkCount = Split(tokens, count, maxChunks, splits);
+   if(chunkCount == 1)
+   {
+      free(splits);
+      return Parser_Parse(parser, tokens, count);
+   }
+
+   workers = malloc(chunkCount * sizeof(Worker_t));
+   for(size_t k = 0; k < chunkCount; k++)
+   {
+      Error_Buffer_Init(&workers[k].errors);
+      Parser_Init(&workers[k].parser, &workers[k].errors.interface);
+
+      workers[k].tokens = tokens + splits[k];
+      workers[k].count = splits[k + 1] - splits[k];
+      workers[k].first = splits[k];
+   }
+
+   Threads_RunAll(workers, chunkCount, sizeof(Worker_t), &Parse);
+
+   parser->tokens = tokens;
+   parser->count = count;
+   parser->position = count;
+   parser->groupDepth = 0;
+   parser->depth = 0;
+   Stitch(instance, workers, chunkCount);
+   instance->chunkCount = chunkCount;
+
+   for(size_t k = 0; k < chunkCount; k++)
+   {
+      Parser_Deinit(&workers[k].parser);
+      Error_Buffer_Deinit(&workers[k].errors);
+   }
+   free(workers);
+   free(splits);
+
+   return parser->root;
+}
@@ -0,0 +1,51 @@
+/***
+ * File: Parser_Parallel.h
+ * Desc: Parses a source's tokens on several threads by splitting them between
+ *       top-level { } blocks, each part into its own tree, then joins the
+ *       trees into the one Parser would have built.
+ */
+
+#ifndef _PARSER_PARALLEL_H
+#define _PARSER_PARALLEL_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "Parser.h"
+#include "I_Error.h"
+#include "Token.h"
+
+#define PARSER_PARALLEL_MIN_CHUNK_TOKENS (16 * 1024)
+
+typedef struct
+{
+   Parser_t parser;        // Holds the tree, as if it had parsed the tokens itself
+   size_t threadCount;
+   size_t minChunkTokens;  // Fewest tokens per thread worth splitting them up for
+   size_t chunkCount;      // Parts the last parse was split into
+} Parser_Parallel_t;
+
+/*
+ * Initialize a Parser_Parallel. The tree and errors it produces are the same
+ * as Parser's, in the same order.
+ *
+ * @param threadCount - most threads to parse with, or 0 for one per online CPU
+ * @post minChunkTokens is PARSER_PARALLEL_MIN_CHUNK_TOKENS
+ */
+void Parser_Parallel_Init(Parser_Parallel_t *instance, I_Error_t *errorHandler, size_t threadCount);
+
+/*
+ * Deinitialize a Parser_Parallel.
+ */
+void Parser_Parallel_Deinit(Parser_Parallel_t *instance);
+
+/*
+ * Parse a source's tokens, replacing the tree from the last parse. Read the
+ * tree with Parser_Node(&instance->parser, ...).
+ *
+ * @param tokens - in order, as a lexer gives them; must outlive the tree
+ * @pre - fewer than 2^32 - 1 tokens
+ * @return - index of the Program node, which is the last node
+ */
+uint32_t Parser_Parallel_Parse(Parser_Parallel_t *instance, const Token_t *tokens, size_t count);
+
+#endif
@@ -1,42 +1,664 @@
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
+#include <stdbool.h>
+#include "Lexer_StaticLookup.h"
+#include "Lexer_Parallel.h"
+#include "Lexer_Batch.h"
+#include "Lexer_Cache.h"
+#include "List_Arena.h"
+#include "List_Calloc.h"
+#include "TokenList.h"
+#include "Error_Stderr.h"
+#include "SourceFile.h"
+#include "LineIndex.h"
+#include "TokenFile.h"
+#include "Parser.h"
+#include "Parser_Parallel.h"
+#include "Diagnostics.h"
+#include "Token.h"
 
-#define BUF_SIZE (1024)
+static const char *tokenTypeNames[] =
+{
+   [Token_Type_Unused]             = "Unused",
+   [Token_Type_AngleBracket_Left]  = "AngleBracket_Left",
+   [Token_Type_AngleBracket_Right] = "AngleBracket_Right",
+   [Token_Type_Asterisk]           = "Asterisk",
+   [Token_Type_Arroba]             = "Arroba",
+   [Token_Type_Backtick]           = "Backtick",
+   [Token_Type_BangEqual]          = "BangEqual",
+   [Token_Type_Colon]              = "Colon",
+   [Token_Type_Comma]              = "Comma",
+   [Token_Type_CurlyBrace_Left]    = "CurlyBrace_Left",
+   [Token_Type_CurlyBrace_Right]   = "CurlyBrace_Right",
+   [Token_Type_Dash]               = "Dash",
+   [Token_Type_Dollar]             = "Dollar",
+   [Token_Type_Dot]                = "Dot",
+   [Token_Type_DotDot]             = "DotDot",
+   [Token_Type_DotDotDot]          = "DotDotDot",
+   [Token_Type_Equal]              = "Equal",
+   [Token_Type_EqualEqual]         = "EqualEqual",
+   [Token_Type_GreaterEqual]       = "GreaterEqual",
+   [Token_Type_Identifier]         = "Identifier",
+   [Token_Type_Literal_String]     = "Literal_String",
+   [Token_Type_Literal_Number]     = "Literal_Number",
+   [Token_Type_Literal_Symbol]     = "Literal_Symbol",
+   [Token_Type_LessEqual]          = "LessEqual",
+   [Token_Type_Paren_Left]         = "Paren_Left",
+   [Token_Type_Paren_Right]        = "Paren_Right",
+   [Token_Type_Plus]               = "Plus",
+   [Token_Type_Pound]              = "Pound",
+   [Token_Type_Slash]              = "Slash",
+   [Token_Type_SquareBrace_Left]   = "SquareBrace_Left",
+   [Token_Type_SquareBrace_Right]  = "SquareBrace_Right"
+};
 
-static FILE *stream;
-static char buf[BUF_SIZE];
+static void PrintUsage(const char *program)
+{
+   printf("Usage: %s [--count] [--threads N] [--list listfile] [--stats] [--max-errors N] [--cache dir] [--save-tokens file] [--load-tokens file] [--parse] [filename...]\n", program);
+   printf("  Lexes each file (or stdin) and prints its tokens.\n");
+   printf("  --count        only print how many tokens there were\n");
+   printf("  --threads N    lex on up to N threads (0 = one per CPU)\n");
+   printf("  --list file    also lex every file named in file, one per line\n");
+   printf("  --columns      print line:column for each token (one file, one thread, not with --count)\n");
+   printf("  --max-errors N stop lexing after N errors (one file, one thread)\n");
+   printf("  --stats        print where lexing time went (one file, one thread, needs make STATS=1)\n");
+   printf("  --cache dir    reuse the tokens of a file lexed before, kept on disk in dir (one file, one thread)\n");
+   printf("  --save-tokens file  also write the tokens to a token file (one file, one thread)\n");
+   printf("  --load-tokens file  read the tokens from a token file instead of lexing (one file, one thread)\n");
+   printf("  --parse        print the syntax tree instead of the tokens (one file; parses on --threads)\n");
+   printf("  Only one of --stats, --cache, --save-tokens, --load-tokens, --parse and --columns/--max-errors\n");
+   printf("  can be given, and options marked one thread can't be used with --threads.\n");
+}
 
-int main(int argc, char *argv[])
+static void PrintToken(const Token_t *token)
+{
+   printf("%zu\t%s\t%.*s\n", token->line, tokenTypeNames[token->type], (int)token->length, token->lexeme);
+}
+
+static void PrintTokensWithColumns(I_List_t *tokens, const LineIndex_t *lineIndex, const char *source)
+{
+   Token_t *token;
+   size_t count = 0;
+   size_t line;
+   size_t column;
+
+   List_At(tokens, count, (void **)&token);
+   while(token != NULL)
+   {
+      LineIndex_Locate(lineIndex, token->lexeme - source, &line, &column);
+      printf("%zu:%zu\t%s\t%.*s\n", line, column, tokenTypeNames[token->type], (int)token->length, token->lexeme);
+
+      count++;
+      List_At(tokens, count, (void **)&token);
+   }
+
+   printf("%zu tokens\n", count);
+}
+
+static void PrintTokens(I_List_t *tokens, bool countOnly)
+{
+   Token_t *token;
+   size_t count = 0;
+
+   List_At(tokens, count, (void **)&token);
+   while(token != NULL)
+   {
+      if(!countOnly)
+      {
+         PrintToken(token);
+      }
+
+      count++;
+      List_At(tokens, count, (void **)&token);
+   }
+
+   printf("%zu tokens\n", count);
+}
+
+// One node per line, indented under its parent, with the text of leaves and operators
+static void PrintTree(const Parser_t *parser, uint32_t index, int indent)
+{
+   const Parser_Node_t *node = Parser_Node(parser, index);
+
+   printf("%*s%s", indent, "", Parser_KindName(node->kind));
+   if(node->token != PARSER_NONE && node->first == PARSER_NONE && node->kind != Parser_Node_Kind_Program)
+   {
+      printf("\t%.*s", (int)parser->tokens[node->token].length, parser->tokens[node->token].lexeme);
+   }
+   else if(node->kind == Parser_Node_Kind_Unary || node->kind == Parser_Node_Kind_Binary)
+   {
+      printf("\t%s", tokenTypeNames[node->op]);
+   }
+   printf("\n");
+
+   for(uint32_t child = node->first; child != PARSER_NONE; child = Parser_Node(parser, child)->next)
+   {
+      PrintTree(parser, child, indent + 2);
+   }
+}
+
+/*
+ * Add every line of a list file to paths.
+ *
+ * @return - buffer the new paths point into (free it once done with them),
+ *           or NULL if the list couldn't be read
+ */
+static char *ReadList(const char *listPath, const char ***paths, size_t *pathCount)
+{
+   SourceFile_t list;
+   char *names;
+
+   if(!SourceFile_Open(&list, listPath))
+   {
+      return NULL;
+   }
+
+   names = malloc(list.length + 1);
+   memcpy(names, list.data, list.length);
+   names[list.length] = '\0';
+   SourceFile_Close(&list);
+
+   for(char *name = strtok(names, "\r\n"); name != NULL; name = strtok(NULL, "\r\n"))
+   {
+      *paths = realloc(*paths, (*pathCount + 1) * sizeof(const char *));
+      (*paths)[(*pathCount)++] = name;
+   }
+
+   return names;
+}
+
+#ifdef PARSER_STATS
+static void PrintStats(const Lexer_StaticLookup_Stats_t *stats, const List_Calloc_Stats_t *listStats)
+{
+   uint64_t totalTicks = 0;
+
+   for(Lexer_StaticLookup_Action_t action = 0; action < Lexer_StaticLookup_Action_Count; action++)
+   {
+      totalTicks += stats->ticks[action];
+   }
+
+   fprintf(stderr, "%-26s %12s %12s %14s %10s %6s\n", "handler", "calls", "bytes", "ticks", "ticks/call", "time");
+   for(Lexer_StaticLookup_Action_t action = 0; action < Lexer_StaticLookup_Action_Count; action++)
+   {
+      if(stats->calls[action] > 0)
+      {
+         fprintf(stderr, "%-26s %12zu %12zu %14llu %10.1f %5.1f%%\n",
+            Lexer_StaticLookup_ActionName(action), stats->calls[action], stats->bytes[action],
+            (unsigned long long)stats->ticks[action], (double)stats->ticks[action] / stats->calls[action],
+            (totalTicks > 0) ? 100.0 * stats->ticks[action] / totalTicks : 0.0);
+      }
+   }
+   fprintf(stderr, "%-26s %12zu\n\n", "starved", stats->starves);
+
+   fprintf(stderr, "%-26s %12s\n", "token type", "count");
+   for(Token_Type_t type = 0; type < Token_Type_Count; type++)
+   {
+      if(stats->tokens[type] > 0)
+      {
+         fprintf(stderr, "%-26s %12zu\n", tokenTypeNames[type], stats->tokens[type]);
+      }
+   }
+
+   fprintf(stderr, "\ntoken list: %zu grows, %zu moves, %zu bytes moved, %zu bytes at most\n",
+      listStats->grows, listStats->moves, listStats->bytesMoved, listStats->peakBytes);
+}
+#endif
+
+/*
+ * Lex a file on one thread into a List_Calloc, counting what the lexer and the
+ * list do along the way.
+ */
+static int LexOneFileWithStats(const char *path, bool countOnly)
+{
+#ifdef PARSER_STATS
+   SourceFile_t file;
+   Error_Stderr_t errors;
+   List_Calloc_t tokens;
+   Lexer_StaticLookup_t lexer;
+   Lexer_StaticLookup_Stats_t stats = { 0 };
+
+   if(!SourceFile_Open(&file, path))
+   {
+      perror((path != NULL) ? path : "stdin");
+      return EXIT_FAILURE;
+   }
+
+   Error_Stderr_Init(&errors, path);
+   List_Calloc_Init(&tokens, sizeof(Token_t));
+   Lexer_StaticLookup_Init(&lexer, &errors.interface);
+   Lexer_StaticLookup_SetStats(&lexer, &stats);
+
+   Lexer_LexSpan(&lexer.interface, file.data, file.length, &tokens.interface);
+   PrintTokens(&tokens.interface, countOnly);
+   PrintStats(&stats, &tokens.stats);
+
+   Lexer_StaticLookup_Deinit(&lexer);
+   List_Calloc_Deinit(&tokens);
+   SourceFile_Close(&file);
+
+   return (errors.count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+#else
+   (void)path;
+   (void)countOnly;
+   fprintf(stderr, "--stats needs a build with the counters in it (make STATS=1)\n");
+   return EXIT_FAILURE;
+#endif
+}
+
+/*
+ * Lex a file on one thread through a Lexer_Cache kept in a directory, so lexing
+ * the same contents again only reads them back.
+ */
+static int LexOneFileCached(const char *path, bool countOnly, const char *directory)
+{
+   SourceFile_t file;
+   Error_Stderr_t errors;
+   List_Arena_t tokens;
+   Lexer_StaticLookup_t lexer;
+   Lexer_Cache_t cache;
+
+   if(!SourceFile_Open(&file, path))
+   {
+      perror((path != NULL) ? path : "stdin");
+      return EXIT_FAILURE;
+   }
+
+   Error_Stderr_Init(&errors, path);
+   List_Arena_Init(&tokens, sizeof(Token_t));
+   Lexer_StaticLookup_Init(&lexer, &cache.errors.interface);
+   // Only one source is lexed, so there is nothing to find in memory
+   Lexer_Cache_Init(&cache, &lexer.interface, &errors.interface, 0);
+   Lexer_Cache_SetDirectory(&cache, directory);
+
+   Lexer_LexSpan(&cache.interface, file.data, file.length, &tokens.interface);
+   PrintTokens(&tokens.interface, countOnly);
+   fprintf(stderr, "cache: %s\n", (cache.stats.diskHits > 0) ? "hit" : "miss");
+
+   Lexer_Cache_Deinit(&cache);
+   Lexer_StaticLookup_Deinit(&lexer);
+   List_Arena_Deinit(&tokens);
+   SourceFile_Close(&file);
+
+   return (errors.count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Print the tokens in a token file, or only count them if countOnly.
+ *
+ * @return - number of tokens read
+ */
+static size_t PrintTokenFile(const TokenFile_t *tokens, bool countOnly)
+{
+   TokenFile_Cursor_t cursor;
+   Token_t token;
+   size_t count = 0;
+
+   TokenFile_Begin(tokens, &cursor);
+   while(TokenFile_Next(tokens, &cursor, &token))
+   {
+      if(!countOnly)
+      {
+         PrintToken(&token);
+      }
+      count++;
+   }
+
+   return count;
+}
+
+/*
+ * Lex a file on one thread straight into a token file, for later stages to
+ * load instead of lexing. Unless countOnly, the tokens are printed as they
+ * read back from the saved file.
+ */
+static int SaveTokens(const char *path, bool countOnly, const char *tokenPath)
 {
-   if (argc > 2)
+   SourceFile_t file;
+   Error_Stderr_t errors;
+   TokenFile_Writer_t writer;
+   Lexer_StaticLookup_t lexer;
+   bool saved;
+
+   if(!SourceFile_Open(&file, path))
    {
-      printf("Expected 1 or 0 arguments.\n");
-      printf("Usage: %s [filename]\n", argv[0]);
+      perror((path != NULL) ? path : "stdin");
+      return EXIT_FAILURE;
    }
-   else if (argc == 2)
+
+   Error_Stderr_Init(&errors, path);
+   TokenFile_Writer_Init(&writer, file.data, file.length);
+   Lexer_StaticLookup_Init(&lexer, &errors.interface);
+
+   Lexer_LexSpan(&lexer.interface, file.data, file.length, &writer.interface);
+   saved = TokenFile_Writer_Save(&writer, tokenPath);
+   if(!saved)
    {
-      stream = fopen(argv[1], "r");
+      perror(tokenPath);
+   }
+   else if(!countOnly)
+   {
+      TokenFile_t tokens;
+
+      saved = TokenFile_Open(&tokens, tokenPath, file.data, file.length);
+      if(saved)
+      {
+         PrintTokenFile(&tokens, false);
+         TokenFile_Close(&tokens);
+      }
+      else
+      {
+         perror(tokenPath);
+      }
+   }
+   printf("%zu tokens\n", writer.count);
+
+   Lexer_StaticLookup_Deinit(&lexer);
+   TokenFile_Writer_Deinit(&writer);
+   SourceFile_Close(&file);
+
+   return (saved && errors.count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Print the tokens of a file from a token file written for it. Errors aren't
+ * kept in token files, so none are reported.
+ */
+static int LoadTokens(const char *path, bool countOnly, const char *tokenPath)
+{
+   SourceFile_t file;
+   TokenFile_t tokens;
+   size_t count;
+   bool complete;
+
+   if(!SourceFile_Open(&file, path))
+   {
+      perror((path != NULL) ? path : "stdin");
+      return EXIT_FAILURE;
+   }
+
+   if(!TokenFile_Open(&tokens, tokenPath, file.data, file.length))
+   {
+      perror(tokenPath);
+      SourceFile_Close(&file);
+      return EXIT_FAILURE;
+   }
+
+   count = PrintTokenFile(&tokens, countOnly);
+   complete = (count == TokenFile_Count(&tokens));
+   printf("%zu tokens\n", count);
+
+   TokenFile_Close(&tokens);
+   SourceFile_Close(&file);
+
+   return complete ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Lex a file into one array of tokens and parse it, on up to threadCount
+ * threads if parallel.
+ */
+static int ParseOneFile(const char *path, bool countOnly, bool parallel, size_t threadCount)
+{
+   SourceFile_t file;
+   Error_Stderr_t errors;
+   TokenList_t tokens;
+   Lexer_StaticLookup_t lexer;
+   Parser_Parallel_t parser;
+   uint32_t root;
+
+   if(!SourceFile_Open(&file, path))
+   {
+      perror((path != NULL) ? path : "stdin");
+      return EXIT_FAILURE;
+   }
+
+   Error_Stderr_Init(&errors, path);
+   TokenList_Init(&tokens);
+   Lexer_StaticLookup_Init(&lexer, &errors.interface);
+   Parser_Parallel_Init(&parser, &errors.interface, parallel ? threadCount : 1);
+
+   Lexer_LexSpan(&lexer.interface, file.data, file.length, &tokens.interface);
+   root = Parser_Parallel_Parse(&parser, tokens.tokens, tokens.count);
+   if(!countOnly)
+   {
+      PrintTree(&parser.parser, root, 0);
+   }
+   printf("%zu nodes\n", parser.parser.nodeCount);
+
+   Parser_Parallel_Deinit(&parser);
+   Lexer_StaticLookup_Deinit(&lexer);
+   TokenList_Deinit(&tokens);
+   SourceFile_Close(&file);
+
+   return (errors.count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int LexOneFile(const char *path, bool countOnly, bool parallel, size_t threadCount, bool columns, size_t maxErrors)
+{
+   SourceFile_t file;
+   Error_Stderr_t errors;
+   TokenList_t tokens;
+   Lexer_StaticLookup_t lexer;
+   Lexer_Parallel_t parallelLexer;
+   I_Lexer_t *chosenLexer;
+   LineIndex_t lineIndex;
+   Diagnostics_t diagnostics;
+
+   if(!SourceFile_Open(&file, path))
+   {
+      perror((path != NULL) ? path : "stdin");
+      return EXIT_FAILURE;
+   }
+
+   Error_Stderr_Init(&errors, path);
+   TokenList_Init(&tokens);
+   Lexer_StaticLookup_Init(&lexer, &errors.interface);
+   Lexer_Parallel_Init(&parallelLexer, &errors.interface, threadCount);
+   chosenLexer = parallel ? &parallelLexer.interface : &lexer.interface;
+
+   LineIndex_Init(&lineIndex);
+   if(columns && !countOnly)
+   {
+      Lexer_StaticLookup_SetLineIndex(&lexer, &lineIndex);
+      chosenLexer = &lexer.interface;
+   }
+
+   Diagnostics_Init(&diagnostics, maxErrors, maxErrors);
+   if(maxErrors > 0)
+   {
+      Lexer_StaticLookup_SetDiagnostics(&lexer, &diagnostics);
+      chosenLexer = &lexer.interface;
+   }
+
+   // Tokens point into the file's contents, so it stays open until they're printed
+   Lexer_LexSpan(chosenLexer, file.data, file.length, &tokens.interface);
+   if(columns && !countOnly)
+   {
+      PrintTokensWithColumns(&tokens.interface, &lineIndex, file.data);
    }
    else
    {
-      stream = stdin;
+      PrintTokens(&tokens.interface, countOnly);
    }
 
-   while(fgets(buf, BUF_SIZE, stream))
+   Diagnostics_Replay(&diagnostics, file.data, &errors.interface);
+   if(Lexer_StaticLookup_Halted(&lexer))
    {
-      printf("> %s", buf);
-      if(stream == stdin)
+      fprintf(stderr, "stopped after %zu errors\n", diagnostics.total);
+   }
+
+   Diagnostics_Deinit(&diagnostics);
+   LineIndex_Deinit(&lineIndex);
+   Lexer_StaticLookup_Deinit(&lexer);
+   TokenList_Deinit(&tokens);
+   SourceFile_Close(&file);
+
+   return (errors.count == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+static int LexManyFiles(const char * const *paths, size_t pathCount, bool countOnly, size_t threadCount)
+{
+   Lexer_Batch_t batch;
+   bool failed = false;
+
+   Lexer_Batch_Init(&batch, paths, pathCount, threadCount);
+   Lexer_Batch_Run(&batch);
+
+   for(size_t i = 0; i < pathCount; i++)
+   {
+      Error_Stderr_t errors;
+      const Token_t *tokens;
+      size_t count;
+
+      printf("==> %s <==\n", paths[i]);
+      if(Lexer_Batch_OpenError(&batch, i) != 0)
       {
-         fflush(stdout);
+         fprintf(stderr, "%s: %s\n", paths[i], strerror(Lexer_Batch_OpenError(&batch, i)));
+         failed = true;
+         continue;
       }
 
-      // Lex the buffer and return the list of tokens
-      // Print the list of tokens
+      tokens = Lexer_Batch_Tokens(&batch, i, &count);
+      for(size_t t = 0; t < count && !countOnly; t++)
+      {
+         PrintToken(&tokens[t]);
+      }
+      printf("%zu tokens\n", count);
+
+      Error_Stderr_Init(&errors, paths[i]);
+      failed = (Lexer_Batch_ReportErrors(&batch, i, &errors.interface) > 0) || failed;
    }
 
-   if(stream != stdin)
+   Lexer_Batch_Deinit(&batch);
+   return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+   const char **paths = NULL;
+   size_t pathCount = 0;
+   char *listNames = NULL;
+   bool countOnly = false;
+   bool parallel = false;
+   bool batch = false;
+   bool columns = false;
+   bool stats = false;
+   const char *cacheDirectory = NULL;
+   const char *saveTokens = NULL;
+   const char *loadTokens = NULL;
+   bool parse = false;
+   size_t threadCount = 0;
+   size_t maxErrors = 0;
+   size_t modeCount;
+   bool oneThreadOnly;
+   int result;
+
+   for(int i = 1; i < argc; i++)
    {
-      fclose(stream);
+      if(strcmp(argv[i], "--count") == 0)
+      {
+         countOnly = true;
+      }
+      else if(strcmp(argv[i], "--columns") == 0)
+      {
+         columns = true;
+      }
+      else if(strcmp(argv[i], "--parse") == 0)
+      {
+         parse = true;
+      }
+      else if(strcmp(argv[i], "--stats") == 0)
+      {
+         stats = true;
+      }
+      else if(strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+      {
+         parallel = true;
+         threadCount = strtoul(argv[++i], NULL, 10);
+      }
+      else if(strcmp(argv[i], "--max-errors") == 0 && i + 1 < argc)
+      {
+         maxErrors = strtoul(argv[++i], NULL, 10);
+      }
+      else if(strcmp(argv[i], "--cache") == 0 && i + 1 < argc)
+      {
+         cacheDirectory = argv[++i];
+      }
+      else if(strcmp(argv[i], "--save-tokens") == 0 && i + 1 < argc)
+      {
+         saveTokens = argv[++i];
+      }
+      else if(strcmp(argv[i], "--load-tokens") == 0 && i + 1 < argc)
+      {
+         loadTokens = argv[++i];
+      }
+      else if(strcmp(argv[i], "--list") == 0 && i + 1 < argc && listNames == NULL)
+      {
+         batch = true;
+         listNames = ReadList(argv[++i], &paths, &pathCount);
+         if(listNames == NULL)
+         {
+            perror(argv[i]);
+            free(paths);
+            return EXIT_FAILURE;
+         }
+      }
+      else if(strncmp(argv[i], "--", 2) != 0)
+      {
+         paths = realloc(paths, (pathCount + 1) * sizeof(const char *));
+         paths[pathCount++] = argv[i];
+      }
+      else
+      {
+         PrintUsage(argv[0]);
+         free(listNames);
+         free(paths);
+         return EXIT_FAILURE;
+      }
+   }
+
+   // Each of these picks how a single file is lexed, so only one can be given
+   modeCount = stats + parse + (cacheDirectory != NULL) + (saveTokens != NULL) + (loadTokens != NULL) + (columns || maxErrors > 0);
+   oneThreadOnly = stats || cacheDirectory != NULL || saveTokens != NULL || loadTokens != NULL || columns || maxErrors > 0;
+   if(modeCount > 1 || (modeCount > 0 && (batch || pathCount > 1)) || (parallel && oneThreadOnly) || (columns && countOnly))
+   {
+      PrintUsage(argv[0]);
+      free(listNames);
+      free(paths);
+      return EXIT_FAILURE;
+   }
+
+   if(batch || pathCount > 1)
+   {
+      result = LexManyFiles(paths, pathCount, countOnly, threadCount);
+   }
+   else if(stats)
+   {
+      result = LexOneFileWithStats((pathCount == 1) ? paths[0] : NULL, countOnly);
    }
+   else if(parse)
+   {
+      result = ParseOneFile((pathCount == 1) ? paths[0] : NULL, countOnly, parallel, threadCount);
+   }
+   else if(saveTokens != NULL)
+   {
+      result = SaveTokens((pathCount == 1) ? paths[0] : NULL, countOnly, saveTokens);
+   }
+   else if(loadTokens != NULL)
+   {
+      result = LoadTokens((pathCount == 1) ? paths[0] : NULL, countOnly, loadTokens);
+   }
+   else if(cacheDirectory != NULL)
+   {
+      result = LexOneFileCached((pathCount == 1) ? paths[0] : NULL, countOnly, cacheDirectory);
+   }
+   else
+   {
+      result = LexOneFile((pathCount == 1) ? paths[0] : NULL, countOnly, parallel, threadCount, columns, maxErrors);
+   }
+
+   free(listNames);
+   free(paths);
+   return result;
 }
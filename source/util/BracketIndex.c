@@ -0,0 +1,105 @@
+/***
+ * File: BracketIndex.c
+ */
+#include <stdlib.h>
+#include "BracketIndex.h"
+
+static size_t TypeSlot(Token_Type_t type)
+{
+   switch(type)
+   {
+      case Token_Type_Paren_Left: return 0;
+      case Token_Type_SquareBrace_Left: return 1;
+      default: return 2;
+   }
+}
+
+void BracketIndex_Init(BracketIndex_t *instance)
+{
+   instance->entries = NULL;
+   instance->count = 0;
+   instance->allocatedCount = 0;
+   instance->stack = NULL;
+   instance->stackCount = 0;
+   instance->allocatedStackCount = 0;
+   BracketIndex_Clear(instance);
+}
+
+void BracketIndex_Deinit(BracketIndex_t *instance)
+{
+   free(instance->entries);
+   free(instance->stack);
+}
+
+void BracketIndex_Clear(BracketIndex_t *instance)
+{
+   instance->count = 0;
+   instance->stackCount = 0;
+   for(size_t i = 0; i < 3; i++)
+   {
+      instance->openOfType[i] = 0;
+   }
+}
+
+void BracketIndex_Open(BracketIndex_t *instance, uint32_t token, Token_Type_t type, size_t offset, size_t line)
+{
+   if(instance->count == instance->allocatedCount)
+   {
+      instance->allocatedCount = (instance->allocatedCount + 1) * 3 / 2;
+      instance->entries = realloc(instance->entries, instance->allocatedCount * sizeof(BracketIndex_Entry_t));
+   }
+   if(instance->stackCount == instance->allocatedStackCount)
+   {
+      instance->allocatedStackCount = (instance->allocatedStackCount + 1) * 3 / 2;
+      instance->stack = realloc(instance->stack, instance->allocatedStackCount * sizeof(BracketIndex_Pending_t));
+   }
+
+   instance->entries[instance->count] = (BracketIndex_Entry_t){ token, BRACKETINDEX_NONE, (uint32_t)instance->stackCount };
+   instance->stack[instance->stackCount++] = (BracketIndex_Pending_t){ (uint32_t)instance->count, type, offset, line };
+   instance->openOfType[TypeSlot(type)]++;
+   instance->count++;
+}
+
+bool BracketIndex_IsOpen(const BracketIndex_t *instance, Token_Type_t type)
+{
+   return instance->openOfType[TypeSlot(type)] > 0;
+}
+
+const BracketIndex_Pending_t *BracketIndex_Top(const BracketIndex_t *instance)
+{
+   return (instance->stackCount > 0) ? &instance->stack[instance->stackCount - 1] : NULL;
+}
+
+void BracketIndex_Close(BracketIndex_t *instance, uint32_t token)
+{
+   instance->entries[instance->stack[instance->stackCount - 1].entry].close = token;
+   BracketIndex_Abandon(instance);
+}
+
+void BracketIndex_Abandon(BracketIndex_t *instance)
+{
+   instance->stackCount--;
+   instance->openOfType[TypeSlot(instance->stack[instance->stackCount].type)]--;
+}
+
+const BracketIndex_Entry_t *BracketIndex_Find(const BracketIndex_t *instance, uint32_t token)
+{
+   size_t low = 0;
+   size_t high = instance->count;
+
+   while(low < high)
+   {
+      size_t middle = low + (high - low) / 2;
+
+      if(instance->entries[middle].open < token)
+      {
+         low = middle + 1;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   return (low < instance->count && instance->entries[low].open == token) ? &instance->entries[low] : NULL;
+}
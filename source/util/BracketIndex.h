@@ -0,0 +1,105 @@
+/***
+ * File: BracketIndex.h
+ * Desc: Where each opening bracket of a source is closed, and how deeply it is
+ *       nested, by token index. Filled while lexing with a stack of the
+ *       brackets still open, so a parser can jump from a '{' straight past its
+ *       '}' without looking at anything in between.
+ *
+ *       Entries are kept in the order of their openers. Something walking the
+ *       tokens in order can keep a cursor into them and find the entry of each
+ *       opener it reaches in O(1); BracketIndex_Find looks one up from anywhere.
+ */
+
+#ifndef _BRACKETINDEX_H
+#define _BRACKETINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdbool.h>
+#include "Token.h"
+
+#define BRACKETINDEX_NONE (UINT32_MAX)   // No token, e.g. the closer of a bracket that was never closed
+
+typedef struct
+{
+   uint32_t open;          // Token index of the opener
+   uint32_t close;         // Token index of its closer, or BRACKETINDEX_NONE
+   uint32_t depth;         // Brackets around it, 0 at the top level
+} BracketIndex_Entry_t;
+
+// A bracket that hasn't been closed yet
+typedef struct
+{
+   uint32_t entry;         // Index into entries
+   Token_Type_t type;      // Of the opener
+   size_t offset;          // Of the opener from the start of the source
+   size_t line;
+} BracketIndex_Pending_t;
+
+typedef struct
+{
+   BracketIndex_Entry_t *entries;
+   size_t count;
+   size_t allocatedCount;
+
+   BracketIndex_Pending_t *stack;
+   size_t stackCount;
+   size_t allocatedStackCount;
+   size_t openOfType[3];   // Pending brackets of each type, so closers can tell if any will match
+} BracketIndex_t;
+
+/*
+ * Initialize an empty BracketIndex.
+ */
+void BracketIndex_Init(BracketIndex_t *instance);
+
+/*
+ * Deinitialize a BracketIndex.
+ */
+void BracketIndex_Deinit(BracketIndex_t *instance);
+
+/*
+ * Forget every entry and pending bracket, keeping the memory for the next source.
+ */
+void BracketIndex_Clear(BracketIndex_t *instance);
+
+/*
+ * Add an entry for an opener, and push it onto the pending brackets.
+ *
+ * @param token - index of the opener, greater than that of any opener before it
+ * @param type - Token_Type_Paren_Left, Token_Type_SquareBrace_Left or Token_Type_CurlyBrace_Left
+ */
+void BracketIndex_Open(BracketIndex_t *instance, uint32_t token, Token_Type_t type, size_t offset, size_t line);
+
+/*
+ * Whether any pending bracket has this opener type.
+ */
+bool BracketIndex_IsOpen(const BracketIndex_t *instance, Token_Type_t type);
+
+/*
+ * The innermost pending bracket, or NULL if there are none.
+ */
+const BracketIndex_Pending_t *BracketIndex_Top(const BracketIndex_t *instance);
+
+/*
+ * Close the innermost pending bracket.
+ *
+ * @pre - there is a pending bracket
+ */
+void BracketIndex_Close(BracketIndex_t *instance, uint32_t token);
+
+/*
+ * Give up on the innermost pending bracket, leaving its entry without a closer.
+ *
+ * @pre - there is a pending bracket
+ */
+void BracketIndex_Abandon(BracketIndex_t *instance);
+
+/*
+ * Find the entry of an opener.
+ *
+ * @return - NULL if the token isn't an opener in the index
+ */
+const BracketIndex_Entry_t *BracketIndex_Find(const BracketIndex_t *instance, uint32_t token);
+
+#endif
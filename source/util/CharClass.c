@@ -0,0 +1,41 @@
+/***
+ * File: CharClass.c
+ *
+ * Each entry of the table is the same constant expression of its own index, so
+ * the rules below are the only place they're written down. Bytes 128-255 are
+ * in no class.
+ */
+
+#include "CharClass.h"
+
+#define IN_RANGE(c, first, last) ((c) >= (first) && (c) <= (last))
+
+#define IS_LETTER(c)     (IN_RANGE(c, 'a', 'z') || IN_RANGE(c, 'A', 'Z'))
+#define IS_DIGIT(c)      IN_RANGE(c, '0', '9')
+#define IS_IDENTIFIER(c) (IS_LETTER(c) || (c) == '_' || (c) == '-' || (c) == '#' || (c) == '!' || (c) == '?')
+#define IS_WORD(c)       (IS_LETTER(c) || (c) == '?')
+#define IS_SPACE(c)      ((c) == ' ' || IN_RANGE(c, '\t', '\r'))
+#define IS_CONTROL(c)    (IN_RANGE(c, 0, 31) || (c) == 127)
+
+// Identifiers, numbers and strings, and the symbols that can't touch them
+#define IS_TOUCHY(c) \
+   (IS_IDENTIFIER(c) || IS_DIGIT(c) || (c) == '"' || (c) == '@' || (c) == '$' || (c) == '+' \
+    || (c) == '/' || (c) == '*' || (c) == '=' || (c) == '<' || (c) == '>' || (c) == '~')
+
+#define CLASSES_OF(c) (CharClass_t)( \
+     (IS_LETTER(c)     ? CharClass_Letter     : 0) \
+   | (IS_DIGIT(c)      ? CharClass_Digit      : 0) \
+   | (IS_IDENTIFIER(c) ? CharClass_Identifier : 0) \
+   | (IS_WORD(c)       ? CharClass_Word       : 0) \
+   | (IS_SPACE(c)      ? CharClass_Space      : 0) \
+   | (IS_CONTROL(c)    ? CharClass_Control    : 0) \
+   | (IS_TOUCHY(c)     ? CharClass_Touchy     : 0))
+
+#define ROW_4(c)   CLASSES_OF(c), CLASSES_OF((c) + 1), CLASSES_OF((c) + 2), CLASSES_OF((c) + 3)
+#define ROW_16(c)  ROW_4(c), ROW_4((c) + 4), ROW_4((c) + 8), ROW_4((c) + 12)
+#define ROW_64(c)  ROW_16(c), ROW_16((c) + 16), ROW_16((c) + 32), ROW_16((c) + 48)
+
+const CharClass_t charClassTable[256] =
+{
+   ROW_64(0), ROW_64(64)
+};
@@ -0,0 +1,36 @@
+/***
+ * File: CharClass.h
+ * Desc: What each byte can be in the language, as a table of bit flags.
+ *       The rules come from documentation/Lexer-Syntax.md and don't depend on
+ *       the C locale, unlike <ctype.h>.
+ */
+
+#ifndef _CHARCLASS_H
+#define _CHARCLASS_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+enum
+{
+   CharClass_Letter     = 1 << 0,   // [a-zA-Z]
+   CharClass_Digit      = 1 << 1,   // [0-9]
+   CharClass_Identifier = 1 << 2,   // Can be part of an identifier: [a-zA-Z_#!?-]
+   CharClass_Word       = 1 << 3,   // An identifier needs at least one of these: [a-zA-Z?]
+   CharClass_Space      = 1 << 4,   // Same as isspace() in the C locale
+   CharClass_Control    = 1 << 5,   // Same as iscntrl() in the C locale
+   CharClass_Touchy     = 1 << 6    // Symbols next to it need a space between
+};
+typedef uint8_t CharClass_t;
+
+extern const CharClass_t charClassTable[256];
+
+/*
+ * Whether c is in any of the classes.
+ */
+static inline bool CharClass_Is(char c, CharClass_t classes)
+{
+   return (charClassTable[(uint8_t)c] & classes) != 0;
+}
+
+#endif
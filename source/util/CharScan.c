@@ -0,0 +1,335 @@
+/***
+ * File: CharScan.c
+ *
+ * The vector scanners load a block at a time from the start of the run for as
+ * long as a whole block lies before end, and leave what's left to the scalar
+ * scanners, so nothing outside [source, end) is ever read.
+ */
+
+#include <stdint.h>
+#include "CharScan.h"
+#include "CharClass.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#define CHARSCAN_X86
+#include <immintrin.h>
+#endif
+
+enum
+{
+   Run_Identifier,
+   Run_Digits,
+   Run_StringBody
+};
+typedef int Run_t;
+
+/*********************************
+ * Scalar fallback
+ *********************************/
+static size_t Identifier_Scalar(const char *source, const char *end, bool *hasWordCharacter)
+{
+   const char *current = source;
+
+   while(current < end && CharClass_Is(*current, CharClass_Identifier))
+   {
+      if(CharClass_Is(*current, CharClass_Word))
+      {
+         *hasWordCharacter = true;
+      }
+      current++;
+   }
+
+   return current - source;
+}
+
+static size_t Digits_Scalar(const char *source, const char *end)
+{
+   const char *current = source;
+
+   while(current < end && CharClass_Is(*current, CharClass_Digit))
+   {
+      current++;
+   }
+
+   return current - source;
+}
+
+static size_t StringBody_Scalar(const char *source, const char *end)
+{
+   const char *current = source;
+
+   while(current < end && *current != '"' && *current != '\n')
+   {
+      current++;
+   }
+
+   return current - source;
+}
+
+/*
+ * Finish a run the vector scanners have less than a block of left.
+ */
+static size_t Run_Scalar(const char *source, const char *end, Run_t run, bool *hasWordCharacter)
+{
+   if(run == Run_Identifier)
+   {
+      return Identifier_Scalar(source, end, hasWordCharacter);
+   }
+   else if(run == Run_Digits)
+   {
+      return Digits_Scalar(source, end);
+   }
+
+   return StringBody_Scalar(source, end);
+}
+
+#ifdef CHARSCAN_X86
+/*********************************
+ * SSE2 (16 bytes at a time)
+ *********************************/
+static inline __m128i InRange_Sse2(__m128i bytes, char first, char count)
+{
+   // Shift the range down to start at -128 so one signed compare checks both ends
+   __m128i shifted = _mm_add_epi8(bytes, _mm_set1_epi8((char)(-128 - first)));
+   return _mm_cmplt_epi8(shifted, _mm_set1_epi8((char)(-128 + count)));
+}
+
+/*
+ * Bit i is set if byte i of the block ends the run. Word characters go in *word.
+ */
+static inline __attribute__((always_inline)) uint32_t Stops_Sse2(const char *block, Run_t run, uint32_t *word)
+{
+   __m128i bytes = _mm_loadu_si128((const __m128i *)block);
+   __m128i continues;
+
+   if(run == Run_Identifier)
+   {
+      __m128i alpha = InRange_Sse2(_mm_or_si128(bytes, _mm_set1_epi8(0x20)), 'a', 26);
+      __m128i question = _mm_cmpeq_epi8(bytes, _mm_set1_epi8('?'));
+      __m128i punctuation = _mm_or_si128(
+         _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('_')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('-'))),
+         _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('#')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('!'))));
+
+      *word = (uint32_t)_mm_movemask_epi8(_mm_or_si128(alpha, question));
+      continues = _mm_or_si128(_mm_or_si128(alpha, question), punctuation);
+   }
+   else if(run == Run_Digits)
+   {
+      continues = InRange_Sse2(bytes, '0', 10);
+   }
+   else
+   {
+      __m128i stops = _mm_or_si128(_mm_cmpeq_epi8(bytes, _mm_set1_epi8('"')), _mm_cmpeq_epi8(bytes, _mm_set1_epi8('\n')));
+
+      return (uint32_t)_mm_movemask_epi8(stops);
+   }
+
+   return ~(uint32_t)_mm_movemask_epi8(continues) & 0xFFFF;
+}
+
+static inline __attribute__((always_inline)) size_t Run_Sse2(const char *source, const char *end, Run_t run, bool *hasWordCharacter)
+{
+   const char *block = source;
+   uint32_t word = 0;
+   uint32_t stops;
+
+   while(end - block >= 16)
+   {
+      stops = Stops_Sse2(block, run, &word);
+      if(stops != 0)
+      {
+         // Word characters only count if they come before the stop
+         *hasWordCharacter = *hasWordCharacter || ((word & ((stops & -stops) - 1)) != 0);
+         return block + __builtin_ctz(stops) - source;
+      }
+
+      *hasWordCharacter = *hasWordCharacter || (word != 0);
+      block += 16;
+   }
+
+   return block - source + Run_Scalar(block, end, run, hasWordCharacter);
+}
+
+static size_t Identifier_Sse2(const char *source, const char *end, bool *hasWordCharacter)
+{
+   return Run_Sse2(source, end, Run_Identifier, hasWordCharacter);
+}
+
+static size_t Digits_Sse2(const char *source, const char *end)
+{
+   bool unused = false;
+   return Run_Sse2(source, end, Run_Digits, &unused);
+}
+
+static size_t StringBody_Sse2(const char *source, const char *end)
+{
+   bool unused = false;
+   return Run_Sse2(source, end, Run_StringBody, &unused);
+}
+
+/*********************************
+ * AVX2 (32 bytes at a time)
+ *********************************/
+__attribute__((target("avx2")))
+static inline __m256i InRange_Avx2(__m256i bytes, char first, char count)
+{
+   __m256i shifted = _mm256_add_epi8(bytes, _mm256_set1_epi8((char)(-128 - first)));
+   return _mm256_cmpgt_epi8(_mm256_set1_epi8((char)(-128 + count)), shifted);
+}
+
+__attribute__((target("avx2")))
+static inline __attribute__((always_inline)) uint32_t Stops_Avx2(const char *block, Run_t run, uint32_t *word)
+{
+   __m256i bytes = _mm256_loadu_si256((const __m256i *)block);
+   __m256i continues;
+
+   if(run == Run_Identifier)
+   {
+      __m256i alpha = InRange_Avx2(_mm256_or_si256(bytes, _mm256_set1_epi8(0x20)), 'a', 26);
+      __m256i question = _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('?'));
+      __m256i punctuation = _mm256_or_si256(
+         _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('_')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('-'))),
+         _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('#')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('!'))));
+
+      *word = (uint32_t)_mm256_movemask_epi8(_mm256_or_si256(alpha, question));
+      continues = _mm256_or_si256(_mm256_or_si256(alpha, question), punctuation);
+   }
+   else if(run == Run_Digits)
+   {
+      continues = InRange_Avx2(bytes, '0', 10);
+   }
+   else
+   {
+      __m256i stops = _mm256_or_si256(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('"')), _mm256_cmpeq_epi8(bytes, _mm256_set1_epi8('\n')));
+
+      return (uint32_t)_mm256_movemask_epi8(stops);
+   }
+
+   return ~(uint32_t)_mm256_movemask_epi8(continues);
+}
+
+__attribute__((target("avx2")))
+static inline __attribute__((always_inline)) size_t Run_Avx2(const char *source, const char *end, Run_t run, bool *hasWordCharacter)
+{
+   const char *block = source;
+   uint32_t word = 0;
+   uint32_t stops;
+
+   while(end - block >= 32)
+   {
+      stops = Stops_Avx2(block, run, &word);
+      if(stops != 0)
+      {
+         *hasWordCharacter = *hasWordCharacter || ((word & ((stops & -stops) - 1)) != 0);
+         return block + __builtin_ctz(stops) - source;
+      }
+
+      *hasWordCharacter = *hasWordCharacter || (word != 0);
+      block += 32;
+   }
+
+   return block - source + Run_Scalar(block, end, run, hasWordCharacter);
+}
+
+__attribute__((target("avx2")))
+static size_t Identifier_Avx2(const char *source, const char *end, bool *hasWordCharacter)
+{
+   return Run_Avx2(source, end, Run_Identifier, hasWordCharacter);
+}
+
+__attribute__((target("avx2")))
+static size_t Digits_Avx2(const char *source, const char *end)
+{
+   bool unused = false;
+   return Run_Avx2(source, end, Run_Digits, &unused);
+}
+
+__attribute__((target("avx2")))
+static size_t StringBody_Avx2(const char *source, const char *end)
+{
+   bool unused = false;
+   return Run_Avx2(source, end, Run_StringBody, &unused);
+}
+#endif
+
+/*********************************
+ * Runtime selection
+ *********************************/
+// Scalar until SelectBest runs, which is before main
+static size_t (*identifier)(const char *source, const char *end, bool *hasWordCharacter) = Identifier_Scalar;
+static size_t (*digits)(const char *source, const char *end) = Digits_Scalar;
+static size_t (*stringBody)(const char *source, const char *end) = StringBody_Scalar;
+
+static CharScan_Level_t BestLevel(void)
+{
+#ifdef CHARSCAN_X86
+   __builtin_cpu_init();
+   if(__builtin_cpu_supports("avx2"))
+   {
+      return CharScan_Level_Avx2;
+   }
+   return CharScan_Level_Sse2;
+#else
+   return CharScan_Level_Scalar;
+#endif
+}
+
+bool CharScan_Select(CharScan_Level_t level)
+{
+   if(level > BestLevel())
+   {
+      return false;
+   }
+
+   switch(level)
+   {
+#ifdef CHARSCAN_X86
+      case CharScan_Level_Avx2:
+         identifier = Identifier_Avx2;
+         digits = Digits_Avx2;
+         stringBody = StringBody_Avx2;
+         break;
+
+      case CharScan_Level_Sse2:
+         identifier = Identifier_Sse2;
+         digits = Digits_Sse2;
+         stringBody = StringBody_Sse2;
+         break;
+#endif
+
+      default:
+         identifier = Identifier_Scalar;
+         digits = Digits_Scalar;
+         stringBody = StringBody_Scalar;
+         break;
+   }
+
+   return true;
+}
+
+#ifdef CHARSCAN_X86
+/*
+ * Pick the best scanners while the program is still on one thread, so the
+ * lexers running on several threads only ever read the pointers.
+ */
+__attribute__((constructor))
+static void SelectBest(void)
+{
+   CharScan_Select(BestLevel());
+}
+#endif
+
+size_t CharScan_Identifier(const char *source, const char *end, bool *hasWordCharacter)
+{
+   return identifier(source, end, hasWordCharacter);
+}
+
+size_t CharScan_Digits(const char *source, const char *end)
+{
+   return digits(source, end);
+}
+
+size_t CharScan_StringBody(const char *source, const char *end)
+{
+   return stringBody(source, end);
+}
@@ -0,0 +1,58 @@
+/***
+ * File: CharScan.h
+ * Desc: Finds the end of a run of one class of characters, 16 or 32 bytes at a time
+ *       when the CPU supports SSE2/AVX2, and one character at a time otherwise.
+ */
+
+#ifndef _CHARSCAN_H
+#define _CHARSCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+enum
+{
+   CharScan_Level_Scalar = 0,
+   CharScan_Level_Sse2,
+   CharScan_Level_Avx2
+};
+typedef int CharScan_Level_t;
+
+/*
+ * Force the scanners to use a specific implementation instead of the best one
+ * the CPU supports, which is selected before main. Not thread-safe: call it
+ * while nothing is lexing.
+ *
+ * @return - false if the CPU can't run that implementation (nothing changes)
+ */
+bool CharScan_Select(CharScan_Level_t level);
+
+/*
+ * Length of the run of identifier characters [a-zA-Z_-#!?] at the start of source.
+ *
+ * @param source - characters to scan
+ * @param end - one past the last character that may be part of the run
+ * @param hasWordCharacter - set true if the run contains any of [a-zA-Z?],
+ *                           left untouched otherwise
+ */
+size_t CharScan_Identifier(const char *source, const char *end, bool *hasWordCharacter);
+
+/*
+ * Length of the run of digits [0-9] at the start of source.
+ *
+ * @param source - characters to scan
+ * @param end - one past the last character that may be part of the run
+ */
+size_t CharScan_Digits(const char *source, const char *end);
+
+/*
+ * Length of the run of characters that can continue a string literal, i.e.
+ * everything up to the first '"' or '\n'. A null character doesn't stop it;
+ * end is what bounds the run.
+ *
+ * @param source - characters to scan
+ * @param end - one past the last character that may be part of the run
+ */
+size_t CharScan_StringBody(const char *source, const char *end);
+
+#endif
@@ -0,0 +1,145 @@
+/***
+ * File: Diagnostics.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include "Diagnostics.h"
+
+void Diagnostics_Init(Diagnostics_t *instance, size_t capacity, size_t maxErrors)
+{
+   instance->capacity = (capacity > 0) ? capacity : 1;
+   instance->records = malloc(instance->capacity * sizeof(Diagnostic_t));
+   instance->maxErrors = maxErrors;
+   Diagnostics_Clear(instance);
+}
+
+void Diagnostics_Deinit(Diagnostics_t *instance)
+{
+   free(instance->records);
+   instance->records = NULL;
+   instance->capacity = 0;
+}
+
+void Diagnostics_Clear(Diagnostics_t *instance)
+{
+   instance->first = 0;
+   instance->count = 0;
+   instance->total = 0;
+}
+
+bool Diagnostics_Add(Diagnostics_t *instance, const Diagnostic_t *diagnostic)
+{
+   size_t index = instance->first + instance->count;
+
+   if(index >= instance->capacity)
+   {
+      index -= instance->capacity;
+   }
+
+   instance->records[index] = *diagnostic;
+   instance->total++;
+
+   if(instance->count < instance->capacity)
+   {
+      instance->count++;
+   }
+   else
+   {
+      instance->first = (instance->first + 1 == instance->capacity) ? 0 : instance->first + 1;
+   }
+
+   return instance->maxErrors == 0 || instance->total < instance->maxErrors;
+}
+
+const Diagnostic_t *Diagnostics_At(const Diagnostics_t *instance, size_t index)
+{
+   return &instance->records[(instance->first + index) % instance->capacity];
+}
+
+size_t Diagnostics_Dropped(const Diagnostics_t *instance)
+{
+   return instance->total - instance->count;
+}
+
+void Diagnostics_Replay(const Diagnostics_t *instance, const char *source, I_Error_t *target)
+{
+   for(size_t i = 0; i < instance->count; i++)
+   {
+      const Diagnostic_t *diagnostic = Diagnostics_At(instance, i);
+      Diagnostic_Report(diagnostic, source, target, diagnostic->line);
+   }
+}
+
+void Diagnostic_Report(const Diagnostic_t *diagnostic, const char *source, I_Error_t *target, size_t line)
+{
+   char message[DIAGNOSTIC_MESSAGE_SIZE];
+   size_t length = Diagnostic_Format(diagnostic, source, message, sizeof(message));
+
+   if(length < sizeof(message))
+   {
+      Error_Report(target, line, message);
+   }
+   else
+   {
+      // Only messages quoting a long lexeme get here
+      char *longMessage = malloc(length + 1);
+
+      Diagnostic_Format(diagnostic, source, longMessage, length + 1);
+      Error_Report(target, line, longMessage);
+      free(longMessage);
+   }
+}
+
+size_t Diagnostic_Format(const Diagnostic_t *diagnostic, const char *source, char *buffer, size_t size)
+{
+   const char *lexeme = source + diagnostic->offset;
+   int length = (int)diagnostic->length;
+   const char *extra = diagnostic->extra;
+
+   switch(diagnostic->code)
+   {
+      case Diagnostic_Code_UnexpectedCharacter:
+         return snprintf(buffer, size, "Unexpected character '%c'", extra[0]);
+
+      case Diagnostic_Code_NonPrintableCharacter:
+         return snprintf(buffer, size, "Unexpected non-printable character");
+
+      case Diagnostic_Code_NonAsciiCharacter:
+         return snprintf(buffer, size, "Unexpected non-ascii character");
+
+      case Diagnostic_Code_IdentifierMissingLetter:
+         return snprintf(buffer, size, "Identifier name missing [a-zA-Z?]: '%.*s'", length, lexeme);
+
+      case Diagnostic_Code_SymbolMissingLetter:
+         return snprintf(buffer, size, "Symbol name missing [a-zA-Z?]: '%.*s'", length, lexeme);
+
+      case Diagnostic_Code_TouchySymbol:
+         if(extra[1] != '\0')
+         {
+            return snprintf(buffer, size, "\"Touchy\" symbol '%.*s' next to other touchy symbols '%c' and '%c'", length, lexeme, extra[0], extra[1]);
+         }
+         return snprintf(buffer, size, "\"Touchy\" symbol '%.*s' next to another touchy symbol '%c'", length, lexeme, extra[0]);
+
+      case Diagnostic_Code_MissingSpaceBeforeDecimal:
+         return snprintf(buffer, size, "Missing space before decimal number with no leading zero");
+
+      case Diagnostic_Code_StringNotOnOneLine:
+         return snprintf(buffer, size, "String literal not contained on one line.");
+
+      case Diagnostic_Code_StringMissingEnd:
+         return snprintf(buffer, size, "String literal missing ending \"");
+
+      case Diagnostic_Code_MissingSpaceAfterColon:
+         return snprintf(buffer, size, "Missing space after ':'");
+
+      case Diagnostic_Code_UnmatchedBracket:
+         return snprintf(buffer, size, "Unmatched '%.*s'", length, lexeme);
+
+      case Diagnostic_Code_UnclosedBracket:
+         return snprintf(buffer, size, "Unclosed '%.*s'", length, lexeme);
+
+      default:
+         return snprintf(buffer, size, "Unknown error %d", diagnostic->code);
+   }
+}
@@ -0,0 +1,119 @@
+/***
+ * File: Diagnostics.h
+ * Desc: Compact records of errors found while lexing, kept in a ring that is
+ *       allocated up front. Nothing is formatted until a message is asked for,
+ *       so inputs full of errors cost little more to lex than clean ones.
+ */
+
+#ifndef _DIAGNOSTICS_H
+#define _DIAGNOSTICS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "I_Error.h"
+
+// Messages up to this long, counting the terminating null, are formatted on the stack
+#define DIAGNOSTIC_MESSAGE_SIZE (128)
+
+enum
+{
+   Diagnostic_Code_UnexpectedCharacter = 0,    // extra[0] is the character
+   Diagnostic_Code_NonPrintableCharacter,
+   Diagnostic_Code_NonAsciiCharacter,
+   Diagnostic_Code_IdentifierMissingLetter,    // Lexeme is the would-be identifier
+   Diagnostic_Code_SymbolMissingLetter,        // Lexeme is the would-be symbolic literal
+   Diagnostic_Code_TouchySymbol,               // Lexeme is the symbol, extra[0..1] its touchy neighbours
+   Diagnostic_Code_MissingSpaceBeforeDecimal,
+   Diagnostic_Code_StringNotOnOneLine,
+   Diagnostic_Code_StringMissingEnd,
+   Diagnostic_Code_MissingSpaceAfterColon,
+   Diagnostic_Code_UnmatchedBracket,           // Lexeme is the closer
+   Diagnostic_Code_UnclosedBracket,            // Lexeme is the opener
+
+   Diagnostic_Code_Count
+};
+typedef uint8_t Diagnostic_Code_t;
+
+typedef struct
+{
+   Diagnostic_Code_t code;
+   char extra[3];       // Characters the message needs that aren't in the lexeme, '\0' if unused
+   uint32_t length;     // Of the lexeme
+   size_t offset;       // Of the lexeme from the start of the source
+   size_t line;
+} Diagnostic_t;
+
+typedef struct
+{
+   Diagnostic_t *records;
+   size_t capacity;
+   size_t first;        // Index of the oldest record kept
+   size_t count;        // Records kept
+   size_t total;        // Records ever added, including ones the ring has overwritten
+   size_t maxErrors;    // Add says to stop once total reaches this, 0 for never
+} Diagnostics_t;
+
+/*
+ * Initialize a Diagnostics.
+ *
+ * @param capacity - number of records kept; older ones are overwritten by newer (at least 1)
+ * @param maxErrors - number of errors after which lexing should stop, or 0 for no limit
+ */
+void Diagnostics_Init(Diagnostics_t *instance, size_t capacity, size_t maxErrors);
+
+/*
+ * Deinitialize a Diagnostics.
+ */
+void Diagnostics_Deinit(Diagnostics_t *instance);
+
+/*
+ * Forget every record.
+ */
+void Diagnostics_Clear(Diagnostics_t *instance);
+
+/*
+ * Add a record, overwriting the oldest one if the ring is full.
+ *
+ * @return - false if maxErrors has been reached and lexing should stop
+ */
+bool Diagnostics_Add(Diagnostics_t *instance, const Diagnostic_t *diagnostic);
+
+/*
+ * A kept record, oldest first.
+ *
+ * @param index - from 0 to count - 1
+ */
+const Diagnostic_t *Diagnostics_At(const Diagnostics_t *instance, size_t index);
+
+/*
+ * Number of records overwritten before anyone looked at them.
+ */
+size_t Diagnostics_Dropped(const Diagnostics_t *instance);
+
+/*
+ * Report every kept record to an I_Error, formatting each message as it goes.
+ *
+ * @param source - source the records were made from, for their lexemes
+ */
+void Diagnostics_Replay(const Diagnostics_t *instance, const char *source, I_Error_t *target);
+
+/*
+ * Format the message for a record and report it to an I_Error. It's formatted
+ * once, into a buffer on the stack, unless it's too long for that.
+ *
+ * @param source - source the record was made from, for its lexeme
+ * @param line - line to report it at, which may differ from the record's
+ */
+void Diagnostic_Report(const Diagnostic_t *diagnostic, const char *source, I_Error_t *target, size_t line);
+
+/*
+ * Write the message for a record, like snprintf.
+ *
+ * @param source - source the record was made from, for its lexeme
+ * @param buffer - where the message goes, can be NULL if size is 0
+ * @return - length of the whole message, not counting the terminating null
+ */
+size_t Diagnostic_Format(const Diagnostic_t *diagnostic, const char *source, char *buffer, size_t size);
+
+#endif
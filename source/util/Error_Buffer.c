@@ -0,0 +1,71 @@
+/***
+ * File: Error_Buffer.c
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "Error_Buffer.h"
+#include "util.h"
+
+static void report(I_Error_t *interface, size_t line, const char *message)
+{
+   REINTERPRET(instance, interface, Error_Buffer_t *);
+   size_t length = strlen(message) + 1;
+
+   if(instance->count == instance->allocatedCount)
+   {
+      instance->allocatedCount = (instance->allocatedCount + 1) * 3 / 2;
+      instance->entries = realloc(instance->entries, instance->allocatedCount * sizeof(Error_Buffer_Entry_t));
+   }
+
+   while(instance->textAllocated - instance->textUsed < length)
+   {
+      instance->textAllocated = (instance->textAllocated + length) * 3 / 2;
+      instance->text = realloc(instance->text, instance->textAllocated);
+   }
+
+   instance->entries[instance->count].line = line;
+   instance->entries[instance->count].message = instance->textUsed;
+   instance->count++;
+
+   memcpy(&instance->text[instance->textUsed], message, length);
+   instance->textUsed += length;
+}
+
+void Error_Buffer_Init(Error_Buffer_t *instance)
+{
+   instance->interface.report = &report;
+
+   instance->entries = NULL;
+   instance->count = 0;
+   instance->allocatedCount = 0;
+
+   instance->text = NULL;
+   instance->textUsed = 0;
+   instance->textAllocated = 0;
+}
+
+void Error_Buffer_Deinit(Error_Buffer_t *instance)
+{
+   free(instance->entries);
+   free(instance->text);
+}
+
+void Error_Buffer_Clear(Error_Buffer_t *instance)
+{
+   instance->count = 0;
+   instance->textUsed = 0;
+}
+
+void Error_Buffer_Replay(Error_Buffer_t *instance, I_Error_t *target, size_t lineOffset)
+{
+   Error_Buffer_ReplayRange(instance, target, 0, instance->count, lineOffset);
+}
+
+void Error_Buffer_ReplayRange(Error_Buffer_t *instance, I_Error_t *target, size_t first, size_t count, size_t lineOffset)
+{
+   for(size_t i = first; i < first + count; i++)
+   {
+      Error_Report(target, instance->entries[i].line + lineOffset, &instance->text[instance->entries[i].message]);
+   }
+}
@@ -0,0 +1,63 @@
+/***
+ * File: Error_Buffer.h
+ * Desc: Implementation of I_Error that keeps a copy of each error so they can
+ *       be reported somewhere else later, e.g. once work done on another
+ *       thread has been put back in order.
+ */
+
+#ifndef _ERROR_BUFFER_H
+#define _ERROR_BUFFER_H
+
+#include "I_Error.h"
+
+typedef struct
+{
+   size_t line;
+   size_t message;   // Offset of the message in text
+} Error_Buffer_Entry_t;
+
+typedef struct
+{
+   I_Error_t interface;
+
+   Error_Buffer_Entry_t *entries;
+   size_t count;
+   size_t allocatedCount;
+
+   char *text;
+   size_t textUsed;
+   size_t textAllocated;
+} Error_Buffer_t;
+
+/*
+ * Initialize an Error_Buffer.
+ */
+void Error_Buffer_Init(Error_Buffer_t *instance);
+
+/*
+ * Deinitialize an Error_Buffer.
+ */
+void Error_Buffer_Deinit(Error_Buffer_t *instance);
+
+/*
+ * Forget every stored error.
+ */
+void Error_Buffer_Clear(Error_Buffer_t *instance);
+
+/*
+ * Report every stored error to another handler, in the order they arrived.
+ *
+ * @param lineOffset - added to the line of each error
+ */
+void Error_Buffer_Replay(Error_Buffer_t *instance, I_Error_t *target, size_t lineOffset);
+
+/*
+ * Report some of the stored errors to another handler, in the order they arrived.
+ *
+ * @param first - index of the first error to report
+ * @param count - number of errors to report
+ * @param lineOffset - added to the line of each error
+ */
+void Error_Buffer_ReplayRange(Error_Buffer_t *instance, I_Error_t *target, size_t first, size_t count, size_t lineOffset);
+
+#endif
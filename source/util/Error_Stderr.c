@@ -0,0 +1,30 @@
+/***
+ * File: Error_Stderr.c
+ */
+
+#include <stdio.h>
+#include "Error_Stderr.h"
+#include "util.h"
+
+static void report(I_Error_t *interface, size_t line, const char *message)
+{
+   REINTERPRET(instance, interface, Error_Stderr_t *);
+
+   if(instance->name != NULL)
+   {
+      fprintf(stderr, "%s:%zu: %s\n", instance->name, line, message);
+   }
+   else
+   {
+      fprintf(stderr, "line %zu: %s\n", line, message);
+   }
+
+   instance->count++;
+}
+
+void Error_Stderr_Init(Error_Stderr_t *instance, const char *name)
+{
+   instance->interface.report = &report;
+   instance->name = name;
+   instance->count = 0;
+}
@@ -0,0 +1,26 @@
+/***
+ * File: Error_Stderr.h
+ * Desc: Implementation of I_Error that prints each error to stderr
+ */
+
+#ifndef _ERROR_STDERR_H
+#define _ERROR_STDERR_H
+
+#include "I_Error.h"
+
+typedef struct
+{
+   I_Error_t interface;
+
+   const char *name;
+   size_t count;
+} Error_Stderr_t;
+
+/*
+ * Initialize an Error_Stderr.
+ *
+ * @param name - prefix for every message (e.g. the file name), or NULL for none
+ */
+void Error_Stderr_Init(Error_Stderr_t *instance, const char *name);
+
+#endif
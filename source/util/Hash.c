@@ -0,0 +1,109 @@
+/***
+ * File: Hash.c
+ *
+ * Four accumulators each take 8 bytes of every 32, so the multiplies of one
+ * block don't wait on each other. Whatever is left is folded in 8, 4 and 1
+ * bytes at a time, and the result is mixed so every input bit affects every
+ * output bit.
+ */
+
+#include <string.h>
+#include "Hash.h"
+
+#define PRIME_1 (0x9E3779B185EBCA87ULL)
+#define PRIME_2 (0xC2B2AE3D27D4EB4FULL)
+#define PRIME_3 (0x165667B19E3779F9ULL)
+#define PRIME_4 (0x85EBCA77C2B2AE63ULL)
+#define PRIME_5 (0x27D4EB2F165667C5ULL)
+
+static inline uint64_t RotateLeft(uint64_t value, int bits)
+{
+   return (value << bits) | (value >> (64 - bits));
+}
+
+// Unaligned little-endian reads; memcpy compiles to a single load
+static inline uint64_t Read64(const uint8_t *bytes)
+{
+   uint64_t value;
+   memcpy(&value, bytes, sizeof(value));
+   return value;
+}
+
+static inline uint32_t Read32(const uint8_t *bytes)
+{
+   uint32_t value;
+   memcpy(&value, bytes, sizeof(value));
+   return value;
+}
+
+static inline uint64_t Round(uint64_t accumulator, uint64_t input)
+{
+   accumulator += input * PRIME_2;
+   accumulator = RotateLeft(accumulator, 31);
+   return accumulator * PRIME_1;
+}
+
+static inline uint64_t Merge(uint64_t hash, uint64_t accumulator)
+{
+   hash ^= Round(0, accumulator);
+   return hash * PRIME_1 + PRIME_4;
+}
+
+uint64_t Hash_Bytes(const void *data, size_t length, uint64_t seed)
+{
+   const uint8_t *bytes = data;
+   const uint8_t *end = bytes + length;
+   uint64_t hash;
+
+   if(length >= 32)
+   {
+      uint64_t accumulators[4] = { seed + PRIME_1 + PRIME_2, seed + PRIME_2, seed, seed - PRIME_1 };
+
+      for(; end - bytes >= 32; bytes += 32)
+      {
+         accumulators[0] = Round(accumulators[0], Read64(bytes));
+         accumulators[1] = Round(accumulators[1], Read64(bytes + 8));
+         accumulators[2] = Round(accumulators[2], Read64(bytes + 16));
+         accumulators[3] = Round(accumulators[3], Read64(bytes + 24));
+      }
+
+      hash = RotateLeft(accumulators[0], 1) + RotateLeft(accumulators[1], 7) +
+             RotateLeft(accumulators[2], 12) + RotateLeft(accumulators[3], 18);
+      for(int i = 0; i < 4; i++)
+      {
+         hash = Merge(hash, accumulators[i]);
+      }
+   }
+   else
+   {
+      hash = seed + PRIME_5;
+   }
+
+   hash += length;
+
+   for(; end - bytes >= 8; bytes += 8)
+   {
+      hash ^= Round(0, Read64(bytes));
+      hash = RotateLeft(hash, 27) * PRIME_1 + PRIME_4;
+   }
+
+   if(end - bytes >= 4)
+   {
+      hash ^= Read32(bytes) * PRIME_1;
+      hash = RotateLeft(hash, 23) * PRIME_2 + PRIME_3;
+      bytes += 4;
+   }
+
+   for(; bytes < end; bytes++)
+   {
+      hash ^= *bytes * PRIME_5;
+      hash = RotateLeft(hash, 11) * PRIME_1;
+   }
+
+   hash ^= hash >> 33;
+   hash *= PRIME_2;
+   hash ^= hash >> 29;
+   hash *= PRIME_3;
+   hash ^= hash >> 32;
+   return hash;
+}
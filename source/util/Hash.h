@@ -0,0 +1,20 @@
+/***
+ * File: Hash.h
+ * Desc: Fast non-cryptographic 64-bit hash of a block of bytes, for telling
+ *       sources apart. Gives the same values as XXH64.
+ */
+
+#ifndef _HASH_H
+#define _HASH_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Hash a block of bytes.
+ *
+ * @param seed - mixed in first; different seeds give unrelated hashes
+ */
+uint64_t Hash_Bytes(const void *data, size_t length, uint64_t seed);
+
+#endif
@@ -0,0 +1,241 @@
+/***
+ * File: Intern.c
+ *
+ * Names are found by linear probing from their hash. The table is kept at most
+ * three quarters full, and an empty slot ends every probe since nothing is ever
+ * removed.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include "Intern.h"
+#include "Token.h"
+
+#define INTERN_FIRST_SLOT_COUNT (64)
+
+/*********************************
+ * Reserved words
+ *
+ * The first and last characters pick a different slot for each reserved word,
+ * so finding one takes one comparison. A new word needs a slot of its own;
+ * widen the mask if it doesn't get one.
+ *********************************/
+#define RESERVED_SLOT(first, last) ((uint8_t)((first) + (last)) & 7)
+
+typedef struct
+{
+   const char *name;
+   size_t length;
+   Intern_Id_t id;
+} Reserved_Entry_t;
+
+static const char *reservedNames[Intern_Reserved_Count] =
+{
+   [Intern_Reserved_And] = "and",
+   [Intern_Reserved_Or]  = "or",
+   [Intern_Reserved_Not] = "not"
+};
+
+static const Reserved_Entry_t reservedTable[8] =
+{
+   [RESERVED_SLOT('a', 'd')] = { "and", 3, Intern_Reserved_And },
+   [RESERVED_SLOT('o', 'r')] = { "or",  2, Intern_Reserved_Or  },
+   [RESERVED_SLOT('n', 't')] = { "not", 3, Intern_Reserved_Not }
+};
+
+Intern_Id_t Intern_Reserved(const char *name, size_t length)
+{
+   const Reserved_Entry_t *entry;
+
+   if(length == 0)
+   {
+      return INTERN_NONE;
+   }
+
+   entry = &reservedTable[RESERVED_SLOT(name[0], name[length - 1])];
+   if(entry->length == length && memcmp(entry->name, name, length) == 0)
+   {
+      return entry->id;
+   }
+
+   return INTERN_NONE;
+}
+
+/*********************************
+ * Table
+ *********************************/
+// FNV-1a
+static uint32_t Hash(const char *name, size_t length)
+{
+   uint32_t hash = 2166136261u;
+
+   for(size_t i = 0; i < length; i++)
+   {
+      hash = (hash ^ (uint8_t)name[i]) * 16777619u;
+   }
+
+   return hash;
+}
+
+// Slot holding the name, or the empty slot where it would go
+static size_t Probe(const Intern_t *instance, const char *name, size_t length, uint32_t hash)
+{
+   size_t mask = instance->slotCount - 1;
+   size_t slot = hash & mask;
+
+   while(instance->slots[slot] != 0)
+   {
+      const Intern_Entry_t *entry = &instance->entries[instance->slots[slot] - 1];
+
+      if(entry->hash == hash && entry->length == length && memcmp(&instance->text[entry->offset], name, length) == 0)
+      {
+         break;
+      }
+      slot = (slot + 1) & mask;
+   }
+
+   return slot;
+}
+
+static void Grow(Intern_t *instance)
+{
+   size_t mask;
+
+   free(instance->slots);
+   instance->slotCount *= 2;
+   instance->slots = calloc(instance->slotCount, sizeof(uint32_t));
+   mask = instance->slotCount - 1;
+
+   for(size_t id = 0; id < instance->count; id++)
+   {
+      size_t slot = instance->entries[id].hash & mask;
+
+      while(instance->slots[slot] != 0)
+      {
+         slot = (slot + 1) & mask;
+      }
+      instance->slots[slot] = id + 1;
+   }
+}
+
+static Intern_Id_t Insert(Intern_t *instance, const char *name, size_t length, uint32_t hash, size_t slot)
+{
+   Intern_Id_t id = instance->count;
+
+   if(instance->count == instance->allocatedCount)
+   {
+      instance->allocatedCount = (instance->allocatedCount + 1) * 3 / 2;
+      instance->entries = realloc(instance->entries, instance->allocatedCount * sizeof(Intern_Entry_t));
+   }
+
+   while(instance->textAllocated - instance->textUsed < length + 1)
+   {
+      instance->textAllocated = (instance->textAllocated + length + 1) * 3 / 2;
+      instance->text = realloc(instance->text, instance->textAllocated);
+   }
+
+   instance->entries[id].offset = instance->textUsed;
+   instance->entries[id].length = length;
+   instance->entries[id].hash = hash;
+   memcpy(&instance->text[instance->textUsed], name, length);
+   instance->text[instance->textUsed + length] = '\0';
+   instance->textUsed += length + 1;
+
+   instance->slots[slot] = id + 1;
+   instance->count++;
+
+   if(instance->count * 4 > instance->slotCount * 3)
+   {
+      Grow(instance);
+   }
+
+   return id;
+}
+
+Intern_Id_t Intern_Add(Intern_t *instance, const char *name, size_t length)
+{
+   Intern_Id_t id = Intern_Reserved(name, length);
+   uint32_t hash;
+   size_t slot;
+
+   if(id != INTERN_NONE)
+   {
+      return id;
+   }
+
+   hash = Hash(name, length);
+   slot = Probe(instance, name, length, hash);
+
+   if(instance->slots[slot] != 0)
+   {
+      return instance->slots[slot] - 1;
+   }
+
+   return Insert(instance, name, length, hash, slot);
+}
+
+Intern_Id_t Intern_Find(const Intern_t *instance, const char *name, size_t length)
+{
+   size_t slot = Probe(instance, name, length, Hash(name, length));
+
+   return (instance->slots[slot] != 0) ? instance->slots[slot] - 1 : INTERN_NONE;
+}
+
+const char *Intern_Name(const Intern_t *instance, Intern_Id_t id, size_t *length)
+{
+   if(length != NULL)
+   {
+      *length = instance->entries[id].length;
+   }
+
+   return &instance->text[instance->entries[id].offset];
+}
+
+void Intern_Tokens(Intern_t *instance, I_List_t *tokens, I_List_t *ids)
+{
+   Token_t *token;
+
+   List_At(tokens, 0, (void **)&token);
+   for(size_t i = 0; token != NULL; i++)
+   {
+      Intern_Id_t id = INTERN_NONE;
+
+      if(token->type == Token_Type_Identifier || token->type == Token_Type_Literal_Symbol)
+      {
+         id = Intern_Add(instance, token->lexeme, token->length);
+      }
+      List_Add(ids, &id);
+
+      List_At(tokens, i + 1, (void **)&token);
+   }
+}
+
+void Intern_Init(Intern_t *instance)
+{
+   instance->slotCount = INTERN_FIRST_SLOT_COUNT;
+   instance->slots = calloc(instance->slotCount, sizeof(uint32_t));
+
+   instance->entries = NULL;
+   instance->count = 0;
+   instance->allocatedCount = 0;
+
+   instance->text = NULL;
+   instance->textUsed = 0;
+   instance->textAllocated = 0;
+
+   // In order, so each gets the ID it's named for
+   for(Intern_Id_t id = 0; id < Intern_Reserved_Count; id++)
+   {
+      size_t length = strlen(reservedNames[id]);
+      uint32_t hash = Hash(reservedNames[id], length);
+
+      Insert(instance, reservedNames[id], length, hash, Probe(instance, reservedNames[id], length, hash));
+   }
+}
+
+void Intern_Deinit(Intern_t *instance)
+{
+   free(instance->slots);
+   free(instance->entries);
+   free(instance->text);
+}
@@ -0,0 +1,99 @@
+/***
+ * File: Intern.h
+ * Desc: String table that gives each distinct name a small dense ID, so later
+ *       stages can compare names by ID and each name is stored once. The
+ *       language's reserved words always have the same IDs.
+ */
+
+#ifndef _INTERN_H
+#define _INTERN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "I_List.h"
+
+typedef uint32_t Intern_Id_t;
+
+// ID of tokens that aren't names
+#define INTERN_NONE (UINT32_MAX)
+
+enum
+{
+   Intern_Reserved_And = 0,
+   Intern_Reserved_Or,
+   Intern_Reserved_Not,
+
+   Intern_Reserved_Count
+};
+
+typedef struct
+{
+   uint32_t offset;  // Of the name in text
+   uint32_t length;
+   uint32_t hash;
+} Intern_Entry_t;
+
+typedef struct
+{
+   // Power of two slots, each holding an ID + 1, or 0 if empty
+   uint32_t *slots;
+   size_t slotCount;
+
+   // Indexed by ID
+   Intern_Entry_t *entries;
+   size_t count;
+   size_t allocatedCount;
+
+   // Every name, each followed by '\0'
+   char *text;
+   size_t textUsed;
+   size_t textAllocated;
+} Intern_t;
+
+/*
+ * Initialize an Intern table holding just the reserved words.
+ */
+void Intern_Init(Intern_t *instance);
+
+/*
+ * Deinitialize an Intern table.
+ */
+void Intern_Deinit(Intern_t *instance);
+
+/*
+ * ID of a name, adding it to the table if it's new.
+ */
+Intern_Id_t Intern_Add(Intern_t *instance, const char *name, size_t length);
+
+/*
+ * ID of a name, or INTERN_NONE if it isn't in the table.
+ */
+Intern_Id_t Intern_Find(const Intern_t *instance, const char *name, size_t length);
+
+/*
+ * Text of an interned name. It stays valid until the next Intern_Add.
+ *
+ * @param length - set to the length of the name (can be NULL)
+ */
+const char *Intern_Name(const Intern_t *instance, Intern_Id_t id, size_t *length);
+
+/*
+ * ID of a reserved word without going through any table, or INTERN_NONE if
+ * the name isn't one.
+ */
+Intern_Id_t Intern_Reserved(const char *name, size_t length);
+
+/*
+ * Intern the name of every identifier and symbolic literal in a list of tokens.
+ *
+ * @param ids - gets one Intern_Id_t per token, INTERN_NONE for other kinds of token
+ */
+void Intern_Tokens(Intern_t *instance, I_List_t *tokens, I_List_t *ids);
+
+static inline bool Intern_IsReserved(Intern_Id_t id)
+{
+   return id < Intern_Reserved_Count;
+}
+
+#endif
@@ -0,0 +1,78 @@
+/***
+ * File: LineIndex.c
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "LineIndex.h"
+
+void LineIndex_Init(LineIndex_t *instance)
+{
+   instance->newlines = NULL;
+   instance->count = 0;
+   instance->allocatedCount = 0;
+}
+
+void LineIndex_Deinit(LineIndex_t *instance)
+{
+   free(instance->newlines);
+}
+
+void LineIndex_Clear(LineIndex_t *instance)
+{
+   instance->count = 0;
+}
+
+void LineIndex_Reserve(LineIndex_t *instance, size_t count)
+{
+   if(instance->allocatedCount >= count)
+   {
+      return;
+   }
+
+   instance->allocatedCount = (instance->allocatedCount * 2 > count) ? instance->allocatedCount * 2 : count;
+   instance->newlines = realloc(instance->newlines, instance->allocatedCount * sizeof(uint32_t));
+}
+
+void LineIndex_Build(LineIndex_t *instance, const char *source, size_t length)
+{
+   const char *end = source + length;
+   const char *newline = source;
+
+   instance->count = 0;
+
+   // glibc's memchr already searches 16-32 bytes at a time
+   while((newline = memchr(newline, '\n', end - newline)) != NULL)
+   {
+      if(instance->count == 0)
+      {
+         LineIndex_Reserve(instance, length / 32 + 16);
+      }
+
+      LineIndex_Add(instance, newline - source);
+      newline++;
+   }
+}
+
+void LineIndex_Locate(const LineIndex_t *instance, size_t offset, size_t *line, size_t *column)
+{
+   // Count the newlines before offset
+   size_t low = 0;
+   size_t high = instance->count;
+
+   while(low < high)
+   {
+      size_t middle = low + (high - low) / 2;
+
+      if(instance->newlines[middle] < offset)
+      {
+         low = middle + 1;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   *line = low + 1;
+   *column = (low == 0) ? offset + 1 : offset - instance->newlines[low - 1];
+}
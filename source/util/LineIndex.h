@@ -0,0 +1,69 @@
+/***
+ * File: LineIndex.h
+ * Desc: Offsets of every newline in a source, for finding the line and column
+ *       of any character when they're needed instead of tracking them for
+ *       every token.
+ */
+
+#ifndef _LINEINDEX_H
+#define _LINEINDEX_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct
+{
+   uint32_t *newlines;     // Offset of each '\n', in order
+   size_t count;
+   size_t allocatedCount;
+} LineIndex_t;
+
+/*
+ * Initialize an empty LineIndex.
+ */
+void LineIndex_Init(LineIndex_t *instance);
+
+/*
+ * Deinitialize a LineIndex.
+ */
+void LineIndex_Deinit(LineIndex_t *instance);
+
+/*
+ * Empty the index but keep its memory to fill again.
+ */
+void LineIndex_Clear(LineIndex_t *instance);
+
+/*
+ * Make room for at least count newlines.
+ */
+void LineIndex_Reserve(LineIndex_t *instance, size_t count);
+
+/*
+ * Replace the index with the newlines of a source.
+ *
+ * @pre - length is less than 4GB
+ */
+void LineIndex_Build(LineIndex_t *instance, const char *source, size_t length);
+
+/*
+ * Find the line and column of the character at offset. Both count from 1, and
+ * columns count bytes.
+ */
+void LineIndex_Locate(const LineIndex_t *instance, size_t offset, size_t *line, size_t *column);
+
+/*
+ * Add the offset of the next newline, for code that finds them itself.
+ *
+ * @pre - offset is after every newline already in the index
+ */
+static inline void LineIndex_Add(LineIndex_t *instance, size_t offset)
+{
+   if(instance->count == instance->allocatedCount)
+   {
+      LineIndex_Reserve(instance, instance->count + 1);
+   }
+
+   instance->newlines[instance->count++] = (uint32_t)offset;
+}
+
+#endif
@@ -0,0 +1,108 @@
+/***
+ * File: List_Arena.c
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "List_Arena.h"
+#include "util.h"
+
+static inline uint8_t *ItemAt(List_Arena_t *instance, size_t index)
+{
+   size_t mask = ((size_t)1 << instance->slabShift) - 1;
+   return instance->slabs[index >> instance->slabShift] + ((index & mask) * instance->itemSize);
+}
+
+/*
+ * Add slabs until index is a valid location. Only the slab directory is ever
+ * reallocated, never the slabs themselves.
+ */
+static void GrowList(List_Arena_t *instance, size_t index)
+{
+   while((index >> instance->slabShift) >= instance->slabCount)
+   {
+      if(instance->slabCount == instance->allocatedSlabCount)
+      {
+         instance->allocatedSlabCount = (instance->allocatedSlabCount == 0) ? 8 : instance->allocatedSlabCount * 2;
+         instance->slabs = realloc(instance->slabs, instance->allocatedSlabCount * sizeof(uint8_t *));
+      }
+
+      instance->slabs[instance->slabCount++] = malloc(instance->itemSize << instance->slabShift);
+   }
+}
+
+static void set(I_List_t *interface, size_t index, void *item)
+{
+   REINTERPRET(instance, interface, List_Arena_t *);
+
+   if(index >= instance->usedSize)
+   {
+      GrowList(instance, index);
+
+      // Items skipped over read as zero, same as a new calloc'd item would
+      for(size_t skipped = instance->usedSize; skipped < index; skipped++)
+      {
+         memset(ItemAt(instance, skipped), 0, instance->itemSize);
+      }
+
+      instance->usedSize = index + 1;
+   }
+
+   memcpy(ItemAt(instance, index), item, instance->itemSize);
+}
+
+static void add(I_List_t *interface, void *item)
+{
+   REINTERPRET(instance, interface, List_Arena_t *);
+
+   if((instance->usedSize >> instance->slabShift) == instance->slabCount)
+   {
+      GrowList(instance, instance->usedSize);
+   }
+
+   memcpy(ItemAt(instance, instance->usedSize), item, instance->itemSize);
+   instance->usedSize++;
+}
+
+static void at(I_List_t *interface, size_t index, void **item)
+{
+   REINTERPRET(instance, interface, List_Arena_t *);
+
+   *item = (index < instance->usedSize) ?
+      ItemAt(instance, index) :
+      NULL;
+}
+
+void List_Arena_Init(List_Arena_t *instance, size_t itemSize)
+{
+   instance->interface.at = &at;
+   instance->interface.set = &set;
+   instance->interface.add = &add;
+
+   instance->itemSize = itemSize;
+   instance->usedSize = 0;
+
+   instance->slabShift = 0;
+   while((itemSize << (instance->slabShift + 1)) <= LIST_ARENA_SLAB_SIZE)
+   {
+      instance->slabShift++;
+   }
+
+   instance->slabs = NULL;
+   instance->slabCount = 0;
+   instance->allocatedSlabCount = 0;
+}
+
+void List_Arena_Deinit(List_Arena_t *instance)
+{
+   for(size_t i = 0; i < instance->slabCount; i++)
+   {
+      free(instance->slabs[i]);
+   }
+
+   free(instance->slabs);
+}
+
+void List_Arena_Reset(List_Arena_t *instance)
+{
+   instance->usedSize = 0;
+}
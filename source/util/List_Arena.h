@@ -0,0 +1,48 @@
+/***
+ * File: List_Arena.h
+ * Desc: Implements list interface with fixed-size slabs that are never moved,
+ *       so pointers to items stay valid as more items are added.
+ */
+
+#ifndef _LIST_ARENA_H
+#define _LIST_ARENA_H
+
+#include <stdint.h>
+#include "I_List.h"
+
+// Bytes of items in each slab (rounded down to a power of two number of items)
+#define LIST_ARENA_SLAB_SIZE (64 * 1024)
+
+typedef struct
+{
+   I_List_t interface;
+
+   size_t itemSize;
+   size_t usedSize;
+   size_t slabShift;       // Each slab holds (1 << slabShift) items
+
+   uint8_t **slabs;
+   size_t slabCount;
+   size_t allocatedSlabCount;
+} List_Arena_t;
+
+/*
+ * Initialize a List_Arena
+ *
+ * @param itemSize - size of each list item in bytes
+ */
+void List_Arena_Init(List_Arena_t *instance, size_t itemSize);
+
+/*
+ * Deinitialize a List_Arena
+ */
+void List_Arena_Deinit(List_Arena_t *instance);
+
+/*
+ * Empty the list but keep its slabs to fill again.
+ *
+ * @post Pointers to items from before the reset point to the new items.
+ */
+void List_Arena_Reset(List_Arena_t *instance);
+
+#endif
@@ -4,16 +4,33 @@
 #include <stdlib.h>
 #include <string.h> 
 #include "List_Calloc.h"
+#include "Stats.h"
 #include "util.h"
 
+#ifdef PARSER_STATS
+static void CountGrowth(List_Calloc_t *instance, const uint8_t *oldStorage)
+{
+   instance->stats.grows++;
+   if(oldStorage != NULL && oldStorage != instance->storage)
+   {
+      instance->stats.moves++;
+      instance->stats.bytesMoved += instance->usedSize * instance->itemSize;
+   }
+   instance->stats.peakBytes = instance->allocatedSize * instance->itemSize;
+}
+#endif
+
 static void GrowList(List_Calloc_t *instance, size_t minNewSize)
 {
+   STATS(const uint8_t *oldStorage = instance->storage;)
+
    while(instance->allocatedSize < minNewSize)
    {
       instance->allocatedSize = (instance->allocatedSize + 1) * 3 / 2;
    }
 
    instance->storage = realloc(instance->storage, (instance->allocatedSize * instance->itemSize));
+   STATS(CountGrowth(instance, oldStorage);)
 }
 
 static void set(I_List_t *interface, size_t index, void *item)
@@ -66,6 +83,8 @@ void List_Calloc_Init(List_Calloc_t *instance, size_t itemSize)
    instance->allocatedSize = 0;
 
    instance->storage = NULL;
+
+   STATS(memset(&instance->stats, 0, sizeof(instance->stats));)
 }
 
 void List_Calloc_Deinit(List_Calloc_t *instance)
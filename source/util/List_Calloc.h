@@ -9,6 +9,16 @@
 #include <stdint.h>
 #include "I_List.h"
 
+#ifdef PARSER_STATS
+typedef struct
+{
+   size_t grows;        // Times the storage was made bigger
+   size_t moves;        // Times growing it moved it somewhere else
+   size_t bytesMoved;   // Bytes copied by those moves
+   size_t peakBytes;    // Most storage ever allocated
+} List_Calloc_Stats_t;
+#endif
+
 typedef struct
 {
    I_List_t interface;
@@ -18,6 +28,10 @@ typedef struct
    size_t allocatedSize;
 
    uint8_t *storage;
+
+#ifdef PARSER_STATS
+   List_Calloc_Stats_t stats;
+#endif
 } List_Calloc_t;
 
 /*
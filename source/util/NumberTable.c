@@ -0,0 +1,356 @@
+/***
+ * File: NumberTable.c
+ *
+ * Digits are read eight at a time where there are that many: eight ASCII
+ * digits loaded as one little-endian word are combined into four two-digit
+ * values, then two four-digit values, then one eight-digit value, with a
+ * multiply and a shift each time (SWAR, SIMD within a register). Nineteen
+ * digits always fit in 64 bits, so only a twentieth needs checking.
+ *
+ * A decimal whose digits fit in 53 bits and that is divided by a power of ten
+ * up to 10^22 is converted exactly with one division, since both operands are
+ * exact doubles and IEEE division rounds correctly (Clinger's fast path).
+ * That covers almost every literal written by hand; the rest go through
+ * strtod, which also rounds correctly.
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <stdbool.h>
+#include "NumberTable.h"
+
+#define NUMBERTABLE_SAFE_DIGITS (19)         // Any number with this many digits fits in 64 bits
+#define NUMBERTABLE_EXACT_MANTISSA (1ULL << 53)
+#define NUMBERTABLE_LOCAL_COPY_SIZE (64)     // Longest lexeme strtod is given a copy of on the stack
+
+// Powers of ten a double holds exactly
+static const double exactPowersOfTen[] =
+{
+   1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+   1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22
+};
+
+// Part of a lexeme holding digits
+typedef struct
+{
+   const char *digits;
+   size_t count;
+} NumberTable_Span_t;
+
+static uint64_t EightDigits(const char *digits)
+{
+   uint64_t word;
+
+   memcpy(&word, digits, sizeof(word));
+#if __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+   word = __builtin_bswap64(word);
+#endif
+   word = ((word & 0x0F0F0F0F0F0F0F0FULL) * 2561) >> 8;
+   word = ((word & 0x00FF00FF00FF00FFULL) * 6553601) >> 16;
+   return ((word & 0x0000FFFF0000FFFFULL) * 42949672960001ULL) >> 32;
+}
+
+/*
+ * Append digits to value.
+ *
+ * @pre - value and the digits together have at most NUMBERTABLE_SAFE_DIGITS digits
+ */
+static uint64_t Accumulate(uint64_t value, NumberTable_Span_t span)
+{
+   const char *digits = span.digits;
+   size_t count = span.count;
+
+   for(; count >= 8; digits += 8, count -= 8)
+   {
+      value = value * 100000000 + EightDigits(digits);
+   }
+   for(; count > 0; digits++, count--)
+   {
+      value = value * 10 + (uint64_t)(*digits - '0');
+   }
+
+   return value;
+}
+
+static NumberTable_Span_t SkipLeadingZeros(NumberTable_Span_t span)
+{
+   while(span.count > 0 && *span.digits == '0')
+   {
+      span.digits++;
+      span.count--;
+   }
+
+   return span;
+}
+
+/*
+ * Read a whole number.
+ *
+ * @return - false if it doesn't fit in 64 bits
+ */
+static bool ReadInteger(NumberTable_Span_t span, uint64_t *value)
+{
+   span = SkipLeadingZeros(span);
+
+   if(span.count <= NUMBERTABLE_SAFE_DIGITS)
+   {
+      *value = Accumulate(0, span);
+      return true;
+   }
+   if(span.count == NUMBERTABLE_SAFE_DIGITS + 1)
+   {
+      uint64_t most = Accumulate(0, (NumberTable_Span_t){ span.digits, NUMBERTABLE_SAFE_DIGITS });
+
+      return !__builtin_mul_overflow(most, 10, value) &&
+             !__builtin_add_overflow(*value, (uint64_t)(span.digits[NUMBERTABLE_SAFE_DIGITS] - '0'), value);
+   }
+
+   return false;
+}
+
+static double ReadRealSlowly(const char *lexeme, size_t length)
+{
+   char local[NUMBERTABLE_LOCAL_COPY_SIZE];
+   char *copy = (length < sizeof(local)) ? local : malloc(length + 1);
+   double real;
+
+   memcpy(copy, lexeme, length);
+   copy[length] = '\0';
+   real = strtod(copy, NULL);
+
+   if(copy != local)
+   {
+      free(copy);
+   }
+   return real;
+}
+
+static void AddEntry(NumberTable_t *instance, const NumberTable_Entry_t *entry)
+{
+   if(instance->count == instance->allocatedCount)
+   {
+      instance->allocatedCount = (instance->allocatedCount + 1) * 3 / 2;
+      instance->entries = realloc(instance->entries, instance->allocatedCount * sizeof(NumberTable_Entry_t));
+   }
+
+   instance->entries[instance->count++] = *entry;
+}
+
+/*
+ * Keep the significant digits of a number, which are the digits of two spans
+ * one after the other, times 10^exponent.
+ *
+ * @pre - the first span doesn't start with a zero, or is empty and the second doesn't
+ * @return - index of the Big
+ */
+static uint64_t AddBig(NumberTable_t *instance, const NumberTable_Span_t spans[2], int32_t exponent, double real)
+{
+   NumberTable_Big_t *big;
+   NumberTable_Span_t kept[2] = { spans[0], spans[1] };
+   size_t count;
+   size_t written = 0;
+
+   // Trailing zeros only add to the exponent
+   for(int s = 1; s >= 0 && (s == 1 || kept[1].count == 0); s--)
+   {
+      while(kept[s].count > 0 && kept[s].digits[kept[s].count - 1] == '0')
+      {
+         kept[s].count--;
+         exponent++;
+      }
+   }
+   count = kept[0].count + kept[1].count;
+
+   if(instance->bigCount == instance->allocatedBigCount)
+   {
+      instance->allocatedBigCount = (instance->allocatedBigCount + 1) * 3 / 2;
+      instance->bigs = realloc(instance->bigs, instance->allocatedBigCount * sizeof(NumberTable_Big_t));
+   }
+   if(instance->digitBytes + (count + 1) / 2 > instance->allocatedDigitBytes)
+   {
+      instance->allocatedDigitBytes = (instance->digitBytes + (count + 1) / 2 + 1) * 3 / 2;
+      instance->digits = realloc(instance->digits, instance->allocatedDigitBytes);
+   }
+
+   big = &instance->bigs[instance->bigCount];
+   big->real = real;
+   big->digitOffset = (uint32_t)instance->digitBytes;
+   big->digitCount = (uint32_t)count;
+   big->exponent = exponent;
+
+   for(int s = 0; s < 2; s++)
+   {
+      for(size_t i = 0; i < kept[s].count; i++, written++)
+      {
+         uint8_t digit = (uint8_t)(kept[s].digits[i] - '0');
+         uint8_t *byte = &instance->digits[instance->digitBytes + written / 2];
+
+         *byte = (written % 2 == 0) ? (uint8_t)(digit << 4) : (uint8_t)(*byte | digit);
+      }
+   }
+   instance->digitBytes += (count + 1) / 2;
+
+   return instance->bigCount++;
+}
+
+static void DecodeInteger(NumberTable_t *instance, NumberTable_Entry_t *entry, const char *lexeme, size_t length)
+{
+   NumberTable_Span_t spans[2] = { SkipLeadingZeros((NumberTable_Span_t){ lexeme, length }), { lexeme + length, 0 } };
+
+   if(ReadInteger(spans[0], &entry->value.integer))
+   {
+      entry->kind = NumberTable_Kind_Integer;
+   }
+   else
+   {
+      entry->kind = NumberTable_Kind_Big;
+      entry->value.big = AddBig(instance, spans, 0, ReadRealSlowly(lexeme, length));
+   }
+}
+
+static void DecodeReal(NumberTable_t *instance, NumberTable_Entry_t *entry, const char *lexeme, size_t length, const char *point)
+{
+   NumberTable_Span_t whole = SkipLeadingZeros((NumberTable_Span_t){ lexeme, point - lexeme });
+   NumberTable_Span_t fraction = { point + 1, lexeme + length - (point + 1) };
+   int32_t exponent;
+
+   // Trailing zeros after the point change nothing
+   while(fraction.count > 0 && fraction.digits[fraction.count - 1] == '0')
+   {
+      fraction.count--;
+   }
+   exponent = -(int32_t)fraction.count;
+   if(whole.count == 0)
+   {
+      fraction = SkipLeadingZeros(fraction);
+   }
+
+   if(whole.count + fraction.count <= NUMBERTABLE_SAFE_DIGITS)
+   {
+      uint64_t mantissa = Accumulate(Accumulate(0, whole), fraction);
+
+      entry->kind = NumberTable_Kind_Real;
+      if(mantissa <= NUMBERTABLE_EXACT_MANTISSA && -exponent < (int32_t)(sizeof(exactPowersOfTen) / sizeof(double)))
+      {
+         entry->value.real = (double)mantissa / exactPowersOfTen[-exponent];
+      }
+      else
+      {
+         entry->value.real = ReadRealSlowly(lexeme, length);
+      }
+   }
+   else
+   {
+      NumberTable_Span_t spans[2] = { whole, fraction };
+
+      entry->kind = NumberTable_Kind_Big;
+      entry->value.big = AddBig(instance, spans, exponent, ReadRealSlowly(lexeme, length));
+   }
+}
+
+void NumberTable_Init(NumberTable_t *instance)
+{
+   instance->entries = NULL;
+   instance->count = 0;
+   instance->allocatedCount = 0;
+   instance->bigs = NULL;
+   instance->bigCount = 0;
+   instance->allocatedBigCount = 0;
+   instance->digits = NULL;
+   instance->digitBytes = 0;
+   instance->allocatedDigitBytes = 0;
+}
+
+void NumberTable_Deinit(NumberTable_t *instance)
+{
+   free(instance->entries);
+   free(instance->bigs);
+   free(instance->digits);
+}
+
+void NumberTable_Clear(NumberTable_t *instance)
+{
+   instance->count = 0;
+   instance->bigCount = 0;
+   instance->digitBytes = 0;
+}
+
+void NumberTable_Add(NumberTable_t *instance, uint32_t token, const char *lexeme, size_t length)
+{
+   NumberTable_Entry_t entry = { .token = token };
+   const char *point = memchr(lexeme, '.', length);
+
+   if(length > 0 && (lexeme[length - 1] == '\'' || lexeme[length - 1] == '"'))
+   {
+      entry.kind = (lexeme[length - 1] == '\'') ? NumberTable_Kind_Bytes : NumberTable_Kind_Bits;
+      if(!ReadInteger((NumberTable_Span_t){ lexeme, length - 1 }, &entry.value.integer))
+      {
+         entry.value.integer = UINT64_MAX;
+      }
+   }
+   else if(point == NULL)
+   {
+      DecodeInteger(instance, &entry, lexeme, length);
+   }
+   else
+   {
+      DecodeReal(instance, &entry, lexeme, length, point);
+   }
+
+   AddEntry(instance, &entry);
+}
+
+const NumberTable_Entry_t *NumberTable_Find(const NumberTable_t *instance, uint32_t token)
+{
+   size_t low = 0;
+   size_t high = instance->count;
+
+   while(low < high)
+   {
+      size_t middle = low + (high - low) / 2;
+
+      if(instance->entries[middle].token < token)
+      {
+         low = middle + 1;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   return (low < instance->count && instance->entries[low].token == token) ? &instance->entries[low] : NULL;
+}
+
+double NumberTable_Real(const NumberTable_t *instance, const NumberTable_Entry_t *entry)
+{
+   switch(entry->kind)
+   {
+      case NumberTable_Kind_Real:
+         return entry->value.real;
+
+      case NumberTable_Kind_Big:
+         return instance->bigs[entry->value.big].real;
+
+      default:
+         return (double)entry->value.integer;
+   }
+}
+
+size_t NumberTable_Digits(const NumberTable_t *instance, const NumberTable_Entry_t *entry, char *buffer, size_t size)
+{
+   const NumberTable_Big_t *big = &instance->bigs[entry->value.big];
+   const uint8_t *packed = &instance->digits[big->digitOffset];
+   size_t i;
+
+   for(i = 0; i + 1 < size && i < big->digitCount; i++)
+   {
+      buffer[i] = (char)('0' + ((i % 2 == 0) ? (packed[i / 2] >> 4) : (packed[i / 2] & 0x0F)));
+   }
+   if(size > 0)
+   {
+      buffer[i] = '\0';
+   }
+
+   return big->digitCount;
+}
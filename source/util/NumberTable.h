@@ -0,0 +1,111 @@
+/***
+ * File: NumberTable.h
+ * Desc: Values of the number literals of a source, decoded once while lexing
+ *       so nothing after the lexer has to parse them again. Entries are kept
+ *       by token index, in order.
+ *
+ *       Whole numbers that fit in 64 bits are kept as integers, and numbers
+ *       with a decimal point as the nearest double. Anything with more digits
+ *       than that is kept exactly, as packed decimal digits and a power of
+ *       ten. Byte and bit widths like 6' and 3" (which lex as identifiers)
+ *       are kept as the integer before their suffix.
+ */
+
+#ifndef _NUMBERTABLE_H
+#define _NUMBERTABLE_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+enum
+{
+   NumberTable_Kind_Integer = 0,      // value.integer
+   NumberTable_Kind_Real,             // value.real, the nearest double
+   NumberTable_Kind_Big,              // value.big, index into bigs
+   NumberTable_Kind_Bytes,            // value.integer, UINT64_MAX if it doesn't fit
+   NumberTable_Kind_Bits,             // value.integer, UINT64_MAX if it doesn't fit
+
+   NumberTable_Kind_Count
+};
+typedef uint8_t NumberTable_Kind_t;
+
+typedef struct
+{
+   uint32_t token;                    // Index of the literal's token
+   NumberTable_Kind_t kind;
+   union
+   {
+      uint64_t integer;
+      double real;
+      uint64_t big;
+   } value;
+} NumberTable_Entry_t;
+
+// A number with too many digits for an integer or a double
+typedef struct
+{
+   double real;                       // Nearest double
+   uint32_t digitOffset;              // Of its first byte in digits
+   uint32_t digitCount;               // Significant digits, from the first nonzero one
+   int32_t exponent;                  // Value is the digits times 10^exponent
+} NumberTable_Big_t;
+
+typedef struct
+{
+   NumberTable_Entry_t *entries;
+   size_t count;
+   size_t allocatedCount;
+
+   NumberTable_Big_t *bigs;
+   size_t bigCount;
+   size_t allocatedBigCount;
+
+   uint8_t *digits;                   // Two per byte, the first in the high nibble
+   size_t digitBytes;
+   size_t allocatedDigitBytes;
+} NumberTable_t;
+
+/*
+ * Initialize an empty NumberTable.
+ */
+void NumberTable_Init(NumberTable_t *instance);
+
+/*
+ * Deinitialize a NumberTable.
+ */
+void NumberTable_Deinit(NumberTable_t *instance);
+
+/*
+ * Forget every entry, keeping the memory for the next source.
+ */
+void NumberTable_Clear(NumberTable_t *instance);
+
+/*
+ * Decode a number literal and add its entry.
+ *
+ * @param token - index of its token, greater than that of any entry before it
+ * @param lexeme - as the lexer gives it: [0-9]*[.]?[0-9]*, or [0-9]+ followed by ' or "
+ */
+void NumberTable_Add(NumberTable_t *instance, uint32_t token, const char *lexeme, size_t length);
+
+/*
+ * Find the entry of a token.
+ *
+ * @return - NULL if the token isn't a number in the table
+ */
+const NumberTable_Entry_t *NumberTable_Find(const NumberTable_t *instance, uint32_t token);
+
+/*
+ * Value of an entry of any kind as the nearest double.
+ */
+double NumberTable_Real(const NumberTable_t *instance, const NumberTable_Entry_t *entry);
+
+/*
+ * Write the significant digits of a Big entry, like snprintf.
+ *
+ * @param buffer - where the digits go, can be NULL if size is 0
+ * @return - number of digits, not counting the terminating null
+ */
+size_t NumberTable_Digits(const NumberTable_t *instance, const NumberTable_Entry_t *entry, char *buffer, size_t size);
+
+#endif
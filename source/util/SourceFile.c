@@ -0,0 +1,107 @@
+/***
+ * File: SourceFile.c
+ */
+
+#include <stdlib.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "SourceFile.h"
+
+#define SOURCEFILE_INITIAL_READ_SIZE (64 * 1024)
+
+static bool Map(SourceFile_t *instance, int fd, size_t length)
+{
+   void *data = mmap(NULL, length, PROT_READ, MAP_PRIVATE, fd, 0);
+   if(data == MAP_FAILED)
+   {
+      return false;
+   }
+
+   madvise(data, length, MADV_SEQUENTIAL);
+   instance->data = data;
+   instance->length = length;
+   instance->mapped = true;
+   return true;
+}
+
+static bool ReadAll(SourceFile_t *instance, int fd)
+{
+   char *storage = NULL;
+   ssize_t got;
+
+   do
+   {
+      if(instance->length == instance->allocatedSize)
+      {
+         size_t newSize = (instance->allocatedSize == 0) ? SOURCEFILE_INITIAL_READ_SIZE : instance->allocatedSize * 2;
+         char *grown = realloc(storage, newSize);
+         if(grown == NULL)
+         {
+            free(storage);
+            errno = ENOMEM;
+            return false;
+         }
+
+         storage = grown;
+         instance->allocatedSize = newSize;
+      }
+
+      got = read(fd, storage + instance->length, instance->allocatedSize - instance->length);
+      if(got < 0 && errno != EINTR)
+      {
+         free(storage);
+         return false;
+      }
+
+      instance->length += (got > 0) ? got : 0;
+   } while(got != 0);
+
+   instance->data = storage;
+   return true;
+}
+
+bool SourceFile_Open(SourceFile_t *instance, const char *path)
+{
+   struct stat info;
+   int fd = (path == NULL) ? STDIN_FILENO : open(path, O_RDONLY);
+   bool opened;
+
+   instance->data = NULL;
+   instance->length = 0;
+   instance->mapped = false;
+   instance->allocatedSize = 0;
+
+   if(fd < 0)
+   {
+      return false;
+   }
+
+   // Empty files can't be mapped, and pipes/terminals have no size to map
+   opened = (fstat(fd, &info) == 0 && S_ISREG(info.st_mode) && info.st_size > 0 && Map(instance, fd, info.st_size))
+            || ReadAll(instance, fd);
+
+   if(path != NULL)
+   {
+      close(fd);
+   }
+
+   return opened;
+}
+
+void SourceFile_Close(SourceFile_t *instance)
+{
+   if(instance->mapped)
+   {
+      munmap((void *)instance->data, instance->length);
+   }
+   else
+   {
+      free((void *)instance->data);
+   }
+
+   instance->data = NULL;
+   instance->length = 0;
+}
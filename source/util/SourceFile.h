@@ -0,0 +1,38 @@
+/***
+ * File: SourceFile.h
+ * Desc: Whole source file held in memory, mapped when possible and read into a
+ *       growable buffer otherwise (stdin, pipes).
+ */
+
+#ifndef _SOURCEFILE_H
+#define _SOURCEFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct
+{
+   const char *data;
+   size_t length;
+
+   bool mapped;
+   size_t allocatedSize;
+} SourceFile_t;
+
+/*
+ * Open a source file and make its whole contents available in data/length.
+ *
+ * @param path - file to open, or NULL to read stdin until end of file
+ * @return - false if the file couldn't be opened or read (errno is set)
+ * @post - data is not null-terminated; lex it with Lexer_LexSpan
+ * @post - data stays valid until SourceFile_Close, so tokens lexed from it
+ *          can point straight into it
+ */
+bool SourceFile_Open(SourceFile_t *instance, const char *path);
+
+/*
+ * Release the contents of a source file opened with SourceFile_Open.
+ */
+void SourceFile_Close(SourceFile_t *instance);
+
+#endif
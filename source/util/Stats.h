@@ -0,0 +1,42 @@
+/***
+ * File: Stats.h
+ * Desc: Helpers for instrumentation counters, which only exist when built with
+ *       PARSER_STATS defined (make STATS=1). Otherwise they compile to nothing.
+ */
+
+#ifndef _STATS_H
+#define _STATS_H
+
+#ifdef PARSER_STATS
+
+#include <stdint.h>
+#include <time.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+// Statement that is only compiled in with PARSER_STATS
+#define STATS(statement) statement
+
+/*
+ * Timestamp for measuring short spans of time: CPU cycles where there's a
+ * cycle counter, nanoseconds otherwise.
+ */
+static inline uint64_t Stats_Ticks(void)
+{
+#if defined(__x86_64__) || defined(__i386__)
+   return __rdtsc();
+#else
+   struct timespec now;
+   clock_gettime(CLOCK_MONOTONIC, &now);
+   return (uint64_t)now.tv_sec * 1000000000u + now.tv_nsec;
+#endif
+}
+
+#else
+
+#define STATS(statement)
+
+#endif
+
+#endif
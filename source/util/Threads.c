@@ -0,0 +1,52 @@
+/***
+ * File: Threads.c
+ */
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <pthread.h>
+#include <unistd.h>
+#include "Threads.h"
+
+typedef struct
+{
+   pthread_t thread;
+   bool started;     // thread was created, and has to be joined
+} Threads_Slot_t;
+
+size_t Threads_DefaultCount(void)
+{
+   long online = sysconf(_SC_NPROCESSORS_ONLN);
+   return (online > 0) ? (size_t)online : 1;
+}
+
+void Threads_RunAll(void *items, size_t count, size_t itemSize, void *(*work)(void *))
+{
+   uint8_t *item = items;
+   Threads_Slot_t *slots;
+
+   if(count == 0)
+   {
+      return;
+   }
+
+   slots = malloc(count * sizeof(Threads_Slot_t));
+   for(size_t k = 1; k < count; k++)
+   {
+      slots[k].started = (pthread_create(&slots[k].thread, NULL, work, &item[k * itemSize]) == 0);
+   }
+   work(&item[0]);
+   for(size_t k = 1; k < count; k++)
+   {
+      if(slots[k].started)
+      {
+         pthread_join(slots[k].thread, NULL);
+      }
+      else
+      {
+         work(&item[k * itemSize]);
+      }
+   }
+
+   free(slots);
+}
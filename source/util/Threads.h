@@ -0,0 +1,28 @@
+/***
+ * File: Threads.h
+ * Desc: Runs one piece of work per item of an array on threads of its own,
+ *       falling back to the calling thread for any thread that can't be made.
+ */
+
+#ifndef _THREADS_H
+#define _THREADS_H
+
+#include <stddef.h>
+
+/*
+ * Number of threads to use when none is given: one per online CPU.
+ *
+ * @return - at least 1
+ */
+size_t Threads_DefaultCount(void);
+
+/*
+ * Run work on every item and wait for all of them. The first item is run on
+ * the calling thread and the rest on threads of their own; items whose thread
+ * couldn't be created are run on the calling thread too, once the first is done.
+ *
+ * @param items - count items of itemSize bytes each; work is given a pointer to one
+ */
+void Threads_RunAll(void *items, size_t count, size_t itemSize, void *(*work)(void *));
+
+#endif
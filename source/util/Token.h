@@ -41,7 +41,9 @@ enum
    Token_Type_Pound,
    Token_Type_Slash,
    Token_Type_SquareBrace_Left,
-   Token_Type_SquareBrace_Right
+   Token_Type_SquareBrace_Right,
+
+   Token_Type_Count
 };
 typedef uint8_t Token_Type_t;
 
@@ -0,0 +1,446 @@
+/***
+ * File: TokenFile.c
+ *
+ * Numbers are put together a byte at a time on both sides, so files move
+ * between machines of either byte order and the mapped file needs no alignment.
+ * The reader checks every position and length it decodes against the file and
+ * the source, so a damaged file ends the walk early instead of pointing tokens
+ * outside the source.
+ */
+
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "TokenFile.h"
+#include "Hash.h"
+#include "util.h"
+
+#define TOKENFILE_MAGIC ("TOKF")
+#define TOKENFILE_HEADER_SIZE (64)
+#define TOKENFILE_INDEX_ENTRY_SIZE (24)
+#define TOKENFILE_TYPE_BITS (5)
+#define TOKENFILE_LINE_ESCAPE (7)         // Line step that means the real one follows
+#define TOKENFILE_MAX_TOKEN_SIZE (1 + 3 * 10)
+
+/*********************************
+ * Encoding
+ *********************************/
+static void Put32(uint8_t *out, uint32_t value)
+{
+   for(int i = 0; i < 4; i++)
+   {
+      out[i] = (uint8_t)(value >> (8 * i));
+   }
+}
+
+static void Put64(uint8_t *out, uint64_t value)
+{
+   for(int i = 0; i < 8; i++)
+   {
+      out[i] = (uint8_t)(value >> (8 * i));
+   }
+}
+
+static uint32_t Get32(const uint8_t *in)
+{
+   uint32_t value = 0;
+
+   for(int i = 0; i < 4; i++)
+   {
+      value |= (uint32_t)in[i] << (8 * i);
+   }
+
+   return value;
+}
+
+static uint64_t Get64(const uint8_t *in)
+{
+   uint64_t value = 0;
+
+   for(int i = 0; i < 8; i++)
+   {
+      value |= (uint64_t)in[i] << (8 * i);
+   }
+
+   return value;
+}
+
+static uint64_t ZigZag(size_t step)
+{
+   int64_t value = (int64_t)step;
+   return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+static size_t UnZigZag(uint64_t value)
+{
+   return (size_t)((value >> 1) ^ (~(value & 1) + 1));
+}
+
+static uint8_t *PutVarint(uint8_t *out, uint64_t value)
+{
+   while(value >= 0x80)
+   {
+      *out++ = (uint8_t)value | 0x80;
+      value >>= 7;
+   }
+   *out++ = (uint8_t)value;
+
+   return out;
+}
+
+/*
+ * @return - false if the varint runs past end or is too long
+ */
+static bool GetVarint(const uint8_t **in, const uint8_t *end, uint64_t *value)
+{
+   const uint8_t *p = *in;
+   uint64_t result = 0;
+
+   for(int shift = 0; shift < 64 && p < end; shift += 7)
+   {
+      uint8_t byte = *p++;
+
+      result |= (uint64_t)(byte & 0x7F) << shift;
+      if(byte < 0x80)
+      {
+         *in = p;
+         *value = result;
+         return true;
+      }
+   }
+
+   return false;
+}
+
+/*********************************
+ * Writer
+ *********************************/
+static void AddIndexEntry(TokenFile_Writer_t *instance)
+{
+   uint8_t *entry;
+
+   if(instance->indexCount == instance->allocatedIndexCount)
+   {
+      instance->allocatedIndexCount = (instance->allocatedIndexCount + 1) * 3 / 2;
+      instance->index = realloc(instance->index, instance->allocatedIndexCount * TOKENFILE_INDEX_ENTRY_SIZE);
+   }
+
+   entry = &instance->index[instance->indexCount * TOKENFILE_INDEX_ENTRY_SIZE];
+   Put64(entry, instance->streamSize);
+   Put64(entry + 8, instance->end);
+   Put64(entry + 16, instance->line);
+   instance->indexCount++;
+}
+
+static void add(I_List_t *interface, void *item)
+{
+   REINTERPRET(instance, interface, TokenFile_Writer_t *);
+   const Token_t *token = item;
+   size_t offset = token->lexeme - instance->source;
+   size_t lineStep = token->line - instance->line;
+   uint8_t *out;
+
+   if(instance->count % TOKENFILE_INDEX_INTERVAL == 0)
+   {
+      AddIndexEntry(instance);
+   }
+
+   if(instance->allocatedStreamSize - instance->streamSize < TOKENFILE_MAX_TOKEN_SIZE)
+   {
+      instance->allocatedStreamSize = (instance->allocatedStreamSize + TOKENFILE_MAX_TOKEN_SIZE) * 3 / 2;
+      instance->stream = realloc(instance->stream, instance->allocatedStreamSize);
+   }
+
+   out = &instance->stream[instance->streamSize];
+   if(lineStep < TOKENFILE_LINE_ESCAPE)
+   {
+      *out++ = token->type | (uint8_t)(lineStep << TOKENFILE_TYPE_BITS);
+   }
+   else
+   {
+      *out++ = token->type | (TOKENFILE_LINE_ESCAPE << TOKENFILE_TYPE_BITS);
+      out = PutVarint(out, ZigZag(lineStep));
+   }
+   out = PutVarint(out, ZigZag(offset - instance->end));
+   out = PutVarint(out, token->length);
+
+   instance->streamSize = out - instance->stream;
+   instance->end = offset + token->length;
+   instance->line = token->line;
+   instance->count++;
+}
+
+void TokenFile_Writer_Init(TokenFile_Writer_t *instance, const char *source, size_t length)
+{
+   instance->interface.at = NULL;
+   instance->interface.set = NULL;
+   instance->interface.add = &add;
+
+   instance->source = source;
+   instance->sourceLength = length;
+   instance->count = 0;
+   instance->end = 0;
+   instance->line = 0;
+
+   instance->stream = NULL;
+   instance->streamSize = 0;
+   instance->allocatedStreamSize = 0;
+
+   instance->index = NULL;
+   instance->indexCount = 0;
+   instance->allocatedIndexCount = 0;
+}
+
+void TokenFile_Writer_Deinit(TokenFile_Writer_t *instance)
+{
+   free(instance->stream);
+   free(instance->index);
+}
+
+bool TokenFile_Writer_Save(TokenFile_Writer_t *instance, const char *path)
+{
+   uint8_t header[TOKENFILE_HEADER_SIZE] = { 0 };
+   FILE *file = fopen(path, "wb");
+   bool written;
+   int error;
+
+   if(file == NULL)
+   {
+      return false;
+   }
+
+   memcpy(header, TOKENFILE_MAGIC, 4);
+   Put32(&header[4], TOKENFILE_VERSION);
+   Put64(&header[8], Hash_Bytes(instance->source, instance->sourceLength, 0));
+   Put64(&header[16], instance->sourceLength);
+   Put64(&header[24], instance->count);
+   Put64(&header[32], instance->streamSize);
+   Put64(&header[40], instance->indexCount);
+   Put32(&header[48], TOKENFILE_INDEX_INTERVAL);
+
+   // With no tokens there's no stream or index to write, and nothing allocated for them
+   written = fwrite(header, sizeof(header), 1, file) == 1 &&
+             (instance->count == 0 ||
+              (fwrite(instance->stream, 1, instance->streamSize, file) == instance->streamSize &&
+               fwrite(instance->index, TOKENFILE_INDEX_ENTRY_SIZE, instance->indexCount, file) == instance->indexCount));
+   error = errno;
+
+   if(fclose(file) != 0)
+   {
+      return false;
+   }
+
+   errno = error;
+   return written;
+}
+
+/*********************************
+ * Reader
+ *********************************/
+static bool Check(TokenFile_t *instance, const char *source, size_t length)
+{
+   const uint8_t *data = (const uint8_t *)instance->file.data;
+   size_t size = instance->file.length;
+   uint64_t streamSize;
+   uint64_t indexCount;
+
+   if(size < TOKENFILE_HEADER_SIZE || memcmp(data, TOKENFILE_MAGIC, 4) != 0 || Get32(&data[4]) != TOKENFILE_VERSION)
+   {
+      errno = EINVAL;
+      return false;
+   }
+
+   streamSize = Get64(&data[32]);
+   indexCount = Get64(&data[40]);
+   size -= TOKENFILE_HEADER_SIZE;
+   if(streamSize > size || indexCount > (size - streamSize) / TOKENFILE_INDEX_ENTRY_SIZE || Get32(&data[48]) == 0)
+   {
+      errno = EINVAL;
+      return false;
+   }
+
+   if(Get64(&data[16]) != length || Get64(&data[8]) != Hash_Bytes(source, length, 0))
+   {
+      errno = ESTALE;
+      return false;
+   }
+
+   instance->source = source;
+   instance->sourceLength = length;
+   instance->count = Get64(&data[24]);
+   instance->stream = &data[TOKENFILE_HEADER_SIZE];
+   instance->streamSize = streamSize;
+   instance->index = &instance->stream[streamSize];
+   instance->indexCount = indexCount;
+   instance->indexInterval = Get32(&data[48]);
+   return true;
+}
+
+bool TokenFile_Open(TokenFile_t *instance, const char *path, const char *source, size_t length)
+{
+   if(!SourceFile_Open(&instance->file, path))
+   {
+      return false;
+   }
+
+   if(!Check(instance, source, length))
+   {
+      int error = errno;
+
+      SourceFile_Close(&instance->file);
+      errno = error;
+      return false;
+   }
+
+   return true;
+}
+
+void TokenFile_Close(TokenFile_t *instance)
+{
+   SourceFile_Close(&instance->file);
+}
+
+size_t TokenFile_Count(const TokenFile_t *instance)
+{
+   return instance->count;
+}
+
+void TokenFile_Begin(const TokenFile_t *instance, TokenFile_Cursor_t *cursor)
+{
+   (void)instance;
+
+   cursor->index = 0;
+   cursor->position = 0;
+   cursor->end = 0;
+   cursor->line = 0;
+}
+
+// Put the cursor where an index entry says, or at the end if the entry is damaged
+static void JumpTo(const TokenFile_t *instance, TokenFile_Cursor_t *cursor, size_t entry)
+{
+   const uint8_t *data = &instance->index[entry * TOKENFILE_INDEX_ENTRY_SIZE];
+
+   cursor->index = entry * instance->indexInterval;
+   cursor->position = Get64(data);
+   cursor->end = Get64(data + 8);
+   cursor->line = Get64(data + 16);
+
+   if(cursor->position > instance->streamSize || cursor->index > instance->count)
+   {
+      cursor->index = instance->count;
+   }
+}
+
+void TokenFile_SeekToken(const TokenFile_t *instance, TokenFile_Cursor_t *cursor, size_t index)
+{
+   size_t entry = index / instance->indexInterval;
+   Token_t token;
+
+   if(index >= instance->count)
+   {
+      cursor->index = instance->count;
+      return;
+   }
+
+   if(instance->indexCount == 0)
+   {
+      TokenFile_Begin(instance, cursor);
+   }
+   else
+   {
+      JumpTo(instance, cursor, (entry < instance->indexCount) ? entry : instance->indexCount - 1);
+   }
+
+   while(cursor->index < index && TokenFile_Next(instance, cursor, &token))
+   {
+   }
+}
+
+void TokenFile_SeekLine(const TokenFile_t *instance, TokenFile_Cursor_t *cursor, size_t line)
+{
+   size_t low = 0;
+   size_t high = instance->indexCount;
+   TokenFile_Cursor_t before;
+   Token_t token;
+
+   // The last entry whose token before is on an earlier line; nothing before it can be on line
+   while(low < high)
+   {
+      size_t middle = low + (high - low) / 2;
+
+      if(Get64(&instance->index[middle * TOKENFILE_INDEX_ENTRY_SIZE + 16]) < line)
+      {
+         low = middle + 1;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   if(low == 0)
+   {
+      TokenFile_Begin(instance, cursor);
+   }
+   else
+   {
+      JumpTo(instance, cursor, low - 1);
+   }
+
+   do
+   {
+      before = *cursor;
+   } while(TokenFile_Next(instance, cursor, &token) && token.line < line);
+
+   *cursor = before;
+}
+
+bool TokenFile_Next(const TokenFile_t *instance, TokenFile_Cursor_t *cursor, Token_t *token)
+{
+   const uint8_t *in = &instance->stream[cursor->position];
+   const uint8_t *end = &instance->stream[instance->streamSize];
+   uint64_t lineStep;
+   uint64_t gap;
+   uint64_t length;
+   size_t offset;
+   uint8_t first;
+
+   if(cursor->index >= instance->count || in >= end)
+   {
+      return false;
+   }
+
+   first = *in++;
+   lineStep = first >> TOKENFILE_TYPE_BITS;
+   if(lineStep == TOKENFILE_LINE_ESCAPE)
+   {
+      if(!GetVarint(&in, end, &lineStep))
+      {
+         return false;
+      }
+      lineStep = UnZigZag(lineStep);
+   }
+
+   if(!GetVarint(&in, end, &gap) || !GetVarint(&in, end, &length))
+   {
+      return false;
+   }
+
+   offset = cursor->end + UnZigZag(gap);
+   if((first & ((1 << TOKENFILE_TYPE_BITS) - 1)) >= Token_Type_Count || offset > instance->sourceLength || length > instance->sourceLength - offset)
+   {
+      return false;
+   }
+
+   token->type = first & ((1 << TOKENFILE_TYPE_BITS) - 1);
+   token->lexeme = instance->source + offset;
+   token->length = length;
+   token->line = cursor->line + lineStep;
+
+   cursor->index++;
+   cursor->position = in - instance->stream;
+   cursor->end = offset + length;
+   cursor->line = token->line;
+   return true;
+}
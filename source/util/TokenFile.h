@@ -0,0 +1,148 @@
+/***
+ * File: TokenFile.h
+ * Desc: Tokens of a source saved to a file, so a later stage can read them
+ *       back instead of lexing again. The file is mapped and tokens are
+ *       decoded one at a time as they're walked; nothing is loaded up front.
+ *
+ *       Format (version 1, every number little-endian):
+ *
+ *          header   64 bytes: "TOKF", version (u32), hash of the source (u64,
+ *                   Hash_Bytes with seed 0), source length (u64), token count
+ *                   (u64), stream size (u64), index entry count (u64), index
+ *                   interval (u32), zeros to 64
+ *          stream   each token in order as
+ *                      type | line step << 5     one byte; a step of 7 means
+ *                      [line step]               the step follows as a varint
+ *                      gap                       zigzag varint from the end of
+ *                                                the token before
+ *                      length                    varint
+ *          index    for every interval-th token: its position in the stream,
+ *                   the end of the token before it and its line (u64 each)
+ *
+ *       Varints are LEB128. Most tokens take three bytes.
+ */
+
+#ifndef _TOKENFILE_H
+#define _TOKENFILE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "I_List.h"
+#include "SourceFile.h"
+#include "Token.h"
+
+#define TOKENFILE_VERSION (1)
+#define TOKENFILE_INDEX_INTERVAL (256)    // Tokens between index entries the writer makes
+
+typedef struct
+{
+   I_List_t interface;
+
+   const char *source;
+   size_t sourceLength;
+   size_t count;
+
+   // The token before the next one, for the deltas
+   size_t end;
+   size_t line;
+
+   uint8_t *stream;
+   size_t streamSize;
+   size_t allocatedStreamSize;
+
+   uint8_t *index;            // As it goes in the file
+   size_t indexCount;
+   size_t allocatedIndexCount;
+} TokenFile_Writer_t;
+
+typedef struct
+{
+   SourceFile_t file;
+
+   const char *source;
+   size_t sourceLength;
+   size_t count;
+
+   const uint8_t *stream;
+   size_t streamSize;
+   const uint8_t *index;
+   size_t indexCount;
+   size_t indexInterval;
+} TokenFile_t;
+
+typedef struct
+{
+   size_t index;
+   size_t position;           // In the stream
+   size_t end;
+   size_t line;
+} TokenFile_Cursor_t;
+
+/*
+ * Initialize a TokenFile_Writer. Only List_Add works on it, so it can be
+ * lexed into directly but not read back.
+ *
+ * @param source - every token's lexeme must point into source
+ */
+void TokenFile_Writer_Init(TokenFile_Writer_t *instance, const char *source, size_t length);
+
+/*
+ * Deinitialize a TokenFile_Writer.
+ */
+void TokenFile_Writer_Deinit(TokenFile_Writer_t *instance);
+
+/*
+ * Write the tokens added so far to a file, replacing it.
+ *
+ * @return - false if the file couldn't be written (errno is set)
+ */
+bool TokenFile_Writer_Save(TokenFile_Writer_t *instance, const char *path);
+
+/*
+ * Map a token file written for a source.
+ *
+ * @param source - the source it was written for; must outlive the TokenFile
+ * @return - false if the file couldn't be opened (errno is set), isn't a token
+ *           file of this version (EINVAL), or is for other contents (ESTALE)
+ */
+bool TokenFile_Open(TokenFile_t *instance, const char *path, const char *source, size_t length);
+
+/*
+ * Unmap a token file opened with TokenFile_Open.
+ */
+void TokenFile_Close(TokenFile_t *instance);
+
+/*
+ * Number of tokens in the file.
+ */
+size_t TokenFile_Count(const TokenFile_t *instance);
+
+/*
+ * Start walking the file from its first token.
+ */
+void TokenFile_Begin(const TokenFile_t *instance, TokenFile_Cursor_t *cursor);
+
+/*
+ * Move the cursor to a token, decoding at most an index interval of tokens.
+ *
+ * @param index - past the last token leaves the cursor at the end
+ */
+void TokenFile_SeekToken(const TokenFile_t *instance, TokenFile_Cursor_t *cursor, size_t index);
+
+/*
+ * Move the cursor to the first token on or after a line.
+ *
+ * @pre - the tokens were added to the writer in line order
+ */
+void TokenFile_SeekLine(const TokenFile_t *instance, TokenFile_Cursor_t *cursor, size_t line);
+
+/*
+ * Decode the token the cursor is at and move the cursor past it.
+ *
+ * @return - false once there are no tokens left, or if the rest of the file is
+ *           damaged (token is left alone)
+ */
+bool TokenFile_Next(const TokenFile_t *instance, TokenFile_Cursor_t *cursor, Token_t *token);
+
+#endif
@@ -0,0 +1,71 @@
+/***
+ * File: TokenList.c
+ */
+#include <stdlib.h>
+#include "TokenList.h"
+#include "util.h"
+
+static void set(I_List_t *interface, size_t index, void *item)
+{
+   REINTERPRET(instance, interface, TokenList_t *);
+
+   if(index >= instance->count)
+   {
+      TokenList_Reserve(instance, index + 1);
+      instance->count = index + 1;
+   }
+
+   instance->tokens[index] = *(const Token_t *)item;
+}
+
+static void add(I_List_t *interface, void *item)
+{
+   REINTERPRET(instance, interface, TokenList_t *);
+   TokenList_Add(instance, item);
+}
+
+static void at(I_List_t *interface, size_t index, void **item)
+{
+   REINTERPRET(instance, interface, TokenList_t *);
+   *item = (index < instance->count) ? &instance->tokens[index] : NULL;
+}
+
+void TokenList_Init(TokenList_t *instance)
+{
+   instance->interface.at = &at;
+   instance->interface.set = &set;
+   instance->interface.add = &add;
+
+   instance->tokens = NULL;
+   instance->count = 0;
+   instance->allocatedCount = 0;
+}
+
+void TokenList_Deinit(TokenList_t *instance)
+{
+   free(instance->tokens);
+}
+
+void TokenList_Clear(TokenList_t *instance)
+{
+   instance->count = 0;
+}
+
+void TokenList_Reserve(TokenList_t *instance, size_t count)
+{
+   if(instance->allocatedCount >= count)
+   {
+      return;
+   }
+
+   while(instance->allocatedCount < count)
+   {
+      instance->allocatedCount = (instance->allocatedCount + 1) * 3 / 2;
+   }
+   instance->tokens = realloc(instance->tokens, instance->allocatedCount * sizeof(Token_t));
+}
+
+TokenList_t *TokenList_Of(I_List_t *interface)
+{
+   return (interface != NULL && interface->add == &add) ? (TokenList_t *)interface : NULL;
+}
@@ -0,0 +1,76 @@
+/***
+ * File: TokenList.h
+ * Desc: Implements list interface for an array of Token_t. Code that knows it
+ *       has a TokenList can add tokens with the inline functions here, which
+ *       copy a Token_t of known size instead of calling through the interface
+ *       and copying itemSize bytes. Lexers check for one with TokenList_Of.
+ */
+
+#ifndef _TOKENLIST_H
+#define _TOKENLIST_H
+
+#include "I_List.h"
+#include "Token.h"
+
+typedef struct
+{
+   I_List_t interface;
+
+   Token_t *tokens;
+   size_t count;
+   size_t allocatedCount;
+} TokenList_t;
+
+/*
+ * Initialize a TokenList.
+ */
+void TokenList_Init(TokenList_t *instance);
+
+/*
+ * Deinitialize a TokenList.
+ */
+void TokenList_Deinit(TokenList_t *instance);
+
+/*
+ * Empty the list but keep its memory to fill again.
+ */
+void TokenList_Clear(TokenList_t *instance);
+
+/*
+ * Make room for at least count tokens.
+ *
+ * @post Pointers to tokens from before may be invalid.
+ */
+void TokenList_Reserve(TokenList_t *instance, size_t count);
+
+/*
+ * The TokenList behind a list interface.
+ *
+ * @return - NULL if the interface isn't a TokenList's
+ */
+TokenList_t *TokenList_Of(I_List_t *interface);
+
+/*
+ * Add an uninitialized token to the end of the list, to be filled in place.
+ *
+ * @return - the new token, valid until the list next grows
+ */
+static inline Token_t *TokenList_Emplace(TokenList_t *instance)
+{
+   if(instance->count == instance->allocatedCount)
+   {
+      TokenList_Reserve(instance, instance->count + 1);
+   }
+
+   return &instance->tokens[instance->count++];
+}
+
+/*
+ * Add a copy of a token to the end of the list.
+ */
+static inline void TokenList_Add(TokenList_t *instance, const Token_t *token)
+{
+   *TokenList_Emplace(instance) = *token;
+}
+
+#endif
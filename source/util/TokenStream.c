@@ -0,0 +1,333 @@
+/***
+ * File: TokenStream.c
+ */
+#include <stdlib.h>
+#include <string.h>
+#include "TokenStream.h"
+#include "util.h"
+
+static void GrowTokens(TokenStream_t *instance, size_t minNewSize)
+{
+   while(instance->allocatedCount < minNewSize)
+   {
+      instance->allocatedCount = (instance->allocatedCount + 1) * 3 / 2;
+   }
+
+   instance->types = realloc(instance->types, instance->allocatedCount * sizeof(uint8_t));
+   instance->offsets = realloc(instance->offsets, instance->allocatedCount * sizeof(uint32_t));
+   instance->lengths = realloc(instance->lengths, instance->allocatedCount * sizeof(uint16_t));
+}
+
+/*
+ * Make room for one more entry in a side table.
+ */
+static void *GrowTable(void *table, size_t *allocatedCount, size_t count, size_t entrySize)
+{
+   if(count == *allocatedCount)
+   {
+      *allocatedCount = (*allocatedCount + 1) * 3 / 2;
+      table = realloc(table, *allocatedCount * entrySize);
+   }
+
+   return table;
+}
+
+/*********************************
+ * Lengths of 64KB or more
+ *********************************/
+// Index of the first long length whose token index is >= index
+static size_t FindLongLength(const TokenStream_t *instance, size_t index)
+{
+   size_t low = 0;
+   size_t high = instance->longLengthCount;
+
+   while(low < high)
+   {
+      size_t middle = low + (high - low) / 2;
+
+      if(instance->longLengths[middle].index < index)
+      {
+         low = middle + 1;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   return low;
+}
+
+static void SetLength(TokenStream_t *instance, size_t index, size_t length)
+{
+   size_t at;
+
+   if(length < TOKENSTREAM_LONG_LENGTH)
+   {
+      instance->lengths[index] = (uint16_t)length;
+      return;
+   }
+
+   instance->lengths[index] = TOKENSTREAM_LONG_LENGTH;
+
+   at = FindLongLength(instance, index);
+   if(at == instance->longLengthCount || instance->longLengths[at].index != index)
+   {
+      instance->longLengths = GrowTable(instance->longLengths, &instance->allocatedLongLengthCount, instance->longLengthCount, sizeof(TokenStream_LongLength_t));
+      memmove(&instance->longLengths[at + 1], &instance->longLengths[at], (instance->longLengthCount - at) * sizeof(TokenStream_LongLength_t));
+      instance->longLengthCount++;
+   }
+
+   instance->longLengths[at].index = index;
+   instance->longLengths[at].length = length;
+}
+
+static size_t GetLength(const TokenStream_t *instance, size_t index)
+{
+   if(instance->lengths[index] != TOKENSTREAM_LONG_LENGTH)
+   {
+      return instance->lengths[index];
+   }
+
+   return instance->longLengths[FindLongLength(instance, index)].length;
+}
+
+/*********************************
+ * Line runs
+ *********************************/
+// Index of the line run holding the token at index
+static size_t FindLineRun(const TokenStream_t *instance, size_t index)
+{
+   size_t low = 0;
+   size_t high = instance->lineRunCount;
+
+   while(high - low > 1)
+   {
+      size_t middle = low + (high - low) / 2;
+
+      if(instance->lineRuns[middle].first <= index)
+      {
+         low = middle;
+      }
+      else
+      {
+         high = middle;
+      }
+   }
+
+   return low;
+}
+
+static void AppendLine(TokenStream_t *instance, size_t index, size_t line)
+{
+   if(instance->lineRunCount > 0 && instance->lineRuns[instance->lineRunCount - 1].line == line)
+   {
+      return;
+   }
+
+   instance->lineRuns = GrowTable(instance->lineRuns, &instance->allocatedLineRunCount, instance->lineRunCount, sizeof(TokenStream_LineRun_t));
+   instance->lineRuns[instance->lineRunCount].first = index;
+   instance->lineRuns[instance->lineRunCount].line = line;
+   instance->lineRunCount++;
+}
+
+/*
+ * Change the line of a token already in the stream, splitting the run it was
+ * in and merging runs that end up next to one on the same line.
+ */
+static void ChangeLine(TokenStream_t *instance, size_t index, size_t line)
+{
+   size_t run = FindLineRun(instance, index);
+   TokenStream_LineRun_t old = instance->lineRuns[run];
+   size_t end = (run + 1 < instance->lineRunCount) ? instance->lineRuns[run + 1].first : instance->count;
+   TokenStream_LineRun_t pieces[3];
+   size_t pieceCount = 0;
+   size_t kept = 0;
+
+   if(old.line == line)
+   {
+      return;
+   }
+
+   if(index > old.first)
+   {
+      pieces[pieceCount++] = old;
+   }
+   pieces[pieceCount].first = index;
+   pieces[pieceCount++].line = line;
+   if(index + 1 < end)
+   {
+      pieces[pieceCount].first = index + 1;
+      pieces[pieceCount++].line = old.line;
+   }
+
+   for(size_t i = 1; i < pieceCount; i++)
+   {
+      instance->lineRuns = GrowTable(instance->lineRuns, &instance->allocatedLineRunCount, instance->lineRunCount, sizeof(TokenStream_LineRun_t));
+      instance->lineRunCount++;
+   }
+   memmove(&instance->lineRuns[run + pieceCount], &instance->lineRuns[run + 1], (instance->lineRunCount - run - pieceCount) * sizeof(TokenStream_LineRun_t));
+   memcpy(&instance->lineRuns[run], pieces, pieceCount * sizeof(TokenStream_LineRun_t));
+
+   for(size_t i = 0; i < instance->lineRunCount; i++)
+   {
+      if(kept == 0 || instance->lineRuns[kept - 1].line != instance->lineRuns[i].line)
+      {
+         instance->lineRuns[kept++] = instance->lineRuns[i];
+      }
+   }
+   instance->lineRunCount = kept;
+}
+
+/*********************************
+ * List interface
+ *********************************/
+static void Store(TokenStream_t *instance, size_t index, const Token_t *token)
+{
+   instance->types[index] = token->type;
+   instance->offsets[index] = (uint32_t)(token->lexeme - instance->source);
+   SetLength(instance, index, token->length);
+}
+
+static void set(I_List_t *interface, size_t index, void *item)
+{
+   REINTERPRET(instance, interface, TokenStream_t *);
+   REINTERPRET(token, item, Token_t *);
+
+   if(index < instance->count)
+   {
+      Store(instance, index, token);
+      ChangeLine(instance, index, token->line);
+      return;
+   }
+
+   if(index >= instance->allocatedCount)
+   {
+      GrowTokens(instance, index + 1);
+   }
+
+   // Tokens skipped over read as unused tokens at the start of the source on line 0
+   if(index > instance->count)
+   {
+      memset(&instance->types[instance->count], 0, (index - instance->count) * sizeof(uint8_t));
+      memset(&instance->offsets[instance->count], 0, (index - instance->count) * sizeof(uint32_t));
+      memset(&instance->lengths[instance->count], 0, (index - instance->count) * sizeof(uint16_t));
+      AppendLine(instance, instance->count, 0);
+   }
+
+   Store(instance, index, token);
+   AppendLine(instance, index, token->line);
+   instance->count = index + 1;
+}
+
+static void add(I_List_t *interface, void *item)
+{
+   REINTERPRET(instance, interface, TokenStream_t *);
+   REINTERPRET(token, item, Token_t *);
+
+   if(instance->count == instance->allocatedCount)
+   {
+      GrowTokens(instance, instance->count + 1);
+   }
+
+   Store(instance, instance->count, token);
+   AppendLine(instance, instance->count, token->line);
+   instance->count++;
+}
+
+static void at(I_List_t *interface, size_t index, void **item)
+{
+   REINTERPRET(instance, interface, TokenStream_t *);
+
+   *item = TokenStream_Get(instance, index, &instance->scratch) ? &instance->scratch : NULL;
+}
+
+void TokenStream_Init(TokenStream_t *instance, const char *source)
+{
+   instance->interface.at = &at;
+   instance->interface.set = &set;
+   instance->interface.add = &add;
+
+   instance->source = source;
+
+   instance->types = NULL;
+   instance->offsets = NULL;
+   instance->lengths = NULL;
+   instance->count = 0;
+   instance->allocatedCount = 0;
+
+   instance->longLengths = NULL;
+   instance->longLengthCount = 0;
+   instance->allocatedLongLengthCount = 0;
+
+   instance->lineRuns = NULL;
+   instance->lineRunCount = 0;
+   instance->allocatedLineRunCount = 0;
+}
+
+void TokenStream_Deinit(TokenStream_t *instance)
+{
+   free(instance->types);
+   free(instance->offsets);
+   free(instance->lengths);
+   free(instance->longLengths);
+   free(instance->lineRuns);
+}
+
+/*********************************
+ * Walking the stream
+ *********************************/
+size_t TokenStream_Count(const TokenStream_t *instance)
+{
+   return instance->count;
+}
+
+Token_Type_t TokenStream_Type(const TokenStream_t *instance, size_t index)
+{
+   return (index < instance->count) ? instance->types[index] : Token_Type_Unused;
+}
+
+bool TokenStream_Get(const TokenStream_t *instance, size_t index, Token_t *token)
+{
+   if(index >= instance->count)
+   {
+      return false;
+   }
+
+   token->type = instance->types[index];
+   token->lexeme = instance->source + instance->offsets[index];
+   token->length = GetLength(instance, index);
+   token->line = instance->lineRuns[FindLineRun(instance, index)].line;
+   return true;
+}
+
+void TokenStream_Begin(const TokenStream_t *instance, TokenStream_Cursor_t *cursor)
+{
+   (void)instance;
+
+   cursor->index = 0;
+   cursor->lineRun = 0;
+}
+
+bool TokenStream_Next(const TokenStream_t *instance, TokenStream_Cursor_t *cursor, Token_t *token)
+{
+   size_t index = cursor->index;
+
+   if(index >= instance->count)
+   {
+      return false;
+   }
+
+   while(cursor->lineRun + 1 < instance->lineRunCount && instance->lineRuns[cursor->lineRun + 1].first <= index)
+   {
+      cursor->lineRun++;
+   }
+
+   token->type = instance->types[index];
+   token->lexeme = instance->source + instance->offsets[index];
+   token->length = GetLength(instance, index);
+   token->line = instance->lineRuns[cursor->lineRun].line;
+
+   cursor->index++;
+   return true;
+}
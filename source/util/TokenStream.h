@@ -0,0 +1,108 @@
+/***
+ * File: TokenStream.h
+ * Desc: Implements list interface for tokens as separate arrays of types,
+ *       32-bit offsets into the source and 16-bit lengths, with line numbers
+ *       kept only where they change. About a third of the memory of an array
+ *       of Token_t, and scanning just the types touches one byte per token.
+ */
+
+#ifndef _TOKENSTREAM_H
+#define _TOKENSTREAM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include "I_List.h"
+#include "Token.h"
+
+// Length stored for tokens whose real length is in the overflow table
+#define TOKENSTREAM_LONG_LENGTH (UINT16_MAX)
+
+typedef struct
+{
+   size_t index;
+   size_t length;
+} TokenStream_LongLength_t;
+
+typedef struct
+{
+   size_t first;     // Index of the first token on this line
+   size_t line;
+} TokenStream_LineRun_t;
+
+typedef struct
+{
+   I_List_t interface;
+
+   const char *source;
+
+   uint8_t *types;
+   uint32_t *offsets;
+   uint16_t *lengths;
+   size_t count;
+   size_t allocatedCount;
+
+   // Sorted by index
+   TokenStream_LongLength_t *longLengths;
+   size_t longLengthCount;
+   size_t allocatedLongLengthCount;
+
+   // Sorted by first, and no two neighbours have the same line
+   TokenStream_LineRun_t *lineRuns;
+   size_t lineRunCount;
+   size_t allocatedLineRunCount;
+
+   Token_t scratch;  // What List_At points to
+} TokenStream_t;
+
+typedef struct
+{
+   size_t index;
+   size_t lineRun;
+} TokenStream_Cursor_t;
+
+/*
+ * Initialize a TokenStream.
+ *
+ * @param source - every token's lexeme must point into source, and source must
+ *                 be shorter than 4GB
+ * @post List_At gives a pointer to a token built on demand, which stays valid
+ *       until the next List_At
+ */
+void TokenStream_Init(TokenStream_t *instance, const char *source);
+
+/*
+ * Deinitialize a TokenStream.
+ */
+void TokenStream_Deinit(TokenStream_t *instance);
+
+/*
+ * Number of tokens in the stream.
+ */
+size_t TokenStream_Count(const TokenStream_t *instance);
+
+/*
+ * Type of the token at index, or Token_Type_Unused if index is out of range.
+ */
+Token_Type_t TokenStream_Type(const TokenStream_t *instance, size_t index);
+
+/*
+ * Build the token at index.
+ *
+ * @return - false if index is out of range (token is left alone)
+ */
+bool TokenStream_Get(const TokenStream_t *instance, size_t index, Token_t *token);
+
+/*
+ * Start walking the stream from its first token.
+ */
+void TokenStream_Begin(const TokenStream_t *instance, TokenStream_Cursor_t *cursor);
+
+/*
+ * Build the token the cursor is at and move the cursor past it. Cheaper than
+ * TokenStream_Get for visiting every token in order.
+ *
+ * @return - false once there are no tokens left (token is left alone)
+ */
+bool TokenStream_Next(const TokenStream_t *instance, TokenStream_Cursor_t *cursor, Token_t *token);
+
+#endif
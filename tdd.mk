@@ -17,7 +17,14 @@ SRC_DIRS := \
 
 # Specific source files to build into library. Helpful when not all code in a directory can be built for test (hopefully a temporary situation)
 SRC_FILES := \
-	source/Lexer_StaticLookup.c
+	source/Lexer_StaticLookup.c \
+	source/Lexer_Parallel.c \
+	source/Lexer_Batch.c \
+	source/Lexer_Dfa.c \
+	source/Lexer_Incremental.c \
+	source/Lexer_Cache.c \
+	source/Parser.c \
+	source/Parser_Parallel.c
 
 # Directories containing unit test code build into the unit test runner
 TEST_SRC_DIRS := \
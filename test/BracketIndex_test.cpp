@@ -0,0 +1,108 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include "BracketIndex.h"
+   #include "Token.h"
+}
+
+TEST_GROUP(BracketIndex)
+{
+   BracketIndex_t index;
+
+   void setup()
+   {
+      BracketIndex_Init(&index);
+   }
+
+   void teardown()
+   {
+      BracketIndex_Deinit(&index);
+   }
+
+   void ThisEntryShouldBe(size_t entry, uint32_t open, uint32_t close, uint32_t depth)
+   {
+      CHECK_EQUAL(open, index.entries[entry].open);
+      CHECK_EQUAL(close, index.entries[entry].close);
+      CHECK_EQUAL(depth, index.entries[entry].depth);
+   }
+};
+
+TEST(BracketIndex, EmptyIndexHasNothingOpen)
+{
+   CHECK_EQUAL(0, index.count);
+   POINTERS_EQUAL(NULL, BracketIndex_Top(&index));
+   CHECK_FALSE(BracketIndex_IsOpen(&index, Token_Type_Paren_Left));
+}
+
+TEST(BracketIndex, ClosingMatchesTheInnermostOpener)
+{
+   BracketIndex_Open(&index, 0, Token_Type_CurlyBrace_Left, 0, 1);
+   BracketIndex_Open(&index, 2, Token_Type_Paren_Left, 5, 1);
+   BracketIndex_Close(&index, 4);
+   BracketIndex_Close(&index, 9);
+
+   CHECK_EQUAL(2, index.count);
+   ThisEntryShouldBe(0, 0, 9, 0);
+   ThisEntryShouldBe(1, 2, 4, 1);
+   POINTERS_EQUAL(NULL, BracketIndex_Top(&index));
+}
+
+TEST(BracketIndex, TopIsTheInnermostPendingBracket)
+{
+   BracketIndex_Open(&index, 3, Token_Type_SquareBrace_Left, 7, 2);
+   BracketIndex_Open(&index, 5, Token_Type_Paren_Left, 12, 3);
+
+   CHECK_EQUAL(1, BracketIndex_Top(&index)->entry);
+   CHECK_EQUAL(Token_Type_Paren_Left, BracketIndex_Top(&index)->type);
+   CHECK_EQUAL(12, BracketIndex_Top(&index)->offset);
+   CHECK_EQUAL(3, BracketIndex_Top(&index)->line);
+}
+
+TEST(BracketIndex, KnowsWhichTypesAreOpen)
+{
+   BracketIndex_Open(&index, 0, Token_Type_SquareBrace_Left, 0, 1);
+
+   CHECK_TRUE(BracketIndex_IsOpen(&index, Token_Type_SquareBrace_Left));
+   CHECK_FALSE(BracketIndex_IsOpen(&index, Token_Type_Paren_Left));
+   CHECK_FALSE(BracketIndex_IsOpen(&index, Token_Type_CurlyBrace_Left));
+
+   BracketIndex_Close(&index, 1);
+   CHECK_FALSE(BracketIndex_IsOpen(&index, Token_Type_SquareBrace_Left));
+}
+
+TEST(BracketIndex, AbandonedBracketsHaveNoCloser)
+{
+   BracketIndex_Open(&index, 0, Token_Type_Paren_Left, 0, 1);
+   BracketIndex_Open(&index, 1, Token_Type_SquareBrace_Left, 1, 1);
+   BracketIndex_Abandon(&index);
+   BracketIndex_Close(&index, 2);
+
+   ThisEntryShouldBe(0, 0, 2, 0);
+   ThisEntryShouldBe(1, 1, BRACKETINDEX_NONE, 1);
+}
+
+TEST(BracketIndex, FindsTheEntryOfAnOpener)
+{
+   for(uint32_t i = 0; i < 100; i++)
+   {
+      BracketIndex_Open(&index, i * 3, Token_Type_Paren_Left, i * 3, 1);
+      BracketIndex_Close(&index, i * 3 + 1);
+   }
+
+   CHECK_EQUAL(100, index.count);
+   CHECK_EQUAL(121, BracketIndex_Find(&index, 120)->close);
+   CHECK_EQUAL(298, BracketIndex_Find(&index, 297)->close);
+   POINTERS_EQUAL(NULL, BracketIndex_Find(&index, 121));
+   POINTERS_EQUAL(NULL, BracketIndex_Find(&index, 1000));
+}
+
+TEST(BracketIndex, ClearForgetsEverything)
+{
+   BracketIndex_Open(&index, 0, Token_Type_CurlyBrace_Left, 0, 1);
+   BracketIndex_Clear(&index);
+
+   CHECK_EQUAL(0, index.count);
+   POINTERS_EQUAL(NULL, BracketIndex_Top(&index));
+   CHECK_FALSE(BracketIndex_IsOpen(&index, Token_Type_CurlyBrace_Left));
+}
@@ -0,0 +1,50 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <ctype.h>
+   #include <string.h>
+   #include "CharClass.h"
+}
+
+TEST_GROUP(CharClass)
+{
+   void OnlyTheseShouldBeIn(CharClass_t charClass, const char *members)
+   {
+      for(int c = 1; c < 256; c++)
+      {
+         CHECK_EQUAL(strchr(members, c) != NULL, CharClass_Is((char)c, charClass));
+      }
+      CHECK_FALSE(CharClass_Is('\0', charClass));
+   }
+};
+
+TEST(CharClass, IdentifierCharactersFollowTheSyntaxRules)
+{
+   OnlyTheseShouldBeIn(CharClass_Identifier, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_-#!?");
+   OnlyTheseShouldBeIn(CharClass_Word, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ?");
+}
+
+TEST(CharClass, TouchyCharactersAreIdentifiersNumbersStringsAndSpacedSymbols)
+{
+   OnlyTheseShouldBeIn(CharClass_Touchy, "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ_-#!?0123456789\"@$+/*=<>~");
+}
+
+TEST(CharClass, MatchesCTypeInTheCLocale)
+{
+   for(int c = 0; c < 128; c++)
+   {
+      CHECK_EQUAL(isalpha(c) != 0, CharClass_Is((char)c, CharClass_Letter));
+      CHECK_EQUAL(isdigit(c) != 0, CharClass_Is((char)c, CharClass_Digit));
+      CHECK_EQUAL(isspace(c) != 0, CharClass_Is((char)c, CharClass_Space));
+      CHECK_EQUAL(iscntrl(c) != 0, CharClass_Is((char)c, CharClass_Control));
+   }
+}
+
+TEST(CharClass, NonAsciiIsInNoClass)
+{
+   for(int c = 128; c < 256; c++)
+   {
+      CHECK_EQUAL(0, charClassTable[c]);
+   }
+}
@@ -0,0 +1,228 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <stdlib.h>
+   #include <string.h>
+   #include "CharScan.h"
+}
+
+#define BUFFER_SIZE (192)
+
+TEST_GROUP(CharScan)
+{
+   char buffer[BUFFER_SIZE];
+   bool hasWordCharacter;
+
+   void setup()
+   {
+      memset(buffer, 0, BUFFER_SIZE);
+      hasWordCharacter = false;
+   }
+
+   // Fill the rest of the buffer with characters that would continue the run
+   const char *PlaceText(size_t offset, const char *text, size_t textLength, char filler)
+   {
+      hasWordCharacter = false;
+      memset(buffer, filler, BUFFER_SIZE);
+      memcpy(&buffer[offset], text, textLength);
+      return &buffer[offset] + textLength;
+   }
+
+   void teardown()
+   {
+      CharScan_Select(CharScan_Level_Avx2) || CharScan_Select(CharScan_Level_Sse2);
+   }
+
+   // Place text at every offset within a 32-byte block so each scanner sees every alignment,
+   // and make sure nothing past the end of the text is scanned
+   void EveryLevelAndAlignmentShouldScanIdentifier(const char *text, size_t expectedLength, bool expectedWord)
+   {
+      EveryLevelAndAlignmentShouldScanIdentifier(text, strlen(text), expectedLength, expectedWord);
+   }
+
+   void EveryLevelAndAlignmentShouldScanIdentifier(const char *text, size_t textLength, size_t expectedLength, bool expectedWord)
+   {
+      for(CharScan_Level_t level = CharScan_Level_Scalar; level <= CharScan_Level_Avx2; level++)
+      {
+         if(!CharScan_Select(level))
+         {
+            continue;
+         }
+
+         for(size_t offset = 0; offset < 32; offset++)
+         {
+            const char *end = PlaceText(offset, text, textLength, 'a');
+            CHECK_EQUAL(expectedLength, CharScan_Identifier(&buffer[offset], end, &hasWordCharacter));
+            CHECK_EQUAL(expectedWord, hasWordCharacter);
+         }
+      }
+   }
+
+   void EveryLevelAndAlignmentShouldScanDigits(const char *text, size_t expectedLength)
+   {
+      EveryLevelAndAlignmentShouldScanDigits(text, strlen(text), expectedLength);
+   }
+
+   void EveryLevelAndAlignmentShouldScanDigits(const char *text, size_t textLength, size_t expectedLength)
+   {
+      for(CharScan_Level_t level = CharScan_Level_Scalar; level <= CharScan_Level_Avx2; level++)
+      {
+         if(!CharScan_Select(level))
+         {
+            continue;
+         }
+
+         for(size_t offset = 0; offset < 32; offset++)
+         {
+            const char *end = PlaceText(offset, text, textLength, '7');
+            CHECK_EQUAL(expectedLength, CharScan_Digits(&buffer[offset], end));
+         }
+      }
+   }
+
+   void EveryLevelAndAlignmentShouldScanStringBody(const char *text, size_t expectedLength)
+   {
+      EveryLevelAndAlignmentShouldScanStringBody(text, strlen(text), expectedLength);
+   }
+
+   void EveryLevelAndAlignmentShouldScanStringBody(const char *text, size_t textLength, size_t expectedLength)
+   {
+      for(CharScan_Level_t level = CharScan_Level_Scalar; level <= CharScan_Level_Avx2; level++)
+      {
+         if(!CharScan_Select(level))
+         {
+            continue;
+         }
+
+         for(size_t offset = 0; offset < 32; offset++)
+         {
+            const char *end = PlaceText(offset, text, textLength, 'x');
+            CHECK_EQUAL(expectedLength, CharScan_StringBody(&buffer[offset], end));
+         }
+      }
+   }
+};
+
+TEST(CharScan, ScalarIsAlwaysAvailable)
+{
+   CHECK_TRUE(CharScan_Select(CharScan_Level_Scalar));
+}
+
+TEST(CharScan, EmptyStringHasNoIdentifier)
+{
+   EveryLevelAndAlignmentShouldScanIdentifier("", 0, false);
+}
+
+TEST(CharScan, IdentifierStopsAtFirstNonIdentifierCharacter)
+{
+   EveryLevelAndAlignmentShouldScanIdentifier("valid-identifier? x", 17, true);
+   EveryLevelAndAlignmentShouldScanIdentifier("#one#name#(", 10, true);
+   EveryLevelAndAlignmentShouldScanIdentifier("abc1", 3, true);
+   EveryLevelAndAlignmentShouldScanIdentifier("Z\x80", 1, true);
+   EveryLevelAndAlignmentShouldScanIdentifier("a\0b", 3, 1, true);
+}
+
+TEST(CharScan, IdentifierWithoutWordCharacterIsReported)
+{
+   EveryLevelAndAlignmentShouldScanIdentifier("--_-#!! ", 7, false);
+   EveryLevelAndAlignmentShouldScanIdentifier("____", 4, false);
+}
+
+TEST(CharScan, QuestionMarkCountsAsWordCharacter)
+{
+   EveryLevelAndAlignmentShouldScanIdentifier("________?", 9, true);
+}
+
+TEST(CharScan, CharactersNextToTheLetterRangeAreNotIdentifiers)
+{
+   EveryLevelAndAlignmentShouldScanIdentifier("@", 0, false);
+   EveryLevelAndAlignmentShouldScanIdentifier("[", 0, false);
+   EveryLevelAndAlignmentShouldScanIdentifier("`", 0, false);
+   EveryLevelAndAlignmentShouldScanIdentifier("{", 0, false);
+   EveryLevelAndAlignmentShouldScanIdentifier("\xC1", 0, false);
+}
+
+TEST(CharScan, LongIdentifierCrossesManyBlocks)
+{
+   const char *text =
+      "________________________________________________________________"
+      "______________________________________________________a__________;";
+
+   EveryLevelAndAlignmentShouldScanIdentifier(text, 129, true);
+}
+
+TEST(CharScan, WordCharacterAfterTheEndIsIgnored)
+{
+   EveryLevelAndAlignmentShouldScanIdentifier("___ a", 3, false);
+}
+
+TEST(CharScan, IdentifierStopsAtEndOfBuffer)
+{
+   EveryLevelAndAlignmentShouldScanIdentifier("--", 2, false);
+   EveryLevelAndAlignmentShouldScanIdentifier("abcdefghijklmnopqrstuvwxyzABCDEF", 32, true);
+   EveryLevelAndAlignmentShouldScanIdentifier("________________________________________", 40, false);
+}
+
+TEST(CharScan, DigitsStopAtFirstNonDigit)
+{
+   EveryLevelAndAlignmentShouldScanDigits("", 0);
+   EveryLevelAndAlignmentShouldScanDigits("x1", 0);
+   EveryLevelAndAlignmentShouldScanDigits("0123456789.5", 10);
+   EveryLevelAndAlignmentShouldScanDigits("12/", 2);
+   EveryLevelAndAlignmentShouldScanDigits("9:", 1);
+}
+
+TEST(CharScan, LongNumberCrossesManyBlocks)
+{
+   EveryLevelAndAlignmentShouldScanDigits("21746193741239461329847163601503086535018237563285761.", 53);
+}
+
+TEST(CharScan, StringBodyStopsAtQuoteNewlineOrEnd)
+{
+   EveryLevelAndAlignmentShouldScanStringBody("This is a string literal\" x", 24);
+   EveryLevelAndAlignmentShouldScanStringBody("not on\none line\"", 6);
+   EveryLevelAndAlignmentShouldScanStringBody("missing ending", 14);
+   EveryLevelAndAlignmentShouldScanStringBody("\"", 0);
+   EveryLevelAndAlignmentShouldScanStringBody("null\0inside", 11, 11);
+}
+
+TEST(CharScan, LongStringBodyCrossesManyBlocks)
+{
+   const char *text =
+      "Lorem ipsum dolor sit amet, consectetur adipiscing elit, sed do "
+      "eiusmod tempor incididunt ut labore et dolore magna aliqua.\"";
+
+   EveryLevelAndAlignmentShouldScanStringBody(text, 123);
+}
+
+// Each run fills an allocation of exactly its length, so a sanitizer catches
+// any read before or after it
+TEST(CharScan, NothingOutsideTheRunIsRead)
+{
+   for(size_t length = 0; length <= 70; length++)
+   {
+      char *run = (char *)malloc((length > 0) ? length : 1);
+
+      for(CharScan_Level_t level = CharScan_Level_Scalar; level <= CharScan_Level_Avx2; level++)
+      {
+         if(!CharScan_Select(level))
+         {
+            continue;
+         }
+
+         memset(run, 'a', length);
+         hasWordCharacter = false;
+         CHECK_EQUAL(length, CharScan_Identifier(run, run + length, &hasWordCharacter));
+         CHECK_EQUAL(length > 0, hasWordCharacter);
+
+         memset(run, '7', length);
+         CHECK_EQUAL(length, CharScan_Digits(run, run + length));
+
+         memset(run, 'x', length);
+         CHECK_EQUAL(length, CharScan_StringBody(run, run + length));
+      }
+
+      free(run);
+   }
+}
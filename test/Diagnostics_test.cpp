@@ -0,0 +1,150 @@
+#include "TestHarness.h"
+#include "MockSupport.h"
+#include "Error_Mock.h"
+
+extern "C"
+{
+   #include <stdio.h>
+   #include <string.h>
+   #include "Diagnostics.h"
+}
+
+TEST_GROUP(Diagnostics)
+{
+   Diagnostics_t diagnostics;
+   Error_Mock_t errorMock;
+
+   void setup()
+   {
+      Diagnostics_Init(&diagnostics, 4, 0);
+      Error_Mock_Init(&errorMock);
+
+      mock().strictOrder();
+   }
+
+   void teardown()
+   {
+      Diagnostics_Deinit(&diagnostics);
+
+      mock().checkExpectations();
+      mock().clear();
+   }
+
+   void ShouldReportThisError(size_t line, const char *message)
+   {
+      mock()
+         .expectOneCall("report")
+         .onObject(&errorMock)
+         .withParameter("line", line)
+         .withParameter("message", message);
+   }
+
+   bool AddOnLine(size_t line)
+   {
+      Diagnostic_t diagnostic = { Diagnostic_Code_MissingSpaceAfterColon, { 0 }, 0, 0, line };
+      return Diagnostics_Add(&diagnostics, &diagnostic);
+   }
+
+   void TheMessageShouldBe(const char *expected, Diagnostic_t diagnostic, const char *source)
+   {
+      char message[128];
+      size_t length = Diagnostic_Format(&diagnostic, source, message, sizeof(message));
+
+      STRCMP_EQUAL(expected, message);
+      CHECK_EQUAL(strlen(expected), length);
+   }
+};
+
+TEST(Diagnostics, EmptySinkReplaysNothing)
+{
+   Diagnostics_Replay(&diagnostics, "", &errorMock.interface);
+   CHECK_EQUAL(0, diagnostics.count);
+}
+
+TEST(Diagnostics, KeepsRecordsInOrder)
+{
+   AddOnLine(1);
+   AddOnLine(2);
+
+   CHECK_EQUAL(2, diagnostics.count);
+   CHECK_EQUAL(1, Diagnostics_At(&diagnostics, 0)->line);
+   CHECK_EQUAL(2, Diagnostics_At(&diagnostics, 1)->line);
+   CHECK_EQUAL(0, Diagnostics_Dropped(&diagnostics));
+}
+
+TEST(Diagnostics, FullRingOverwritesTheOldestRecords)
+{
+   for(size_t line = 1; line <= 6; line++)
+   {
+      AddOnLine(line);
+   }
+
+   CHECK_EQUAL(4, diagnostics.count);
+   CHECK_EQUAL(6, diagnostics.total);
+   CHECK_EQUAL(2, Diagnostics_Dropped(&diagnostics));
+   CHECK_EQUAL(3, Diagnostics_At(&diagnostics, 0)->line);
+   CHECK_EQUAL(6, Diagnostics_At(&diagnostics, 3)->line);
+}
+
+TEST(Diagnostics, AddSaysToStopOnceMaxErrorsIsReached)
+{
+   Diagnostics_Deinit(&diagnostics);
+   Diagnostics_Init(&diagnostics, 4, 2);
+
+   CHECK_TRUE(AddOnLine(1));
+   CHECK_FALSE(AddOnLine(2));
+}
+
+TEST(Diagnostics, ClearForgetsEverything)
+{
+   AddOnLine(1);
+   Diagnostics_Clear(&diagnostics);
+
+   CHECK_EQUAL(0, diagnostics.count);
+   CHECK_EQUAL(0, diagnostics.total);
+}
+
+TEST(Diagnostics, ReplayFormatsEachMessageFromTheSource)
+{
+   const char *source = "x 12a";
+   Diagnostic_t identifier = { Diagnostic_Code_IdentifierMissingLetter, { 0 }, 3, 2, 7 };
+   Diagnostic_t character = { Diagnostic_Code_UnexpectedCharacter, { '%' }, 1, 0, 9 };
+
+   Diagnostics_Add(&diagnostics, &identifier);
+   Diagnostics_Add(&diagnostics, &character);
+
+   ShouldReportThisError(7, "Identifier name missing [a-zA-Z?]: '12a'");
+   ShouldReportThisError(9, "Unexpected character '%'");
+   Diagnostics_Replay(&diagnostics, source, &errorMock.interface);
+}
+
+TEST(Diagnostics, ReportsMessagesTooLongForTheStack)
+{
+   char source[2 * DIAGNOSTIC_MESSAGE_SIZE];
+   char expected[3 * DIAGNOSTIC_MESSAGE_SIZE];
+   Diagnostic_t identifier = { Diagnostic_Code_IdentifierMissingLetter, { 0 }, sizeof(source) - 1, 0, 4 };
+
+   memset(source, '1', sizeof(source) - 1);
+   source[sizeof(source) - 1] = '\0';
+   sprintf(expected, "Identifier name missing [a-zA-Z?]: '%s'", source);
+
+   ShouldReportThisError(2, expected);
+   Diagnostic_Report(&identifier, source, &errorMock.interface, 2);
+}
+
+TEST(Diagnostics, FormatsTouchySymbolsWithOneOrTwoNeighbours)
+{
+   const char *source = "(+)";
+   Diagnostic_t one = { Diagnostic_Code_TouchySymbol, { '(' }, 1, 1, 1 };
+   Diagnostic_t two = { Diagnostic_Code_TouchySymbol, { '(', ')' }, 1, 1, 1 };
+
+   TheMessageShouldBe("\"Touchy\" symbol '+' next to another touchy symbol '('", one, source);
+   TheMessageShouldBe("\"Touchy\" symbol '+' next to other touchy symbols '(' and ')'", two, source);
+}
+
+TEST(Diagnostics, FormatTellsTheLengthWithoutABuffer)
+{
+   Diagnostic_t diagnostic = { Diagnostic_Code_StringMissingEnd, { 0 }, 0, 0, 1 };
+
+   CHECK_EQUAL(strlen("String literal missing ending \""), Diagnostic_Format(&diagnostic, "", NULL, 0));
+}
@@ -0,0 +1,90 @@
+#include "TestHarness.h"
+#include "MockSupport.h"
+#include "Error_Mock.h"
+
+extern "C"
+{
+   #include <string.h>
+   #include "Error_Buffer.h"
+}
+
+TEST_GROUP(Error_Buffer)
+{
+   Error_Buffer_t buffer;
+   Error_Mock_t errorMock;
+
+   void setup()
+   {
+      Error_Buffer_Init(&buffer);
+      Error_Mock_Init(&errorMock);
+
+      mock().strictOrder();
+   }
+
+   void teardown()
+   {
+      Error_Buffer_Deinit(&buffer);
+
+      mock().checkExpectations();
+      mock().clear();
+   }
+
+   void ShouldReportThisError(size_t line, const char *message)
+   {
+      mock()
+         .expectOneCall("report")
+         .onObject(&errorMock)
+         .withParameter("line", line)
+         .withParameter("message", message);
+   }
+};
+
+TEST(Error_Buffer, EmptyBufferReplaysNothing)
+{
+   Error_Buffer_Replay(&buffer, &errorMock.interface, 0);
+}
+
+TEST(Error_Buffer, ReplaysErrorsInOrderWithLineOffset)
+{
+   Error_Report(&buffer.interface, 1, "first");
+   Error_Report(&buffer.interface, 3, "second");
+
+   ShouldReportThisError(11, "first");
+   ShouldReportThisError(13, "second");
+   Error_Buffer_Replay(&buffer, &errorMock.interface, 10);
+}
+
+TEST(Error_Buffer, KeepsItsOwnCopyOfEachMessage)
+{
+   char message[] = "original";
+
+   Error_Report(&buffer.interface, 1, message);
+   strcpy(message, "changed!");
+
+   ShouldReportThisError(1, "original");
+   Error_Buffer_Replay(&buffer, &errorMock.interface, 0);
+}
+
+TEST(Error_Buffer, ClearForgetsStoredErrors)
+{
+   Error_Report(&buffer.interface, 1, "forgotten");
+   Error_Buffer_Clear(&buffer);
+   Error_Report(&buffer.interface, 2, "kept");
+
+   ShouldReportThisError(2, "kept");
+   Error_Buffer_Replay(&buffer, &errorMock.interface, 0);
+}
+
+TEST(Error_Buffer, StoresManyErrors)
+{
+   for(size_t i = 0; i < 100; i++)
+   {
+      Error_Report(&buffer.interface, i, "Unexpected character '%'");
+   }
+
+   for(size_t i = 0; i < 100; i++)
+   {
+      ShouldReportThisError(i, "Unexpected character '%'");
+   }
+   Error_Buffer_Replay(&buffer, &errorMock.interface, 0);
+}
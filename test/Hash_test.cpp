@@ -0,0 +1,58 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <string.h>
+   #include "Hash.h"
+}
+
+TEST_GROUP(Hash)
+{
+   void TheHashShouldBe(const char *data, uint64_t expected)
+   {
+      CHECK(Hash_Bytes(data, strlen(data), 0) == expected);
+   }
+};
+
+TEST(Hash, MatchesXxh64ForAnEmptyBlock)
+{
+   TheHashShouldBe("", 0xef46db3751d8e999ULL);
+}
+
+TEST(Hash, MatchesXxh64ForAShortBlock)
+{
+   TheHashShouldBe("a", 0xd24ec4f1a98c6e5bULL);
+}
+
+TEST(Hash, MatchesXxh64ForABlockLongerThanOneStripe)
+{
+   TheHashShouldBe("Nobody inspects the spammish repetition", 0xfbcea83c8a378bf1ULL);
+}
+
+TEST(Hash, DoesNotDependOnAlignment)
+{
+   uint64_t aligned[16];
+   char buffer[128 + 8];
+
+   for(size_t i = 0; i < sizeof(aligned); i++)
+   {
+      ((char *)aligned)[i] = (char)(i * 7);
+   }
+
+   for(size_t offset = 1; offset < 8; offset++)
+   {
+      memcpy(buffer + offset, aligned, sizeof(aligned));
+      CHECK(Hash_Bytes(buffer + offset, 100, 0) == Hash_Bytes(aligned, 100, 0));
+   }
+}
+
+TEST(Hash, SeedChangesTheHash)
+{
+   CHECK(Hash_Bytes("let", 3, 0) != Hash_Bytes("let", 3, 1));
+}
+
+TEST(Hash, EveryByteCounts)
+{
+   CHECK(Hash_Bytes("let x = 1;", 10, 0) != Hash_Bytes("let x = 2;", 10, 0));
+   CHECK(Hash_Bytes("let x = 1;", 10, 0) != Hash_Bytes("let x = 1;", 9, 0));
+}
@@ -0,0 +1,130 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <stdio.h>
+   #include <string.h>
+   #include "Intern.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "Error_Buffer.h"
+   #include "Token.h"
+}
+
+TEST_GROUP(Intern)
+{
+   Intern_t table;
+
+   void setup()
+   {
+      Intern_Init(&table);
+   }
+
+   void teardown()
+   {
+      Intern_Deinit(&table);
+   }
+
+   void TheNameShouldBe(Intern_Id_t id, const char *expected)
+   {
+      size_t length;
+      const char *name = Intern_Name(&table, id, &length);
+
+      CHECK_EQUAL(strlen(expected), length);
+      STRCMP_EQUAL(expected, name);
+   }
+};
+
+TEST(Intern, ReservedWordsHaveFixedIds)
+{
+   CHECK_EQUAL(Intern_Reserved_And, Intern_Add(&table, "and", 3));
+   CHECK_EQUAL(Intern_Reserved_Or, Intern_Add(&table, "or", 2));
+   CHECK_EQUAL(Intern_Reserved_Not, Intern_Add(&table, "not", 3));
+   CHECK_EQUAL(Intern_Reserved_Not, Intern_Find(&table, "not", 3));
+   TheNameShouldBe(Intern_Reserved_Or, "or");
+   CHECK_TRUE(Intern_IsReserved(Intern_Reserved_And));
+}
+
+TEST(Intern, OnlyReservedWordsAreFoundByThePerfectHash)
+{
+   CHECK_EQUAL(Intern_Reserved_And, Intern_Reserved("and", 3));
+   CHECK_EQUAL(INTERN_NONE, Intern_Reserved("an", 2));
+   CHECK_EQUAL(INTERN_NONE, Intern_Reserved("android", 7));
+   CHECK_EQUAL(INTERN_NONE, Intern_Reserved("nut", 3));
+   CHECK_EQUAL(INTERN_NONE, Intern_Reserved("", 0));
+}
+
+TEST(Intern, SameNameGetsTheSameId)
+{
+   Intern_Id_t first = Intern_Add(&table, "count", 5);
+
+   CHECK_FALSE(Intern_IsReserved(first));
+   CHECK_EQUAL(first, Intern_Add(&table, "count and more", 5));
+   CHECK(first != Intern_Add(&table, "counter", 7));
+   CHECK_EQUAL(first, Intern_Find(&table, "count", 5));
+   TheNameShouldBe(first, "count");
+}
+
+TEST(Intern, IdsAreDenseInOrderOfFirstUse)
+{
+   CHECK_EQUAL(Intern_Reserved_Count, Intern_Add(&table, "x", 1));
+   CHECK_EQUAL(Intern_Reserved_Count + 1, Intern_Add(&table, "y", 1));
+   CHECK_EQUAL(Intern_Reserved_Count, Intern_Add(&table, "x", 1));
+   CHECK_EQUAL(Intern_Reserved_Count + 2, table.count);
+}
+
+TEST(Intern, UnknownNameIsNotFound)
+{
+   CHECK_EQUAL(INTERN_NONE, Intern_Find(&table, "missing", 7));
+}
+
+TEST(Intern, ManyNamesSurviveTheTableGrowing)
+{
+   char name[16];
+
+   for(int i = 0; i < 5000; i++)
+   {
+      sprintf(name, "name%d", i);
+      CHECK_EQUAL(Intern_Reserved_Count + i, Intern_Add(&table, name, strlen(name)));
+   }
+
+   for(int i = 0; i < 5000; i++)
+   {
+      sprintf(name, "name%d", i);
+      CHECK_EQUAL(Intern_Reserved_Count + i, Intern_Find(&table, name, strlen(name)));
+      TheNameShouldBe(Intern_Reserved_Count + i, name);
+   }
+}
+
+TEST(Intern, TokensGetTheIdsOfTheirNames)
+{
+   const char *source = "x = :on or x != 5";
+   Error_Buffer_t errors;
+   List_Calloc_t tokens;
+   List_Calloc_t ids;
+   Lexer_StaticLookup_t lexer;
+   Intern_Id_t *id;
+   const Intern_Id_t expected[] = { Intern_Reserved_Count, INTERN_NONE, Intern_Reserved_Count + 1, Intern_Reserved_Or, Intern_Reserved_Count, INTERN_NONE, INTERN_NONE };
+
+   Error_Buffer_Init(&errors);
+   List_Calloc_Init(&tokens, sizeof(Token_t));
+   List_Calloc_Init(&ids, sizeof(Intern_Id_t));
+   Lexer_StaticLookup_Init(&lexer, &errors.interface);
+
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+   Intern_Tokens(&table, &tokens.interface, &ids.interface);
+
+   for(size_t i = 0; i < 7; i++)
+   {
+      List_At(&ids.interface, i, (void **)&id);
+      CHECK_EQUAL(expected[i], *id);
+   }
+   List_At(&ids.interface, 7, (void **)&id);
+   POINTERS_EQUAL(NULL, id);
+   TheNameShouldBe(Intern_Reserved_Count + 1, ":on");
+
+   Lexer_StaticLookup_Deinit(&lexer);
+   List_Calloc_Deinit(&ids);
+   List_Calloc_Deinit(&tokens);
+   Error_Buffer_Deinit(&errors);
+}
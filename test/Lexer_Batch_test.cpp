@@ -0,0 +1,127 @@
+#include "TestHarness.h"
+#include "MockSupport.h"
+#include "Error_Mock.h"
+
+extern "C"
+{
+   #include <errno.h>
+   #include <stdio.h>
+   #include <string.h>
+   #include <unistd.h>
+   #include "Lexer_Batch.h"
+}
+
+#define FILE_COUNT (40)
+
+TEST_GROUP(Lexer_Batch)
+{
+   Lexer_Batch_t batch;
+   Error_Mock_t errorMock;
+   char names[FILE_COUNT][32];
+   const char *paths[FILE_COUNT];
+
+   void setup()
+   {
+      Error_Mock_Init(&errorMock);
+      mock().strictOrder();
+
+      // File i holds i identifiers, one per line, and an error on its last line
+      for(size_t i = 0; i < FILE_COUNT; i++)
+      {
+         FILE *stream;
+
+         strcpy(names[i], "/tmp/Lexer_Batch_testXXXXXX");
+         close(mkstemp(names[i]));
+         paths[i] = names[i];
+
+         stream = fopen(names[i], "wb");
+         for(size_t line = 0; line < i; line++)
+         {
+            fprintf(stream, "name\n");
+         }
+         fprintf(stream, ";");
+         fclose(stream);
+      }
+   }
+
+   void teardown()
+   {
+      Lexer_Batch_Deinit(&batch);
+      for(size_t i = 0; i < FILE_COUNT; i++)
+      {
+         unlink(names[i]);
+      }
+
+      mock().checkExpectations();
+      mock().clear();
+   }
+
+   void ShouldReportThisError(size_t line, const char *message)
+   {
+      mock()
+         .expectOneCall("report")
+         .onObject(&errorMock)
+         .withParameter("line", line)
+         .withParameter("message", message);
+   }
+
+   void EveryFileShouldHaveItsOwnTokens()
+   {
+      for(size_t i = 0; i < FILE_COUNT; i++)
+      {
+         size_t count;
+         const Token_t *tokens = Lexer_Batch_Tokens(&batch, i, &count);
+
+         CHECK_EQUAL(0, Lexer_Batch_OpenError(&batch, i));
+         CHECK_EQUAL(i, count);
+         for(size_t t = 0; t < count; t++)
+         {
+            CHECK_EQUAL(Token_Type_Identifier, tokens[t].type);
+            CHECK_EQUAL(4, tokens[t].length);
+            CHECK_EQUAL(t + 1, tokens[t].line);
+            CHECK(strncmp("name", tokens[t].lexeme, 4) == 0);
+         }
+      }
+   }
+};
+
+TEST(Lexer_Batch, LexesEveryFileOnOneThread)
+{
+   Lexer_Batch_Init(&batch, paths, FILE_COUNT, 1);
+   Lexer_Batch_Run(&batch);
+
+   EveryFileShouldHaveItsOwnTokens();
+}
+
+TEST(Lexer_Batch, LexesEveryFileOnManyThreads)
+{
+   Lexer_Batch_Init(&batch, paths, FILE_COUNT, 4);
+   Lexer_Batch_Run(&batch);
+
+   EveryFileShouldHaveItsOwnTokens();
+}
+
+TEST(Lexer_Batch, ReportsErrorsOfOneFileInOrder)
+{
+   Lexer_Batch_Init(&batch, paths, FILE_COUNT, 4);
+   Lexer_Batch_Run(&batch);
+
+   ShouldReportThisError(1, "Unexpected character ';'");
+   ShouldReportThisError(8, "Unexpected character ';'");
+   CHECK_EQUAL(1, Lexer_Batch_ReportErrors(&batch, 0, &errorMock.interface));
+   CHECK_EQUAL(1, Lexer_Batch_ReportErrors(&batch, 7, &errorMock.interface));
+}
+
+TEST(Lexer_Batch, MissingFileHasOpenErrorAndNoTokens)
+{
+   size_t count;
+
+   unlink(names[3]);
+   Lexer_Batch_Init(&batch, paths, FILE_COUNT, 4);
+   Lexer_Batch_Run(&batch);
+
+   CHECK_EQUAL(ENOENT, Lexer_Batch_OpenError(&batch, 3));
+   POINTERS_EQUAL(NULL, Lexer_Batch_Tokens(&batch, 3, &count));
+   CHECK_EQUAL(0, count);
+   CHECK_EQUAL(0, Lexer_Batch_ReportErrors(&batch, 3, &errorMock.interface));
+}
@@ -0,0 +1,348 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <dirent.h>
+   #include <stdio.h>
+   #include <stdlib.h>
+   #include <string.h>
+   #include <unistd.h>
+   #include "Lexer_Cache.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "Error_Buffer.h"
+   #include "Token.h"
+}
+
+TEST_GROUP(Lexer_Cache)
+{
+   Error_Buffer_t expectedErrors;
+   Error_Buffer_t actualErrors;
+   List_Calloc_t expectedTokens;
+   List_Calloc_t actualTokens;
+   Lexer_StaticLookup_t reference;
+   Lexer_StaticLookup_t lexer;
+   Lexer_Cache_t cache;
+   char directory[32];
+
+   void setup()
+   {
+      Error_Buffer_Init(&expectedErrors);
+      Error_Buffer_Init(&actualErrors);
+      List_Calloc_Init(&expectedTokens, sizeof(Token_t));
+      List_Calloc_Init(&actualTokens, sizeof(Token_t));
+      Lexer_StaticLookup_Init(&reference, &expectedErrors.interface);
+      WithABudgetOf(1 << 20);
+      directory[0] = '\0';
+   }
+
+   void teardown()
+   {
+      Lexer_Cache_Deinit(&cache);
+      Lexer_StaticLookup_Deinit(&lexer);
+      Lexer_StaticLookup_Deinit(&reference);
+      List_Calloc_Deinit(&expectedTokens);
+      List_Calloc_Deinit(&actualTokens);
+      Error_Buffer_Deinit(&expectedErrors);
+      Error_Buffer_Deinit(&actualErrors);
+
+      if(directory[0] != '\0')
+      {
+         RemoveDirectory();
+      }
+   }
+
+   void WithABudgetOf(size_t budget)
+   {
+      Lexer_StaticLookup_Init(&lexer, &cache.errors.interface);
+      Lexer_Cache_Init(&cache, &lexer.interface, &actualErrors.interface, budget);
+   }
+
+   // Start over with an empty cache, as another process would
+   void Restart(size_t budget)
+   {
+      Lexer_Cache_Deinit(&cache);
+      Lexer_StaticLookup_Deinit(&lexer);
+      WithABudgetOf(budget);
+      if(directory[0] != '\0')
+      {
+         Lexer_Cache_SetDirectory(&cache, directory);
+      }
+   }
+
+   void WithADirectory()
+   {
+      strcpy(directory, "/tmp/Lexer_Cache_XXXXXX");
+      CHECK(mkdtemp(directory) != NULL);
+      Lexer_Cache_SetDirectory(&cache, directory);
+   }
+
+   void RemoveDirectory()
+   {
+      DIR *dir = opendir(directory);
+      struct dirent *file;
+      char path[300];
+
+      while((file = readdir(dir)) != NULL)
+      {
+         if(file->d_name[0] != '.')
+         {
+            snprintf(path, sizeof(path), "%s/%s", directory, file->d_name);
+            remove(path);
+         }
+      }
+      closedir(dir);
+      rmdir(directory);
+   }
+
+   // Path of the only file in the directory
+   void TheCachedFile(char *path, size_t size)
+   {
+      DIR *dir = opendir(directory);
+      struct dirent *file;
+
+      while((file = readdir(dir)) != NULL && file->d_name[0] == '.')
+      {
+      }
+      CHECK(file != NULL);
+      snprintf(path, size, "%s/%s", directory, file->d_name);
+      closedir(dir);
+   }
+
+   void OverwriteTheCachedFileAt(long position, uint64_t value)
+   {
+      char path[300];
+      FILE *file;
+
+      TheCachedFile(path, sizeof(path));
+      file = fopen(path, "r+b");
+      CHECK(file != NULL);
+      fseek(file, position, SEEK_SET);
+      fwrite(&value, sizeof(value), 1, file);
+      fclose(file);
+   }
+
+   void TruncateTheCachedFileTo(long size)
+   {
+      char path[300];
+
+      TheCachedFile(path, sizeof(path));
+      CHECK_EQUAL(0, truncate(path, size));
+   }
+
+   // Lex a copy of the source, so cached tokens have to be moved onto it
+   void TheOutputShouldMatchTheLexer(const char *source)
+   {
+      char *copy = strdup(source);
+      Token_t *expected;
+      Token_t *actual;
+      size_t i;
+
+      List_Calloc_Deinit(&expectedTokens);
+      List_Calloc_Deinit(&actualTokens);
+      List_Calloc_Init(&expectedTokens, sizeof(Token_t));
+      List_Calloc_Init(&actualTokens, sizeof(Token_t));
+      Error_Buffer_Clear(&expectedErrors);
+      Error_Buffer_Clear(&actualErrors);
+
+      Lexer_Lex(&reference.interface, source, &expectedTokens.interface);
+      Lexer_Lex(&cache.interface, copy, &actualTokens.interface);
+
+      CHECK_EQUAL(expectedTokens.usedSize, actualTokens.usedSize);
+      for(i = 0; i < expectedTokens.usedSize; i++)
+      {
+         List_At(&expectedTokens.interface, i, (void **)&expected);
+         List_At(&actualTokens.interface, i, (void **)&actual);
+         CHECK_EQUAL(expected->type, actual->type);
+         CHECK_EQUAL(expected->lexeme - source, actual->lexeme - copy);
+         CHECK_EQUAL(expected->length, actual->length);
+         CHECK_EQUAL(expected->line, actual->line);
+      }
+
+      CHECK_EQUAL(expectedErrors.count, actualErrors.count);
+      for(i = 0; i < expectedErrors.count; i++)
+      {
+         CHECK_EQUAL(expectedErrors.entries[i].line, actualErrors.entries[i].line);
+         STRCMP_EQUAL(&expectedErrors.text[expectedErrors.entries[i].message], &actualErrors.text[actualErrors.entries[i].message]);
+      }
+
+      free(copy);
+   }
+
+   void TheStatsShouldBe(size_t hits, size_t diskHits, size_t misses)
+   {
+      CHECK_EQUAL(hits, cache.stats.hits);
+      CHECK_EQUAL(diskHits, cache.stats.diskHits);
+      CHECK_EQUAL(misses, cache.stats.misses);
+   }
+};
+
+TEST(Lexer_Cache, LexesASourceItHasNotSeen)
+{
+   TheOutputShouldMatchTheLexer("let x = 10;\nfunc f(a, b) { return a + b; }\n");
+   TheStatsShouldBe(0, 0, 1);
+}
+
+TEST(Lexer_Cache, GivesBackTheTokensOfASourceItHasSeen)
+{
+   TheOutputShouldMatchTheLexer("let x = 10;\nfunc f(a, b) { return a + b; }\n");
+   TheOutputShouldMatchTheLexer("let x = 10;\nfunc f(a, b) { return a + b; }\n");
+   TheStatsShouldBe(1, 0, 1);
+}
+
+TEST(Lexer_Cache, GivesBackTheErrorsOfASourceItHasSeen)
+{
+   TheOutputShouldMatchTheLexer("let x = 1.;\n\"unfinished\nlet y = $;\n");
+   CHECK(actualErrors.count > 0);
+   TheOutputShouldMatchTheLexer("let x = 1.;\n\"unfinished\nlet y = $;\n");
+   TheStatsShouldBe(1, 0, 1);
+}
+
+TEST(Lexer_Cache, TellsApartSourcesThatDifferByOneCharacter)
+{
+   TheOutputShouldMatchTheLexer("let x = 1;");
+   TheOutputShouldMatchTheLexer("let x = 2;");
+   TheOutputShouldMatchTheLexer("let x = 1;;");
+   TheStatsShouldBe(0, 0, 3);
+}
+
+TEST(Lexer_Cache, HandlesAnEmptySource)
+{
+   TheOutputShouldMatchTheLexer("");
+   TheOutputShouldMatchTheLexer("");
+   TheStatsShouldBe(1, 0, 1);
+}
+
+TEST(Lexer_Cache, KeepsNothingWithNoBudget)
+{
+   Restart(0);
+
+   TheOutputShouldMatchTheLexer("let x = 1;");
+   TheOutputShouldMatchTheLexer("let x = 1;");
+   TheStatsShouldBe(0, 0, 2);
+   CHECK_EQUAL(0, cache.stats.entries);
+   CHECK_EQUAL(0, cache.stats.bytes);
+}
+
+TEST(Lexer_Cache, DropsTheLeastRecentlyUsedSourceToStayWithinTheBudget)
+{
+   size_t oneEntry;
+
+   TheOutputShouldMatchTheLexer("let a = 1;");
+   oneEntry = cache.stats.bytes;
+   Restart(oneEntry * 2 + oneEntry / 2);
+
+   TheOutputShouldMatchTheLexer("let a = 1;");
+   TheOutputShouldMatchTheLexer("let b = 1;");
+   TheOutputShouldMatchTheLexer("let a = 1;");   // Now b is the oldest
+   TheOutputShouldMatchTheLexer("let c = 1;");   // So b goes
+   TheStatsShouldBe(1, 0, 3);
+   CHECK_EQUAL(1, cache.stats.evictions);
+   CHECK_EQUAL(2, cache.stats.entries);
+
+   TheOutputShouldMatchTheLexer("let a = 1;");
+   TheOutputShouldMatchTheLexer("let b = 1;");
+   TheStatsShouldBe(2, 0, 4);
+}
+
+TEST(Lexer_Cache, KeepsManySources)
+{
+   char source[64];
+
+   for(int round = 0; round < 2; round++)
+   {
+      for(int i = 0; i < 500; i++)
+      {
+         sprintf(source, "let x%d = %d;\n", i, i);
+         TheOutputShouldMatchTheLexer(source);
+      }
+   }
+   TheStatsShouldBe(500, 0, 500);
+   CHECK_EQUAL(500, cache.stats.entries);
+}
+
+TEST(Lexer_Cache, LexesEachMissIntoTheSameScratchList)
+{
+   uint8_t *storage;
+
+   TheOutputShouldMatchTheLexer("let x = 1; let y = 2; let z = 3;");
+   storage = cache.tokens.storage;
+
+   TheOutputShouldMatchTheLexer("let w = 4;");
+   POINTERS_EQUAL(storage, cache.tokens.storage);
+   TheStatsShouldBe(0, 0, 2);
+}
+
+TEST(Lexer_Cache, FindsSourcesLexedByAnEarlierCacheInItsDirectory)
+{
+   WithADirectory();
+   TheOutputShouldMatchTheLexer("let x = 1.;\nfunc f() { return \"s\"; }\n");
+   TheStatsShouldBe(0, 0, 1);
+
+   Restart(1 << 20);
+   TheOutputShouldMatchTheLexer("let x = 1.;\nfunc f() { return \"s\"; }\n");
+   TheOutputShouldMatchTheLexer("let x = 1.;\nfunc f() { return \"s\"; }\n");
+   TheStatsShouldBe(1, 1, 0);
+}
+
+TEST(Lexer_Cache, UsesItsDirectoryEvenWithNoBudget)
+{
+   WithADirectory();
+   Restart(0);
+
+   TheOutputShouldMatchTheLexer("let x = 1;");
+   TheOutputShouldMatchTheLexer("let x = 1;");
+   TheStatsShouldBe(0, 1, 1);
+}
+
+/***************************
+* Damaged files
+***************************/
+// A file starts with a 56-byte header, followed by the tokens, each starting
+// with its offset, and then the errors, each a line and a message offset
+#define HEADER_SIZE (56)
+
+TEST(Lexer_Cache, LexesAgainIfACachedTokenLiesOutsideTheSource)
+{
+   WithADirectory();
+   TheOutputShouldMatchTheLexer("let x = 1;");
+
+   OverwriteTheCachedFileAt(HEADER_SIZE, 1 << 30);
+   Restart(1 << 20);
+   TheOutputShouldMatchTheLexer("let x = 1;");
+   TheStatsShouldBe(0, 0, 1);
+}
+
+TEST(Lexer_Cache, LexesAgainIfACachedMessageLiesOutsideTheText)
+{
+   WithADirectory();
+   TheOutputShouldMatchTheLexer("%");
+   CHECK_EQUAL(1, actualErrors.count);
+
+   OverwriteTheCachedFileAt(HEADER_SIZE + sizeof(size_t), 1 << 30);
+   Restart(1 << 20);
+   TheOutputShouldMatchTheLexer("%");
+   TheStatsShouldBe(0, 0, 1);
+}
+
+TEST(Lexer_Cache, LexesAgainIfTheCachedFileIsCutShort)
+{
+   WithADirectory();
+   TheOutputShouldMatchTheLexer("let x = 1;\nlet y = %;");
+
+   TruncateTheCachedFileTo(HEADER_SIZE + 10);
+   Restart(1 << 20);
+   TheOutputShouldMatchTheLexer("let x = 1;\nlet y = %;");
+   TheStatsShouldBe(0, 0, 1);
+}
+
+TEST(Lexer_Cache, LexesAgainIfTheCachedCountsAreTooLarge)
+{
+   WithADirectory();
+   TheOutputShouldMatchTheLexer("let x = 1;");
+
+   OverwriteTheCachedFileAt(24, (uint64_t)1 << 60);
+   Restart(1 << 20);
+   TheOutputShouldMatchTheLexer("let x = 1;");
+   TheStatsShouldBe(0, 0, 1);
+}
@@ -0,0 +1,171 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <string.h>
+   #include "Lexer_Dfa.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "TokenList.h"
+   #include "Error_Buffer.h"
+   #include "Token.h"
+}
+
+/*
+ * Lexer_StaticLookup is the reference: every source its own tests use has to
+ * come out of Lexer_Dfa as the same tokens and the same errors.
+ */
+TEST_GROUP(Lexer_Dfa)
+{
+   Error_Buffer_t expectedErrors;
+   Error_Buffer_t actualErrors;
+   List_Calloc_t expectedTokens;
+   List_Calloc_t actualTokens;
+   Lexer_StaticLookup_t referenceLexer;
+   Lexer_Dfa_t lexer;
+
+   void setup()
+   {
+      Error_Buffer_Init(&expectedErrors);
+      Error_Buffer_Init(&actualErrors);
+      List_Calloc_Init(&expectedTokens, sizeof(Token_t));
+      List_Calloc_Init(&actualTokens, sizeof(Token_t));
+      Lexer_StaticLookup_Init(&referenceLexer, &expectedErrors.interface);
+      Lexer_Dfa_Init(&lexer, &actualErrors.interface);
+   }
+
+   void teardown()
+   {
+      Lexer_StaticLookup_Deinit(&referenceLexer);
+      List_Calloc_Deinit(&expectedTokens);
+      List_Calloc_Deinit(&actualTokens);
+      Error_Buffer_Deinit(&expectedErrors);
+      Error_Buffer_Deinit(&actualErrors);
+   }
+
+   void TheOutputShouldMatchStaticLookup(const char *source)
+   {
+      TheOutputShouldMatchStaticLookup(source, strlen(source));
+   }
+
+   void TheOutputShouldMatchStaticLookup(const char *source, size_t length)
+   {
+      Token_t *expected;
+      Token_t *actual;
+      size_t i = 0;
+
+      List_Calloc_Deinit(&expectedTokens);
+      List_Calloc_Deinit(&actualTokens);
+      List_Calloc_Init(&expectedTokens, sizeof(Token_t));
+      List_Calloc_Init(&actualTokens, sizeof(Token_t));
+      Error_Buffer_Clear(&expectedErrors);
+      Error_Buffer_Clear(&actualErrors);
+
+      Lexer_LexSpan(&referenceLexer.interface, source, length, &expectedTokens.interface);
+      Lexer_LexSpan(&lexer.interface, source, length, &actualTokens.interface);
+
+      do
+      {
+         List_At(&expectedTokens.interface, i, (void **)&expected);
+         List_At(&actualTokens.interface, i, (void **)&actual);
+         CHECK((expected == NULL) == (actual == NULL));
+
+         if(expected != NULL)
+         {
+            CHECK_EQUAL(expected->type, actual->type);
+            CHECK_EQUAL(expected->lexeme, actual->lexeme);
+            CHECK_EQUAL(expected->length, actual->length);
+            CHECK_EQUAL(expected->line, actual->line);
+         }
+         i++;
+      } while(expected != NULL);
+
+      CHECK_EQUAL(expectedErrors.count, actualErrors.count);
+      for(i = 0; i < expectedErrors.count; i++)
+      {
+         CHECK_EQUAL(expectedErrors.entries[i].line, actualErrors.entries[i].line);
+         STRCMP_EQUAL(&expectedErrors.text[expectedErrors.entries[i].message], &actualErrors.text[actualErrors.entries[i].message]);
+      }
+   }
+};
+
+TEST(Lexer_Dfa, RecognizesSymbols)
+{
+   TheOutputShouldMatchStaticLookup("()[]{},.`");
+   TheOutputShouldMatchStaticLookup("@ # $ - + / * = < > <= >= != ==");
+}
+
+TEST(Lexer_Dfa, RecognizesIdentifiers)
+{
+   TheOutputShouldMatchStaticLookup("word _attribute ???????? #-items valid-identifier? t######## ####t");
+}
+
+TEST(Lexer_Dfa, RecognizesLiterals)
+{
+   TheOutputShouldMatchStaticLookup("  \"This is a string literal\"");
+   TheOutputShouldMatchStaticLookup(":this-is-a-symbolic-literal?");
+   TheOutputShouldMatchStaticLookup("1 2.3 .4 567. 9384573940.2832985723.5432");
+   TheOutputShouldMatchStaticLookup("7' 12\" 3.5' .5\"");
+}
+
+TEST(Lexer_Dfa, LexSpanStopsAtLength)
+{
+   const char source[] = { 'w', 'o', 'r', 'd', ' ', '1', '2', '3', '4', '5' };
+
+   TheOutputShouldMatchStaticLookup(source, 7);
+   TheOutputShouldMatchStaticLookup("x: \"cut off\" <= ", 8);
+   TheOutputShouldMatchStaticLookup("a <", 3);
+   TheOutputShouldMatchStaticLookup("a\0b", 3);
+   TheOutputShouldMatchStaticLookup("a \"x\0y\" b", 9);
+}
+
+TEST(Lexer_Dfa, SpecialCases)
+{
+   TheOutputShouldMatchStaticLookup(". .. ... .6 ..6 ...");
+   TheOutputShouldMatchStaticLookup(": :this-is-a-symbolic-literal?:");
+   TheOutputShouldMatchStaticLookup(":(x)");
+   TheOutputShouldMatchStaticLookup("-one-name- - another-name");
+   TheOutputShouldMatchStaticLookup("!one!name! != another!name");
+   TheOutputShouldMatchStaticLookup("#one#name# # another#name");
+   TheOutputShouldMatchStaticLookup("~one~name~ ~ another~name");
+}
+
+TEST(Lexer_Dfa, ReportsTheSameErrors)
+{
+   TheOutputShouldMatchStaticLookup("____ #### --_- !!");
+   TheOutputShouldMatchStaticLookup(":____ :#### :--_- :!!");
+   TheOutputShouldMatchStaticLookup("@#$-+ /*=<><=>=!===");
+   TheOutputShouldMatchStaticLookup("num= 5\nnum-two=num+10");
+   TheOutputShouldMatchStaticLookup("%^&\\|;");
+   TheOutputShouldMatchStaticLookup("\x01\x02\x08\x0E\x1B\x1F\x7F");
+   TheOutputShouldMatchStaticLookup("a=\x80 \xC3\xA9=b \xFF");
+   TheOutputShouldMatchStaticLookup("\"not on\none line\" \"or\nthis\none");
+}
+
+TEST(Lexer_Dfa, CountsLineNumbers)
+{
+   TheOutputShouldMatchStaticLookup("x: int = 5 \ny: int = 10\n print x + y");
+}
+
+TEST(Lexer_Dfa, TokenListGetsTheSameTokensWithoutTheInterface)
+{
+   const char *source = "x: int = 5 \ny: int = 10\n print x + y";
+   TokenList_t typed;
+   Token_t *expected;
+
+   TokenList_Init(&typed);
+   Lexer_Lex(&referenceLexer.interface, source, &expectedTokens.interface);
+   Lexer_Lex(&lexer.interface, source, &typed.interface);
+
+   CHECK_EQUAL(expectedTokens.usedSize, typed.count);
+   for(size_t i = 0; i < typed.count; i++)
+   {
+      List_At(&expectedTokens.interface, i, (void **)&expected);
+      CHECK_EQUAL(expected->type, typed.tokens[i].type);
+      CHECK_EQUAL(expected->lexeme, typed.tokens[i].lexeme);
+      CHECK_EQUAL(expected->length, typed.tokens[i].length);
+      CHECK_EQUAL(expected->line, typed.tokens[i].line);
+   }
+
+   TokenList_Deinit(&typed);
+}
@@ -0,0 +1,202 @@
+#include "TestHarness.h"
+#include "MockSupport.h"
+#include "Error_Mock.h"
+
+extern "C"
+{
+   #include <string.h>
+   #include "Lexer_Incremental.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "Error_Buffer.h"
+}
+
+TEST_GROUP(Lexer_Incremental)
+{
+   Error_Mock_t errorMock;
+   Lexer_Incremental_t incremental;
+
+   void setup()
+   {
+      Error_Mock_Init(&errorMock);
+      Lexer_Incremental_Init(&incremental, &errorMock.interface);
+
+      mock().strictOrder();
+   }
+
+   void teardown()
+   {
+      Lexer_Incremental_Deinit(&incremental);
+
+      mock().checkExpectations();
+      mock().clear();
+   }
+
+   void ShouldReportThisError(size_t line, const char *message)
+   {
+      mock()
+         .expectOneCall("report")
+         .onObject(&errorMock)
+         .withParameter("line", line)
+         .withParameter("message", message);
+   }
+
+   void TheTextShouldBe(const char *expected)
+   {
+      size_t length;
+      const char *text = Lexer_Incremental_Text(&incremental, &length);
+
+      CHECK_EQUAL(strlen(expected), length);
+      CHECK(memcmp(expected, text, length) == 0);
+   }
+
+   // Lex the whole text from scratch and check every token against it
+   void TheTokensShouldMatchAFreshLex()
+   {
+      size_t length;
+      const char *text = Lexer_Incremental_Text(&incremental, &length);
+      Error_Buffer_t errors;
+      List_Calloc_t tokens;
+      Lexer_StaticLookup_t lexer;
+
+      Error_Buffer_Init(&errors);
+      List_Calloc_Init(&tokens, sizeof(Token_t));
+      Lexer_StaticLookup_Init(&lexer, &errors.interface);
+      Lexer_LexSpan(&lexer.interface, text, length, &tokens.interface);
+
+      CHECK_EQUAL(tokens.usedSize, Lexer_Incremental_Count(&incremental));
+      for(size_t i = 0; i < tokens.usedSize; i++)
+      {
+         Token_t *expected;
+         Lexer_Incremental_Token_t actual;
+
+         List_At(&tokens.interface, i, (void **)&expected);
+         Lexer_Incremental_At(&incremental, i, &actual);
+         CHECK_EQUAL(expected->type, actual.type);
+         CHECK_EQUAL((size_t)(expected->lexeme - text), actual.offset);
+         CHECK_EQUAL(expected->length, actual.length);
+         CHECK_EQUAL(expected->line, actual.line);
+      }
+
+      Lexer_StaticLookup_Deinit(&lexer);
+      List_Calloc_Deinit(&tokens);
+      Error_Buffer_Deinit(&errors);
+   }
+
+   void TheChangeShouldBe(Lexer_Incremental_Change_t change, size_t first, size_t removed, size_t added)
+   {
+      CHECK_EQUAL(first, change.first);
+      CHECK_EQUAL(removed, change.removed);
+      CHECK_EQUAL(added, change.added);
+   }
+};
+
+TEST(Lexer_Incremental, LoadLexesTheWholeText)
+{
+   Lexer_Incremental_Load(&incremental, "x: int = 5\ny = \"two\"\n", 21);
+
+   CHECK_EQUAL(8, Lexer_Incremental_Count(&incremental));
+   TheTokensShouldMatchAFreshLex();
+}
+
+TEST(Lexer_Incremental, EditOnOneLineOnlyRelexesThatLine)
+{
+   const char *source = "a = 1\nb = 2\nc = 3\n";
+
+   Lexer_Incremental_Load(&incremental, source, strlen(source));
+   TheChangeShouldBe(Lexer_Incremental_Edit(&incremental, 10, 1, "42", 2), 3, 3, 3);
+
+   TheTextShouldBe("a = 1\nb = 42\nc = 3\n");
+   TheTokensShouldMatchAFreshLex();
+}
+
+TEST(Lexer_Incremental, TokensAfterAnEditFollowItsOffsetsAndLines)
+{
+   const char *source = "a\nb\nc\nd\n";
+   Lexer_Incremental_Token_t token;
+
+   Lexer_Incremental_Load(&incremental, source, strlen(source));
+   Lexer_Incremental_Edit(&incremental, 2, 0, "x y\nz\n", 6);
+
+   Lexer_Incremental_At(&incremental, 5, &token);
+   CHECK_EQUAL(10, token.offset);
+   CHECK_EQUAL(5, token.line);
+   TheTokensShouldMatchAFreshLex();
+}
+
+TEST(Lexer_Incremental, JoiningLinesRelexesBoth)
+{
+   const char *source = "a -\nb\nc\n";
+
+   Lexer_Incremental_Load(&incremental, source, strlen(source));
+   Lexer_Incremental_Edit(&incremental, 3, 1, "", 0);
+
+   TheTextShouldBe("a -b\nc\n");
+   TheTokensShouldMatchAFreshLex();
+}
+
+TEST(Lexer_Incremental, OpeningAStringRelexesToItsEndAndClosingItAgainRestoresTheTokens)
+{
+   const char *source = "a\nb c\nd\n";
+
+   Lexer_Incremental_Load(&incremental, source, strlen(source));
+
+   ShouldReportThisError(1, "String literal not contained on one line.");
+   ShouldReportThisError(2, "String literal not contained on one line.");
+   ShouldReportThisError(3, "String literal not contained on one line.");
+   ShouldReportThisError(4, "String literal missing ending \"");
+   TheChangeShouldBe(Lexer_Incremental_Edit(&incremental, 1, 0, "\"", 1), 0, 4, 1);
+   TheTokensShouldMatchAFreshLex();
+
+   TheChangeShouldBe(Lexer_Incremental_Edit(&incremental, 1, 1, "", 0), 0, 1, 4);
+   TheTokensShouldMatchAFreshLex();
+}
+
+TEST(Lexer_Incremental, EditInsideAStringCoveringLinesRelexesFromItsStart)
+{
+   const char *source = "x = \"a\nb\" y\nz\n";
+
+   ShouldReportThisError(1, "String literal not contained on one line.");
+   Lexer_Incremental_Load(&incremental, source, strlen(source));
+
+   ShouldReportThisError(1, "String literal not contained on one line.");
+   Lexer_Incremental_Edit(&incremental, 7, 1, "bb", 2);
+
+   TheTextShouldBe("x = \"a\nbb\" y\nz\n");
+   TheTokensShouldMatchAFreshLex();
+}
+
+TEST(Lexer_Incremental, ErrorsOnRelexedLinesAreReportedWithTheirLine)
+{
+   const char *source = "a\nb\nc\n";
+
+   Lexer_Incremental_Load(&incremental, source, strlen(source));
+
+   ShouldReportThisError(2, "Unexpected character '%'");
+   Lexer_Incremental_Edit(&incremental, 3, 0, " %", 2);
+}
+
+TEST(Lexer_Incremental, ManySmallEditsMatchAFreshLex)
+{
+   const char *source = "f: (x) = x + 1\ng = \"s\" :sym .5\n";
+   const char *inserts[] = { "\n", "\"", "a", "(", " ", ".", ":" };
+   Error_Buffer_t errors;
+
+   Error_Buffer_Init(&errors);
+   Lexer_Incremental_Deinit(&incremental);
+   Lexer_Incremental_Init(&incremental, &errors.interface);
+
+   Lexer_Incremental_Load(&incremental, source, strlen(source));
+   for(size_t i = 0; i < 40; i++)
+   {
+      size_t length;
+
+      Lexer_Incremental_Text(&incremental, &length);
+      Lexer_Incremental_Edit(&incremental, (i * 7) % (length + 1), 0, inserts[i % 7], 1);
+      Lexer_Incremental_Text(&incremental, &length);
+      Lexer_Incremental_Edit(&incremental, (i * 5) % length, 1, "", 0);
+   }
+
+   TheTokensShouldMatchAFreshLex();
+   Error_Buffer_Deinit(&errors);
+}
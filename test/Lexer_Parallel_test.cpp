@@ -0,0 +1,156 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <stdio.h>
+   #include <stdlib.h>
+   #include <string.h>
+   #include "Lexer_Parallel.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "TokenList.h"
+   #include "Error_Buffer.h"
+   #include "Token.h"
+}
+
+TEST_GROUP(Lexer_Parallel)
+{
+   Error_Buffer_t serialErrors;
+   Error_Buffer_t parallelErrors;
+   List_Calloc_t serialTokens;
+   List_Calloc_t parallelTokens;
+   Lexer_StaticLookup_t serialLexer;
+   Lexer_Parallel_t parallelLexer;
+
+   void setup()
+   {
+      Error_Buffer_Init(&serialErrors);
+      Error_Buffer_Init(&parallelErrors);
+      List_Calloc_Init(&serialTokens, sizeof(Token_t));
+      List_Calloc_Init(&parallelTokens, sizeof(Token_t));
+      Lexer_StaticLookup_Init(&serialLexer, &serialErrors.interface);
+      Lexer_Parallel_Init(&parallelLexer, &parallelErrors.interface, 4);
+   }
+
+   void teardown()
+   {
+      Lexer_StaticLookup_Deinit(&serialLexer);
+      List_Calloc_Deinit(&serialTokens);
+      List_Calloc_Deinit(&parallelTokens);
+      Error_Buffer_Deinit(&serialErrors);
+      Error_Buffer_Deinit(&parallelErrors);
+   }
+
+   // Split even tiny sources into as many chunks as there are threads
+   void WithChunksOfAtLeast(size_t size)
+   {
+      parallelLexer.minChunkSize = size;
+   }
+
+   void TheOutputShouldMatchTheSerialLexer(const char *source)
+   {
+      Token_t *expected;
+      Token_t *actual;
+      size_t i = 0;
+
+      Lexer_Lex(&serialLexer.interface, source, &serialTokens.interface);
+      Lexer_Lex(&parallelLexer.interface, source, &parallelTokens.interface);
+
+      do
+      {
+         List_At(&serialTokens.interface, i, (void **)&expected);
+         List_At(&parallelTokens.interface, i, (void **)&actual);
+         CHECK((expected == NULL) == (actual == NULL));
+
+         if(expected != NULL)
+         {
+            CHECK_EQUAL(expected->type, actual->type);
+            CHECK_EQUAL(expected->lexeme, actual->lexeme);
+            CHECK_EQUAL(expected->length, actual->length);
+            CHECK_EQUAL(expected->line, actual->line);
+         }
+         i++;
+      } while(expected != NULL);
+
+      CHECK_EQUAL(serialErrors.count, parallelErrors.count);
+      for(i = 0; i < serialErrors.count; i++)
+      {
+         CHECK_EQUAL(serialErrors.entries[i].line, parallelErrors.entries[i].line);
+         STRCMP_EQUAL(&serialErrors.text[serialErrors.entries[i].message], &parallelErrors.text[parallelErrors.entries[i].message]);
+      }
+   }
+};
+
+TEST(Lexer_Parallel, SmallSourceIsLexedOnOneThread)
+{
+   TheOutputShouldMatchTheSerialLexer("x: int = 5\ny: int = 10\n print x + y");
+}
+
+TEST(Lexer_Parallel, ChunksGetAbsoluteLineNumbers)
+{
+   WithChunksOfAtLeast(1);
+   TheOutputShouldMatchTheSerialLexer("a = 1\nb = 2\n\n\nc = 3\nd = 4\ne = 5\nf = 6\n");
+}
+
+TEST(Lexer_Parallel, ErrorsAreReportedInOrderWithAbsoluteLineNumbers)
+{
+   WithChunksOfAtLeast(1);
+   TheOutputShouldMatchTheSerialLexer("a = 1;\nb = 2%\nc = ___\nd = a<b\n.5 e\n");
+}
+
+TEST(Lexer_Parallel, CharacterBeforeAChunkStillCounts)
+{
+   WithChunksOfAtLeast(1);
+   TheOutputShouldMatchTheSerialLexer("aaaa\n.5\nbbbb\n.5\ncccc\n.5\ndddd\n.5\n");
+}
+
+TEST(Lexer_Parallel, StringMissingItsEndingRunsIntoLaterChunks)
+{
+   WithChunksOfAtLeast(1);
+   TheOutputShouldMatchTheSerialLexer("a = \"one\nb = 2\nc = 3\nd = 4\" \"e\ne = 5\nf = 6\n");
+   TheOutputShouldMatchTheSerialLexer("a = 1\nb = 2\nc = \"to the end\nd = 4\ne = 5\n");
+}
+
+TEST(Lexer_Parallel, TokensGoAfterThoseAlreadyInATokenList)
+{
+   const char *source = "a = 1;\nb = \"two\nc\" 3\nd = 4\ne = 5\nf = 6\n";
+   Token_t before = { Token_Type_Identifier, "z", 1, 9 };
+   TokenList_t tokenList;
+   Token_t *expected;
+
+   WithChunksOfAtLeast(1);
+   TokenList_Init(&tokenList);
+   TokenList_Add(&tokenList, &before);
+
+   Lexer_Lex(&serialLexer.interface, source, &serialTokens.interface);
+   Lexer_Lex(&parallelLexer.interface, source, &tokenList.interface);
+
+   CHECK_EQUAL(serialTokens.usedSize + 1, tokenList.count);
+   CHECK_EQUAL(9, tokenList.tokens[0].line);
+   for(size_t i = 0; i < serialTokens.usedSize; i++)
+   {
+      List_At(&serialTokens.interface, i, (void **)&expected);
+      CHECK_EQUAL(expected->type, tokenList.tokens[i + 1].type);
+      CHECK_EQUAL(expected->lexeme, tokenList.tokens[i + 1].lexeme);
+      CHECK_EQUAL(expected->length, tokenList.tokens[i + 1].length);
+      CHECK_EQUAL(expected->line, tokenList.tokens[i + 1].line);
+   }
+
+   TokenList_Deinit(&tokenList);
+}
+
+TEST(Lexer_Parallel, LargeSourceMatchesSerialLexer)
+{
+   const char *lines[] = { "x: int = 5\n", "print \"hi\" .. y\n", ":sym <= 0.25\n", "\"split\nstring\" ~\n", "b@d;\n" };
+   size_t size = 4 * LEXER_PARALLEL_MIN_CHUNK_SIZE + 100;
+   char *source = (char *)malloc(size + 32);
+   size_t used = 0;
+
+   for(size_t i = 0; used < size; i = (i * 7 + 3) % 5)
+   {
+      used += sprintf(&source[used], "%s", lines[i]);
+   }
+
+   TheOutputShouldMatchTheSerialLexer(source);
+   free(source);
+}
@@ -7,6 +7,7 @@ extern "C"
 #include <string.h>
 #include "Lexer_StaticLookup.h"
 #include "List_Calloc.h"
+#include "Error_Buffer.h"
 #include "Token.h"
 }
 
@@ -27,6 +28,7 @@ TEST_GROUP(Lexer_StaticLookup)
 
    void teardown()
    {
+      Lexer_StaticLookup_Deinit(&lexer);
       List_Calloc_Deinit(&tokens);
 
       mock().checkExpectations();
@@ -68,6 +70,24 @@ TEST_GROUP(Lexer_StaticLookup)
          TheTokenAtThisIndexShouldBe(i, &expectedTokens[i]);
       }
    }
+
+   // For tokens whose lexeme was copied out of the chunks they came from
+   void TheTokenAtThisIndexShouldRead(size_t index, Token_Type_t type, const char *lexeme, size_t line)
+   {
+      Token_t *actualToken;
+      List_At(&tokens.interface, index, (void **)&actualToken);
+      CHECK_EQUAL(type, actualToken->type);
+      CHECK_EQUAL(strlen(lexeme), actualToken->length);
+      MEMCMP_EQUAL(lexeme, actualToken->lexeme, actualToken->length);
+      CHECK_EQUAL(line, actualToken->line);
+   }
+
+   void TheNumberOfTokensShouldBe(size_t count)
+   {
+      Token_t *token;
+      List_At(&tokens.interface, count, (void **)&token);
+      POINTERS_EQUAL(NULL, token);
+   }
 };
 
 /***************************
@@ -171,6 +191,449 @@ TEST(Lexer_StaticLookup, RecognizesNumberLiterals)
    TheResultingTokensShouldBe(expectedTokens, 6);
 }
 
+/***************************
+* Length-aware lexing
+***************************/
+TEST(Lexer_StaticLookup, LexSpanStopsAtLengthWithoutNullTerminator)
+{
+   const char source[] = { 'w', 'o', 'r', 'd', ' ', '1', '2', '3', '4', '5' };
+   const Token_t expectedTokens[] = {
+      { Token_Type_Identifier,     &source[0], 4, 1 },
+      { Token_Type_Literal_Number, &source[5], 2, 1 }
+   };
+
+   Lexer_LexSpan(&lexer.interface, source, 7, &tokens.interface);
+   TheResultingTokensShouldBe(expectedTokens, 2);
+}
+
+TEST(Lexer_StaticLookup, LexSpanTreatsEndOfSpanLikeEndOfString)
+{
+   const char *source = "x: \"cut off\" <= ";
+   const Token_t expectedTokens[] = {
+      { Token_Type_Identifier, &source[0], 1, 1 },
+      { Token_Type_Colon,      &source[1], 1, 1 },
+      { Token_Type_Unused,     NULL,       0, 0 }
+   };
+
+   ShouldReportThisError(1, "String literal missing ending \"");
+   Lexer_LexSpan(&lexer.interface, source, 8, &tokens.interface);
+   TheResultingTokensShouldBe(expectedTokens, 2);
+}
+
+TEST(Lexer_StaticLookup, LexSpanReportsNullCharactersInsideTheSpan)
+{
+   const char source[] = { 'a', '\0', 'b' };
+   const Token_t expectedTokens[] = {
+      { Token_Type_Identifier, &source[0], 1, 1 },
+      { Token_Type_Identifier, &source[2], 1, 1 }
+   };
+
+   ShouldReportThisError(1, "Unexpected non-printable character");
+   Lexer_LexSpan(&lexer.interface, source, 3, &tokens.interface);
+   TheResultingTokensShouldBe(expectedTokens, 2);
+}
+
+TEST(Lexer_StaticLookup, LexSpanKeepsNullCharactersInsideStrings)
+{
+   const char source[] = { 'a', ' ', '"', 'x', '\0', 'y', '"', ' ', 'b' };
+   const Token_t expectedTokens[] = {
+      { Token_Type_Identifier,     &source[0], 1, 1 },
+      { Token_Type_Literal_String, &source[2], 5, 1 },
+      { Token_Type_Identifier,     &source[8], 1, 1 }
+   };
+
+   Lexer_LexSpan(&lexer.interface, source, sizeof(source), &tokens.interface);
+   CHECK_EQUAL(3, tokens.usedSize);
+   TheResultingTokensShouldBe(expectedTokens, 3);
+}
+
+/***************************
+* Line index instead of token lines
+***************************/
+TEST(Lexer_StaticLookup, WithALineIndexTokensHaveNoLineButCanBeLocated)
+{
+   const char *source = "x = 1\n  y: \"two\"\n;";
+   const Token_t expectedTokens[] = {
+      { Token_Type_Identifier,     &source[0],  1, 0 },
+      { Token_Type_Equal,          &source[2],  1, 0 },
+      { Token_Type_Literal_Number, &source[4],  1, 0 },
+      { Token_Type_Identifier,     &source[8],  1, 0 },
+      { Token_Type_Colon,          &source[9],  1, 0 },
+      { Token_Type_Literal_String, &source[11], 5, 0 }
+   };
+   LineIndex_t lineIndex;
+   size_t line;
+   size_t column;
+
+   LineIndex_Init(&lineIndex);
+   Lexer_StaticLookup_SetLineIndex(&lexer, &lineIndex);
+
+   ShouldReportThisError(3, "Unexpected character ';'");
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+   TheResultingTokensShouldBe(expectedTokens, 6);
+
+   LineIndex_Locate(&lineIndex, 11, &line, &column);
+   CHECK_EQUAL(2, line);
+   CHECK_EQUAL(6, column);
+
+   LineIndex_Deinit(&lineIndex);
+}
+
+TEST(Lexer_StaticLookup, WithALineIndexNewlinesInsideStringsAreIndexed)
+{
+   const char *source = "a \"b\nc\nd\" ;\ne";
+   LineIndex_t lineIndex;
+   size_t line;
+   size_t column;
+
+   LineIndex_Init(&lineIndex);
+   Lexer_StaticLookup_SetLineIndex(&lexer, &lineIndex);
+
+   ShouldReportThisError(1, "String literal not contained on one line.");
+   ShouldReportThisError(2, "String literal not contained on one line.");
+   ShouldReportThisError(3, "Unexpected character ';'");
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+
+   CHECK_EQUAL(3, lineIndex.count);
+   LineIndex_Locate(&lineIndex, 12, &line, &column);
+   CHECK_EQUAL(4, line);
+   CHECK_EQUAL(1, column);
+
+   LineIndex_Deinit(&lineIndex);
+}
+
+/***************************
+* Bracket matching
+***************************/
+TEST(Lexer_StaticLookup, BracketIndexMatchesEachOpenerToItsCloser)
+{
+   // Tokens: f ( a , [ b ] ) { c }
+   BracketIndex_t brackets;
+
+   BracketIndex_Init(&brackets);
+   Lexer_StaticLookup_SetBracketIndex(&lexer, &brackets);
+   Lexer_Lex(&lexer.interface, "f(a, [b])\n{ c }", &tokens.interface);
+
+   CHECK_EQUAL(3, brackets.count);
+   CHECK_EQUAL(1, brackets.entries[0].open);
+   CHECK_EQUAL(7, brackets.entries[0].close);
+   CHECK_EQUAL(0, brackets.entries[0].depth);
+   CHECK_EQUAL(4, brackets.entries[1].open);
+   CHECK_EQUAL(6, brackets.entries[1].close);
+   CHECK_EQUAL(1, brackets.entries[1].depth);
+   CHECK_EQUAL(8, brackets.entries[2].open);
+   CHECK_EQUAL(10, brackets.entries[2].close);
+   CHECK_EQUAL(0, brackets.entries[2].depth);
+
+   BracketIndex_Deinit(&brackets);
+}
+
+TEST(Lexer_StaticLookup, BracketIndexReportsUnmatchedAndUnclosedBrackets)
+{
+   BracketIndex_t brackets;
+
+   BracketIndex_Init(&brackets);
+   Lexer_StaticLookup_SetBracketIndex(&lexer, &brackets);
+
+   // The ']' closes the '[' on line 2, leaving the '(' inside it unclosed
+   ShouldReportThisError(1, "Unmatched ')'");
+   ShouldReportThisError(3, "Unclosed '('");
+   ShouldReportThisError(1, "Unclosed '{'");
+   Lexer_Lex(&lexer.interface, "a) {\n[\n(b]", &tokens.interface);
+
+   CHECK_EQUAL(3, brackets.count);
+   CHECK_EQUAL(BRACKETINDEX_NONE, brackets.entries[0].close);
+   CHECK_EQUAL(6, brackets.entries[1].close);
+   CHECK_EQUAL(BRACKETINDEX_NONE, brackets.entries[2].close);
+   CHECK_EQUAL(0, brackets.stackCount);
+
+   BracketIndex_Deinit(&brackets);
+}
+
+TEST(Lexer_StaticLookup, BracketIndexStartsAgainForEachSource)
+{
+   BracketIndex_t brackets;
+
+   BracketIndex_Init(&brackets);
+   Lexer_StaticLookup_SetBracketIndex(&lexer, &brackets);
+   Lexer_Lex(&lexer.interface, "(a)", &tokens.interface);
+   Lexer_Lex(&lexer.interface, "b [c]", &tokens.interface);
+
+   CHECK_EQUAL(1, brackets.count);
+   CHECK_EQUAL(1, brackets.entries[0].open);
+   CHECK_EQUAL(3, brackets.entries[0].close);
+
+   BracketIndex_Deinit(&brackets);
+}
+
+/***************************
+* Number values
+***************************/
+TEST(Lexer_StaticLookup, NumberTableGetsTheValueOfEachNumber)
+{
+   // Tokens: x = 12 + 0.5 * 6' - 18446744073709551616
+   NumberTable_t numbers;
+
+   NumberTable_Init(&numbers);
+   Lexer_StaticLookup_SetNumberTable(&lexer, &numbers);
+   Lexer_Lex(&lexer.interface, "x = 12 + 0.5 * 6' - 18446744073709551616", &tokens.interface);
+
+   CHECK_EQUAL(4, numbers.count);
+   CHECK_EQUAL(2, numbers.entries[0].token);
+   CHECK_EQUAL(12, numbers.entries[0].value.integer);
+   CHECK_EQUAL(4, numbers.entries[1].token);
+   DOUBLES_EQUAL(0.5, numbers.entries[1].value.real, 0);
+   CHECK_EQUAL(6, numbers.entries[2].token);
+   CHECK_EQUAL(NumberTable_Kind_Bytes, numbers.entries[2].kind);
+   CHECK_EQUAL(8, numbers.entries[3].token);
+   CHECK_EQUAL(NumberTable_Kind_Big, numbers.entries[3].kind);
+
+   Lexer_Lex(&lexer.interface, "y", &tokens.interface);
+   CHECK_EQUAL(0, numbers.count);
+
+   NumberTable_Deinit(&numbers);
+}
+
+/***************************
+* Typed token list
+***************************/
+TEST(Lexer_StaticLookup, TokenListGetsTheSameTokensWithoutTheInterface)
+{
+   const char *source = "x: int = 5 \ny: int = 10\n print x + y";
+   TokenList_t typed;
+   Token_t *expected;
+
+   TokenList_Init(&typed);
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+   Lexer_Lex(&lexer.interface, source, &typed.interface);
+
+   CHECK_EQUAL(tokens.usedSize, typed.count);
+   for(size_t i = 0; i < typed.count; i++)
+   {
+      List_At(&tokens.interface, i, (void **)&expected);
+      CHECK_EQUAL(expected->type, typed.tokens[i].type);
+      CHECK_EQUAL(expected->lexeme, typed.tokens[i].lexeme);
+      CHECK_EQUAL(expected->length, typed.tokens[i].length);
+      CHECK_EQUAL(expected->line, typed.tokens[i].line);
+   }
+
+   TokenList_Deinit(&typed);
+}
+
+TEST(Lexer_StaticLookup, TokenListCanBeStreamedInto)
+{
+   TokenList_t typed;
+
+   TokenList_Init(&typed);
+   Lexer_StaticLookup_Begin(&lexer, &typed.interface);
+   Lexer_StaticLookup_Feed(&lexer, "one tw", 6);
+   Lexer_StaticLookup_Feed(&lexer, "o three", 7);
+   Lexer_StaticLookup_End(&lexer);
+
+   CHECK_EQUAL(3, typed.count);
+   CHECK_EQUAL(3, typed.tokens[1].length);
+   CHECK(strncmp("two", typed.tokens[1].lexeme, 3) == 0);
+
+   TokenList_Deinit(&typed);
+}
+
+/***************************
+* Streaming
+***************************/
+TEST(Lexer_StaticLookup, StreamedTokensPointIntoTheirChunk)
+{
+   const char *first = "x = 1\n";
+   const char *second = "y = \"two\" ";
+   const Token_t expectedTokens[] = {
+      { Token_Type_Identifier,     &first[0],  1, 1 },
+      { Token_Type_Equal,          &first[2],  1, 1 },
+      { Token_Type_Literal_Number, &first[4],  1, 1 },
+      { Token_Type_Identifier,     &second[0], 1, 2 },
+      { Token_Type_Equal,          &second[2], 1, 2 },
+      { Token_Type_Literal_String, &second[4], 5, 2 }
+   };
+
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   Lexer_StaticLookup_Feed(&lexer, first, strlen(first));
+   Lexer_StaticLookup_Feed(&lexer, second, strlen(second));
+   Lexer_StaticLookup_End(&lexer);
+
+   TheResultingTokensShouldBe(expectedTokens, 6);
+   TheNumberOfTokensShouldBe(6);
+}
+
+TEST(Lexer_StaticLookup, StreamedIdentifierSplitAcrossChunksIsJoined)
+{
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   Lexer_StaticLookup_Feed(&lexer, "one tw", 6);
+   Lexer_StaticLookup_Feed(&lexer, "o three", 7);
+   Lexer_StaticLookup_End(&lexer);
+
+   TheTokenAtThisIndexShouldRead(0, Token_Type_Identifier, "one", 1);
+   TheTokenAtThisIndexShouldRead(1, Token_Type_Identifier, "two", 1);
+   TheTokenAtThisIndexShouldRead(2, Token_Type_Identifier, "three", 1);
+   TheNumberOfTokensShouldBe(3);
+}
+
+TEST(Lexer_StaticLookup, StreamedDigraphIsNotSplitIntoTouchySymbols)
+{
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   Lexer_StaticLookup_Feed(&lexer, "x <", 3);
+   Lexer_StaticLookup_Feed(&lexer, "= y", 3);
+   Lexer_StaticLookup_End(&lexer);
+
+   TheTokenAtThisIndexShouldRead(0, Token_Type_Identifier, "x", 1);
+   TheTokenAtThisIndexShouldRead(1, Token_Type_LessEqual, "<=", 1);
+   TheTokenAtThisIndexShouldRead(2, Token_Type_Identifier, "y", 1);
+   TheNumberOfTokensShouldBe(3);
+}
+
+TEST(Lexer_StaticLookup, StreamEndAddsTheHeldBackToken)
+{
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   Lexer_StaticLookup_Feed(&lexer, "a 12", 4);
+   TheNumberOfTokensShouldBe(1);
+
+   Lexer_StaticLookup_End(&lexer);
+   TheTokenAtThisIndexShouldRead(1, Token_Type_Literal_Number, "12", 1);
+   TheNumberOfTokensShouldBe(2);
+}
+
+TEST(Lexer_StaticLookup, ReleasingSpilledLexemesReusesTheirMemory)
+{
+   Token_t *two;
+   Token_t *three;
+
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   Lexer_StaticLookup_Feed(&lexer, "one tw", 6);
+   Lexer_StaticLookup_Feed(&lexer, "o thr", 5);
+   List_At(&tokens.interface, 1, (void **)&two);
+   const char *spilled = two->lexeme;
+
+   Lexer_StaticLookup_ReleaseSpill(&lexer);
+   Lexer_StaticLookup_Feed(&lexer, "ee four", 7);
+   Lexer_StaticLookup_End(&lexer);
+
+   TheTokenAtThisIndexShouldRead(2, Token_Type_Identifier, "three", 1);
+   List_At(&tokens.interface, 2, (void **)&three);
+   POINTERS_EQUAL(spilled, three->lexeme);
+   TheNumberOfTokensShouldBe(4);
+}
+
+TEST(Lexer_StaticLookup, BeginReusesSpilledLexemeMemory)
+{
+   Token_t *token;
+
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   Lexer_StaticLookup_Feed(&lexer, "on", 2);
+   Lexer_StaticLookup_Feed(&lexer, "e ", 2);
+   List_At(&tokens.interface, 0, (void **)&token);
+   const char *spilled = token->lexeme;
+
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   Lexer_StaticLookup_Feed(&lexer, "tw", 2);
+   Lexer_StaticLookup_Feed(&lexer, "o ", 2);
+
+   TheTokenAtThisIndexShouldRead(1, Token_Type_Identifier, "two", 1);
+   List_At(&tokens.interface, 1, (void **)&token);
+   POINTERS_EQUAL(spilled, token->lexeme);
+}
+
+TEST(Lexer_StaticLookup, StreamedOneCharacterAtATimeMatchesWholeSource)
+{
+   const char *source = "s: \"a\nb\".5\n:sym";
+
+   ShouldReportThisError(1, "String literal not contained on one line.");
+   ShouldReportThisError(2, "Missing space before decimal number with no leading zero");
+
+   Lexer_StaticLookup_Begin(&lexer, &tokens.interface);
+   for(size_t i = 0; i < strlen(source); i++)
+   {
+      Lexer_StaticLookup_Feed(&lexer, &source[i], 1);
+   }
+   Lexer_StaticLookup_End(&lexer);
+
+   TheTokenAtThisIndexShouldRead(0, Token_Type_Identifier, "s", 1);
+   TheTokenAtThisIndexShouldRead(1, Token_Type_Colon, ":", 1);
+   TheTokenAtThisIndexShouldRead(2, Token_Type_Literal_String, "\"a\nb\"", 2);
+   TheTokenAtThisIndexShouldRead(3, Token_Type_Literal_Number, ".5", 2);
+   TheTokenAtThisIndexShouldRead(4, Token_Type_Literal_Symbol, ":sym", 3);
+   TheNumberOfTokensShouldBe(5);
+}
+
+/***************************
+* Pulling tokens one at a time
+***************************/
+TEST(Lexer_StaticLookup, PulledTokensMatchLexedTokens)
+{
+   const char *source = "x: int = 5\n:sym \"str\" % .5 <= a.b";
+   Token_t token;
+   size_t count = 0;
+
+   ShouldReportThisError(2, "Unexpected character '%'");
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+
+   ShouldReportThisError(2, "Unexpected character '%'");
+   Lexer_StaticLookup_Open(&lexer, source, strlen(source));
+   while(Lexer_StaticLookup_NextToken(&lexer, &token))
+   {
+      TheTokenAtThisIndexShouldBe(count++, &token);
+   }
+
+   TheNumberOfTokensShouldBe(count);
+}
+
+TEST(Lexer_StaticLookup, PeekingDoesNotTakeTokens)
+{
+   const char *source = "a b c";
+   Token_t token;
+
+   Lexer_StaticLookup_Open(&lexer, source, strlen(source));
+
+   CHECK_TRUE(Lexer_StaticLookup_PeekToken(&lexer, 1, &token));
+   POINTERS_EQUAL(&source[2], token.lexeme);
+   CHECK_TRUE(Lexer_StaticLookup_PeekToken(&lexer, 0, &token));
+   POINTERS_EQUAL(&source[0], token.lexeme);
+
+   CHECK_TRUE(Lexer_StaticLookup_NextToken(&lexer, &token));
+   POINTERS_EQUAL(&source[0], token.lexeme);
+   CHECK_TRUE(Lexer_StaticLookup_PeekToken(&lexer, 1, &token));
+   POINTERS_EQUAL(&source[4], token.lexeme);
+   CHECK_TRUE(Lexer_StaticLookup_NextToken(&lexer, &token));
+   POINTERS_EQUAL(&source[2], token.lexeme);
+   CHECK_TRUE(Lexer_StaticLookup_NextToken(&lexer, &token));
+   POINTERS_EQUAL(&source[4], token.lexeme);
+   CHECK_FALSE(Lexer_StaticLookup_NextToken(&lexer, &token));
+}
+
+TEST(Lexer_StaticLookup, PeekingPastTheEndOrTooFarFails)
+{
+   const char *source = "a b";
+   Token_t token;
+
+   Lexer_StaticLookup_Open(&lexer, source, strlen(source));
+
+   CHECK_FALSE(Lexer_StaticLookup_PeekToken(&lexer, 2, &token));
+   CHECK_FALSE(Lexer_StaticLookup_PeekToken(&lexer, LEXER_STATICLOOKUP_LOOKAHEAD, &token));
+   CHECK_TRUE(Lexer_StaticLookup_NextToken(&lexer, &token));
+   CHECK_TRUE(Lexer_StaticLookup_NextToken(&lexer, &token));
+   CHECK_FALSE(Lexer_StaticLookup_NextToken(&lexer, &token));
+}
+
+TEST(Lexer_StaticLookup, PullingAddsNothingToATokenList)
+{
+   const char *source = "a";
+   Token_t token;
+
+   Lexer_StaticLookup_Open(&lexer, "", 0);
+   CHECK_FALSE(Lexer_StaticLookup_NextToken(&lexer, &token));
+
+   Lexer_StaticLookup_Open(&lexer, source, 1);
+   CHECK_TRUE(Lexer_StaticLookup_NextToken(&lexer, &token));
+   CHECK_EQUAL(Token_Type_Identifier, token.type);
+   TheNumberOfTokensShouldBe(0);
+}
+
 /***************************
 * Special case characters
 ***************************/
@@ -204,6 +667,21 @@ TEST(Lexer_StaticLookup, SpecialCase_Colon)
    TheResultingTokensShouldBe(expectedTokens, 3);
 }
 
+TEST(Lexer_StaticLookup, SpecialCase_ColonWithoutSpaceAfter)
+{
+   const char *source = ":(x)";
+   const Token_t expectedTokens[] = {
+      { Token_Type_Colon,       &source[0], 1, 1},
+      { Token_Type_Paren_Left,  &source[1], 1, 1},
+      { Token_Type_Identifier,  &source[2], 1, 1},
+      { Token_Type_Paren_Right, &source[3], 1, 1}
+   };
+
+   ShouldReportThisError(1, "Missing space after ':'");
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+   TheResultingTokensShouldBe(expectedTokens, 4);
+}
+
 TEST(Lexer_StaticLookup, SpecialCase_Dash)
 {
    const char *source = "-one-name- - another-name";
@@ -444,3 +922,120 @@ TEST(Lexer_StaticLookup, CountsLineNumbers)
    Lexer_Lex(&lexer.interface, source, &tokens.interface);
    TheResultingTokensShouldBe(expectedTokens, 14);
 }
+
+#ifdef PARSER_STATS
+/***************************
+ * Instrumentation counters
+ ***************************/
+TEST(Lexer_StaticLookup, StatsCountHandlerCallsBytesAndTokens)
+{
+   const char *source = "foo = 12 + bar\n";
+   Lexer_StaticLookup_Stats_t stats = { 0 };
+
+   Lexer_StaticLookup_SetStats(&lexer, &stats);
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+
+   CHECK_EQUAL(2, stats.calls[Lexer_StaticLookup_Action_Identifier]);
+   CHECK_EQUAL(6, stats.bytes[Lexer_StaticLookup_Action_Identifier]);
+   CHECK_EQUAL(1, stats.calls[Lexer_StaticLookup_Action_NumberLiteralOrIdentifier]);
+   CHECK_EQUAL(2, stats.bytes[Lexer_StaticLookup_Action_NumberLiteralOrIdentifier]);
+   CHECK_EQUAL(4, stats.calls[Lexer_StaticLookup_Action_Ignore]);
+   CHECK_EQUAL(1, stats.calls[Lexer_StaticLookup_Action_IncrementLineCounter]);
+
+   CHECK_EQUAL(2, stats.tokens[Token_Type_Identifier]);
+   CHECK_EQUAL(1, stats.tokens[Token_Type_Literal_Number]);
+   CHECK_EQUAL(1, stats.tokens[Token_Type_Plus]);
+   CHECK_EQUAL(1, stats.tokens[Token_Type_Equal]);
+   CHECK_EQUAL(0, stats.starves);
+}
+
+TEST(Lexer_StaticLookup, StatsAreLeftAloneWhenNotSet)
+{
+   Lexer_StaticLookup_Stats_t stats = { 0 };
+
+   Lexer_StaticLookup_SetStats(&lexer, &stats);
+   Lexer_StaticLookup_SetStats(&lexer, NULL);
+   Lexer_Lex(&lexer.interface, "foo", &tokens.interface);
+
+   CHECK_EQUAL(0, stats.calls[Lexer_StaticLookup_Action_Identifier]);
+   CHECK_EQUAL(0, stats.tokens[Token_Type_Identifier]);
+}
+
+TEST(Lexer_StaticLookup, ActionNamesAreKnown)
+{
+   STRCMP_EQUAL("Identifier", Lexer_StaticLookup_ActionName(Lexer_StaticLookup_Action_Identifier));
+   STRCMP_EQUAL("StringLiteral", Lexer_StaticLookup_ActionName(Lexer_StaticLookup_Action_StringLiteral));
+}
+#endif
+
+/***************************
+ * Diagnostics sink
+ ***************************/
+TEST(Lexer_StaticLookup, DiagnosticsRecordErrorsInsteadOfReportingThem)
+{
+   const char *source = "a b %\nc";
+   Diagnostics_t diagnostics;
+   char message[64];
+
+   Diagnostics_Init(&diagnostics, 8, 0);
+   Lexer_StaticLookup_SetDiagnostics(&lexer, &diagnostics);
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+
+   CHECK_EQUAL(1, diagnostics.count);
+   CHECK_EQUAL(Diagnostic_Code_UnexpectedCharacter, Diagnostics_At(&diagnostics, 0)->code);
+   CHECK_EQUAL(4, Diagnostics_At(&diagnostics, 0)->offset);
+   Diagnostic_Format(Diagnostics_At(&diagnostics, 0), source, message, sizeof(message));
+   STRCMP_EQUAL("Unexpected character '%'", message);
+   CHECK_FALSE(Lexer_StaticLookup_Halted(&lexer));
+   CHECK_EQUAL(3, tokens.usedSize);
+
+   Diagnostics_Deinit(&diagnostics);
+}
+
+TEST(Lexer_StaticLookup, DiagnosticsStopTheLexerAtMaxErrors)
+{
+   Diagnostics_t diagnostics;
+
+   Diagnostics_Init(&diagnostics, 2, 2);
+   Lexer_StaticLookup_SetDiagnostics(&lexer, &diagnostics);
+   Lexer_Lex(&lexer.interface, "a % % % b", &tokens.interface);
+
+   CHECK_EQUAL(2, diagnostics.total);
+   CHECK_TRUE(Lexer_StaticLookup_Halted(&lexer));
+   CHECK_EQUAL(1, tokens.usedSize);
+
+   Diagnostics_Deinit(&diagnostics);
+}
+
+TEST(Lexer_StaticLookup, DiagnosticsMatchTheReportedMessages)
+{
+   const char *source = "5 \"x\n\" a:b=+ :1 .5 x:y ^ \x01 \xC3 -- :";
+   Error_Buffer_t reported;
+   Error_Buffer_t replayed;
+   Diagnostics_t diagnostics;
+   Lexer_StaticLookup_t reportingLexer;
+
+   Error_Buffer_Init(&reported);
+   Error_Buffer_Init(&replayed);
+   Diagnostics_Init(&diagnostics, 16, 0);
+
+   Lexer_StaticLookup_Init(&reportingLexer, &reported.interface);
+   Lexer_Lex(&reportingLexer.interface, source, &tokens.interface);
+   Lexer_StaticLookup_Deinit(&reportingLexer);
+
+   Lexer_StaticLookup_SetDiagnostics(&lexer, &diagnostics);
+   Lexer_Lex(&lexer.interface, source, &tokens.interface);
+   Diagnostics_Replay(&diagnostics, source, &replayed.interface);
+
+   CHECK(reported.count >= 8);
+   CHECK_EQUAL(reported.count, replayed.count);
+   for(size_t i = 0; i < reported.count; i++)
+   {
+      CHECK_EQUAL(reported.entries[i].line, replayed.entries[i].line);
+      STRCMP_EQUAL(&reported.text[reported.entries[i].message], &replayed.text[replayed.entries[i].message]);
+   }
+
+   Diagnostics_Deinit(&diagnostics);
+   Error_Buffer_Deinit(&replayed);
+   Error_Buffer_Deinit(&reported);
+}
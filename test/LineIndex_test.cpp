@@ -0,0 +1,77 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <string.h>
+   #include "LineIndex.h"
+}
+
+TEST_GROUP(LineIndex)
+{
+   LineIndex_t index;
+   const char *source;
+
+   void setup()
+   {
+      LineIndex_Init(&index);
+   }
+
+   void teardown()
+   {
+      LineIndex_Deinit(&index);
+   }
+
+   void GivenTheSource(const char *text)
+   {
+      source = text;
+      LineIndex_Build(&index, source, strlen(source));
+   }
+
+   void ThisOffsetShouldBeAt(size_t offset, size_t expectedLine, size_t expectedColumn)
+   {
+      size_t line;
+      size_t column;
+
+      LineIndex_Locate(&index, offset, &line, &column);
+      CHECK_EQUAL(expectedLine, line);
+      CHECK_EQUAL(expectedColumn, column);
+   }
+};
+
+TEST(LineIndex, SourceWithoutNewlinesIsAllLineOne)
+{
+   GivenTheSource("x = 5");
+
+   CHECK_EQUAL(0, index.count);
+   ThisOffsetShouldBeAt(0, 1, 1);
+   ThisOffsetShouldBeAt(4, 1, 5);
+}
+
+TEST(LineIndex, FindsLineAndColumnAfterNewlines)
+{
+   GivenTheSource("x = 5\ny = 10\n\n  print x");
+
+   CHECK_EQUAL(3, index.count);
+   ThisOffsetShouldBeAt(6, 2, 1);
+   ThisOffsetShouldBeAt(10, 2, 5);
+   ThisOffsetShouldBeAt(13, 3, 1);
+   ThisOffsetShouldBeAt(16, 4, 3);
+}
+
+TEST(LineIndex, NewlineBelongsToTheLineItEnds)
+{
+   GivenTheSource("ab\ncd\n");
+
+   ThisOffsetShouldBeAt(2, 1, 3);
+   ThisOffsetShouldBeAt(5, 2, 3);
+   ThisOffsetShouldBeAt(6, 3, 1);
+}
+
+TEST(LineIndex, RebuildingReplacesTheIndex)
+{
+   GivenTheSource("\n\n\n\n");
+   GivenTheSource("a\nb");
+
+   CHECK_EQUAL(1, index.count);
+   ThisOffsetShouldBeAt(2, 2, 1);
+}
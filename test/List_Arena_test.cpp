@@ -0,0 +1,137 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <stdint.h>
+   #include <string.h>
+   #include "List_Arena.h"
+}
+
+#define ITEM_SIZE (10)
+
+typedef struct
+{
+   uint8_t byte[ITEM_SIZE];
+} Item_t;
+
+TEST_GROUP(List_Arena)
+{
+   List_Arena_t list;
+   Item_t *readItem;
+   Item_t dummyItem;
+
+   void setup()
+   {
+      List_Arena_Init(&list, sizeof(Item_t));
+      readItem = NULL;
+      memset((void *)&dummyItem, 0xAC, ITEM_SIZE);
+   }
+
+   void teardown()
+   {
+      List_Arena_Deinit(&list);
+   }
+
+   void AfterSettingTheReadItemToADummyAddress()
+   {
+      readItem = &dummyItem;
+   }
+
+   void TheReadItemShouldPointTo(Item_t *expectedItem)
+   {
+      CHECK_EQUAL(expectedItem, readItem);
+   }
+
+   void TheReadItemShouldEqual(Item_t expectedItem)
+   {
+      MEMCMP_EQUAL(&expectedItem, readItem, ITEM_SIZE)
+   }
+
+   // Enough items to need several slabs
+   size_t ItemsInThreeSlabs()
+   {
+      return (3 * LIST_ARENA_SLAB_SIZE / ITEM_SIZE) + 1;
+   }
+};
+
+TEST(List_Arena, EmptyListReturnsNullAtIndex0)
+{
+   AfterSettingTheReadItemToADummyAddress();
+   List_At(&list.interface, 0, (void **)&readItem);
+   TheReadItemShouldPointTo(NULL);
+}
+
+TEST(List_Arena, ListWithTwoAddedItemsReturnsThatItemAtIndex0and1)
+{
+   List_Add(&list.interface, (void *)&dummyItem);
+   List_Add(&list.interface, (void *)&dummyItem);
+
+   List_At(&list.interface, 0, (void **)&readItem);
+   TheReadItemShouldEqual(dummyItem);
+
+   List_At(&list.interface, 1, (void **)&readItem);
+   TheReadItemShouldEqual(dummyItem);
+
+   List_At(&list.interface, 2, (void **)&readItem);
+   TheReadItemShouldPointTo(NULL);
+}
+
+TEST(List_Arena, ItemsKeepTheirAddressWhileMoreAreAdded)
+{
+   Item_t *first;
+   Item_t item;
+
+   List_Add(&list.interface, (void *)&dummyItem);
+   List_At(&list.interface, 0, (void **)&first);
+
+   for(size_t i = 1; i < ItemsInThreeSlabs(); i++)
+   {
+      memset(&item, (uint8_t)i, ITEM_SIZE);
+      List_Add(&list.interface, (void *)&item);
+   }
+
+   List_At(&list.interface, 0, (void **)&readItem);
+   TheReadItemShouldPointTo(first);
+   TheReadItemShouldEqual(dummyItem);
+
+   for(size_t i = 1; i < ItemsInThreeSlabs(); i++)
+   {
+      memset(&item, (uint8_t)i, ITEM_SIZE);
+      List_At(&list.interface, i, (void **)&readItem);
+      TheReadItemShouldEqual(item);
+   }
+}
+
+TEST(List_Arena, SetAtHighIndexResizesTheList)
+{
+   Item_t zero;
+   memset(&zero, 0, ITEM_SIZE);
+
+   List_Set(&list.interface, ItemsInThreeSlabs(), (void *)&dummyItem);
+   List_At(&list.interface, ItemsInThreeSlabs(), (void **)&readItem);
+   TheReadItemShouldEqual(dummyItem);
+
+   List_At(&list.interface, 20, (void **)&readItem);
+   TheReadItemShouldEqual(zero);
+
+   List_At(&list.interface, ItemsInThreeSlabs() + 1, (void **)&readItem);
+   TheReadItemShouldPointTo(NULL);
+}
+
+TEST(List_Arena, ResetEmptiesTheListAndReusesItsSlabs)
+{
+   Item_t *first;
+
+   List_Add(&list.interface, (void *)&dummyItem);
+   List_At(&list.interface, 0, (void **)&first);
+   List_Arena_Reset(&list);
+
+   AfterSettingTheReadItemToADummyAddress();
+   List_At(&list.interface, 0, (void **)&readItem);
+   TheReadItemShouldPointTo(NULL);
+
+   List_Add(&list.interface, (void *)&dummyItem);
+   List_At(&list.interface, 0, (void **)&readItem);
+   TheReadItemShouldPointTo(first);
+   CHECK_EQUAL(1, list.slabCount);
+}
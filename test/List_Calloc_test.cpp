@@ -91,3 +91,17 @@ TEST(List_Calloc, SetAtHighIndexResizesTheListTo)
    List_At(&list.interface, 21, (void **)&readItem);
    TheReadItemShouldPointTo(NULL);
 }
+
+#ifdef PARSER_STATS
+TEST(List_Calloc, StatsCountGrowthOfTheStorage)
+{
+   for(int i = 0; i < 100; i++)
+   {
+      List_Add(&list.interface, (void *)&dummyItem);
+   }
+
+   CHECK(list.stats.grows > 0);
+   CHECK(list.stats.moves <= list.stats.grows);
+   CHECK(list.stats.peakBytes >= 100 * list.itemSize);
+}
+#endif
@@ -0,0 +1,176 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <string.h>
+   #include <stdint.h>
+   #include "NumberTable.h"
+}
+
+TEST_GROUP(NumberTable)
+{
+   NumberTable_t table;
+   char digits[128];
+
+   void setup()
+   {
+      NumberTable_Init(&table);
+   }
+
+   void teardown()
+   {
+      NumberTable_Deinit(&table);
+   }
+
+   const NumberTable_Entry_t *Decode(const char *lexeme)
+   {
+      NumberTable_Add(&table, (uint32_t)table.count, lexeme, strlen(lexeme));
+      return &table.entries[table.count - 1];
+   }
+
+   void ThisShouldBeAnInteger(const char *lexeme, uint64_t expected)
+   {
+      const NumberTable_Entry_t *entry = Decode(lexeme);
+
+      CHECK_EQUAL(NumberTable_Kind_Integer, entry->kind);
+      CHECK_EQUAL(expected, entry->value.integer);
+   }
+
+   void ThisShouldBeAReal(const char *lexeme, double expected)
+   {
+      const NumberTable_Entry_t *entry = Decode(lexeme);
+
+      CHECK_EQUAL(NumberTable_Kind_Real, entry->kind);
+      // Exactly the nearest double, not just close to it
+      CHECK(expected == entry->value.real);
+   }
+
+   void ThisShouldBeBig(const char *lexeme, const char *expectedDigits, int32_t expectedExponent)
+   {
+      const NumberTable_Entry_t *entry = Decode(lexeme);
+
+      CHECK_EQUAL(NumberTable_Kind_Big, entry->kind);
+      CHECK_EQUAL(strlen(expectedDigits), NumberTable_Digits(&table, entry, digits, sizeof(digits)));
+      STRCMP_EQUAL(expectedDigits, digits);
+      CHECK_EQUAL(expectedExponent, table.bigs[entry->value.big].exponent);
+      CHECK(strtod(lexeme, NULL) == NumberTable_Real(&table, entry));
+   }
+};
+
+TEST(NumberTable, ReadsSmallIntegers)
+{
+   ThisShouldBeAnInteger("0", 0);
+   ThisShouldBeAnInteger("7", 7);
+   ThisShouldBeAnInteger("1024", 1024);
+   ThisShouldBeAnInteger("000012", 12);
+}
+
+TEST(NumberTable, ReadsEightDigitsAtATime)
+{
+   ThisShouldBeAnInteger("12345678", 12345678);
+   ThisShouldBeAnInteger("98765432123", 98765432123ULL);
+   ThisShouldBeAnInteger("1234567890123456789", 1234567890123456789ULL);
+}
+
+TEST(NumberTable, ReadsIntegersUpToTheLargestThatFits)
+{
+   ThisShouldBeAnInteger("10000000000000000000", 10000000000000000000ULL);
+   ThisShouldBeAnInteger("18446744073709551615", UINT64_MAX);
+   ThisShouldBeAnInteger("0000000000000000000000018446744073709551615", UINT64_MAX);
+}
+
+TEST(NumberTable, KeepsIntegersThatDoNotFitAsDigits)
+{
+   ThisShouldBeBig("18446744073709551616", "18446744073709551616", 0);
+   ThisShouldBeBig("99999999999999999999", "99999999999999999999", 0);
+   ThisShouldBeBig("21746193741239461329847163601503086535018237563285761", "21746193741239461329847163601503086535018237563285761", 0);
+}
+
+TEST(NumberTable, TrailingZerosOfBigNumbersGoInTheExponent)
+{
+   ThisShouldBeBig("1000000000000000000000000000000", "1", 30);
+   ThisShouldBeBig("123450000000000000000000.000", "12345", 19);
+}
+
+TEST(NumberTable, ReadsDecimals)
+{
+   ThisShouldBeAReal("3.25", 3.25);
+   ThisShouldBeAReal(".5", 0.5);
+   ThisShouldBeAReal("5.", 5.0);
+   ThisShouldBeAReal("0.0", 0.0);
+   ThisShouldBeAReal("0.1", 0.1);
+   ThisShouldBeAReal("1.50000000000000000000000000", 1.5);
+   ThisShouldBeAReal("0.000000000000000000000000000001", 1e-30);
+}
+
+TEST(NumberTable, RoundsDecimalsOutsideTheFastPathCorrectly)
+{
+   ThisShouldBeAReal("123456789.123456789", 123456789.123456789);
+   ThisShouldBeAReal("9007199254740993.0", 9007199254740993.0);
+   ThisShouldBeAReal("0.0000000000000000000000001", 1e-25);
+}
+
+TEST(NumberTable, KeepsDecimalsWithTooManyDigitsAsDigits)
+{
+   ThisShouldBeBig("21746193741239461329847163601503086535018237563285761.", "21746193741239461329847163601503086535018237563285761", 0);
+   ThisShouldBeBig("3.14159265358979323846264338327950288", "314159265358979323846264338327950288", -35);
+   ThisShouldBeBig(".000123456789012345678901", "123456789012345678901", -24);
+}
+
+TEST(NumberTable, DecodesWidths)
+{
+   Decode("6'");
+   Decode("3\"");
+
+   CHECK_EQUAL(NumberTable_Kind_Bytes, table.entries[0].kind);
+   CHECK_EQUAL(6, table.entries[0].value.integer);
+   CHECK_EQUAL(NumberTable_Kind_Bits, table.entries[1].kind);
+   CHECK_EQUAL(3, table.entries[1].value.integer);
+}
+
+TEST(NumberTable, WidthsThatDoNotFitAreTheLargestInteger)
+{
+   const NumberTable_Entry_t *entry = Decode("123456789012345678901234567890'");
+
+   CHECK_EQUAL(NumberTable_Kind_Bytes, entry->kind);
+   CHECK_EQUAL(UINT64_MAX, entry->value.integer);
+}
+
+TEST(NumberTable, AnyKindCanBeReadAsADouble)
+{
+   DOUBLES_EQUAL(42.0, NumberTable_Real(&table, Decode("42")), 0);
+   DOUBLES_EQUAL(0.25, NumberTable_Real(&table, Decode(".25")), 0);
+   DOUBLES_EQUAL(8.0, NumberTable_Real(&table, Decode("8\"")), 0);
+   DOUBLES_EQUAL(1e25, NumberTable_Real(&table, Decode("10000000000000000000000000")), 0);
+}
+
+TEST(NumberTable, DigitsAreCutToFitTheBuffer)
+{
+   const NumberTable_Entry_t *entry = Decode("123456789012345678901234");
+
+   CHECK_EQUAL(24, NumberTable_Digits(&table, entry, digits, 6));
+   STRCMP_EQUAL("12345", digits);
+   CHECK_EQUAL(24, NumberTable_Digits(&table, entry, NULL, 0));
+}
+
+TEST(NumberTable, FindsTheEntryOfAToken)
+{
+   NumberTable_Add(&table, 3, "1", 1);
+   NumberTable_Add(&table, 8, "2.5", 3);
+   NumberTable_Add(&table, 20, "4'", 2);
+
+   CHECK_EQUAL(NumberTable_Kind_Real, NumberTable_Find(&table, 8)->kind);
+   CHECK_EQUAL(4, NumberTable_Find(&table, 20)->value.integer);
+   POINTERS_EQUAL(NULL, NumberTable_Find(&table, 4));
+   POINTERS_EQUAL(NULL, NumberTable_Find(&table, 21));
+}
+
+TEST(NumberTable, ClearForgetsEverything)
+{
+   Decode("123456789012345678901234");
+   NumberTable_Clear(&table);
+
+   CHECK_EQUAL(0, table.count);
+   CHECK_EQUAL(0, table.bigCount);
+   CHECK_EQUAL(0, table.digitBytes);
+}
@@ -0,0 +1,169 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <stdio.h>
+   #include <stdlib.h>
+   #include <string.h>
+   #include "Parser_Parallel.h"
+   #include "Parser.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "Error_Buffer.h"
+   #include "Token.h"
+}
+
+TEST_GROUP(Parser_Parallel)
+{
+   Error_Buffer_t lexerErrors;
+   Error_Buffer_t serialErrors;
+   Error_Buffer_t parallelErrors;
+   List_Calloc_t tokens;
+   Lexer_StaticLookup_t lexer;
+   Parser_t serialParser;
+   Parser_Parallel_t parallelParser;
+
+   void setup()
+   {
+      Error_Buffer_Init(&lexerErrors);
+      Error_Buffer_Init(&serialErrors);
+      Error_Buffer_Init(&parallelErrors);
+      List_Calloc_Init(&tokens, sizeof(Token_t));
+      Lexer_StaticLookup_Init(&lexer, &lexerErrors.interface);
+      Parser_Init(&serialParser, &serialErrors.interface);
+      Parser_Parallel_Init(&parallelParser, &parallelErrors.interface, 4);
+   }
+
+   void teardown()
+   {
+      Parser_Parallel_Deinit(&parallelParser);
+      Parser_Deinit(&serialParser);
+      Lexer_StaticLookup_Deinit(&lexer);
+      List_Calloc_Deinit(&tokens);
+      Error_Buffer_Deinit(&parallelErrors);
+      Error_Buffer_Deinit(&serialErrors);
+      Error_Buffer_Deinit(&lexerErrors);
+   }
+
+   // Split even tiny sources into as many parts as there are threads
+   void WithChunksOfAtLeast(size_t count)
+   {
+      parallelParser.minChunkTokens = count;
+   }
+
+   void TheTreeShouldMatchTheSerialParser(const char *source)
+   {
+      const Parser_t *parallel = &parallelParser.parser;
+      uint32_t serialRoot;
+      uint32_t parallelRoot;
+
+      Lexer_Lex(&lexer.interface, source, &tokens.interface);
+      serialRoot = Parser_Parse(&serialParser, (Token_t *)tokens.storage, tokens.usedSize);
+      parallelRoot = Parser_Parallel_Parse(&parallelParser, (Token_t *)tokens.storage, tokens.usedSize);
+
+      CHECK_EQUAL(serialRoot, parallelRoot);
+      CHECK_EQUAL(serialParser.nodeCount, parallel->nodeCount);
+      for(uint32_t i = 0; i < serialParser.nodeCount; i++)
+      {
+         const Parser_Node_t *expected = Parser_Node(&serialParser, i);
+         const Parser_Node_t *actual = Parser_Node(parallel, i);
+
+         CHECK_EQUAL(expected->kind, actual->kind);
+         CHECK_EQUAL(expected->op, actual->op);
+         CHECK_EQUAL(expected->token, actual->token);
+         CHECK_EQUAL(expected->first, actual->first);
+         CHECK_EQUAL(expected->next, actual->next);
+      }
+
+      CHECK_EQUAL(serialParser.errorCount, parallel->errorCount);
+      CHECK_EQUAL(serialErrors.count, parallelErrors.count);
+      for(size_t i = 0; i < serialErrors.count; i++)
+      {
+         CHECK_EQUAL(serialErrors.entries[i].line, parallelErrors.entries[i].line);
+         STRCMP_EQUAL(&serialErrors.text[serialErrors.entries[i].message], &parallelErrors.text[parallelErrors.entries[i].message]);
+      }
+   }
+};
+
+TEST(Parser_Parallel, SmallSourceIsParsedOnOneThread)
+{
+   TheTreeShouldMatchTheSerialParser("func f(a) {\n   return a\n}\nfunc g() {\n}\n");
+   CHECK_EQUAL(1, parallelParser.chunkCount);
+}
+
+TEST(Parser_Parallel, SplitsBetweenTopLevelBlocks)
+{
+   WithChunksOfAtLeast(1);
+   TheTreeShouldMatchTheSerialParser("func f(a) {\n   return a\n}\nfunc g() {\n   x = [1, 2]\n}\n"
+                                     "func h() { y }\nz = { 1 }\nprint z\n");
+   CHECK_EQUAL(4, parallelParser.chunkCount);
+}
+
+TEST(Parser_Parallel, DoesNotSplitWhereTheStatementCarriesOn)
+{
+   WithChunksOfAtLeast(1);
+   TheTreeShouldMatchTheSerialParser("a = { 1 } + { 2 } +\n   3\nb = { 3 } c\nd = f({\n 4\n})\n");
+   CHECK_EQUAL(1, parallelParser.chunkCount);
+}
+
+TEST(Parser_Parallel, EmptyPartsAreSkippedWhenLinking)
+{
+   WithChunksOfAtLeast(1);
+   TheTreeShouldMatchTheSerialParser("{ a }\n{ b }\n, ,\n");
+}
+
+TEST(Parser_Parallel, ErrorsAreReportedInOrder)
+{
+   WithChunksOfAtLeast(1);
+   TheTreeShouldMatchTheSerialParser("{ a = * 2 }\n{ b +\n}\n{ ) }\n{ c = (1, }\n");
+}
+
+TEST(Parser_Parallel, StopsSplittingAfterAMismatchedBracket)
+{
+   WithChunksOfAtLeast(1);
+   TheTreeShouldMatchTheSerialParser("{ a }\n{ b ]\n}\n{ c }\n{ d }\n");
+   CHECK_EQUAL(2, parallelParser.chunkCount);
+}
+
+TEST(Parser_Parallel, NestingTooDeeplyIsOnlyReportedOnce)
+{
+   char source[12 * PARSER_MAX_DEPTH];
+   size_t used = 0;
+
+   WithChunksOfAtLeast(1);
+   for(int block = 0; block < 4; block++)
+   {
+      used += sprintf(&source[used], "{ ");
+      for(int i = 0; i < PARSER_MAX_DEPTH; i++)
+      {
+         used += sprintf(&source[used], "- ");
+      }
+      used += sprintf(&source[used], " x }\n");
+   }
+
+   TheTreeShouldMatchTheSerialParser(source);
+   CHECK_EQUAL(4, parallelParser.chunkCount);
+}
+
+TEST(Parser_Parallel, LargeSourceMatchesSerialParser)
+{
+   const char *definitions[] = {
+      "func add(a, b) {\n   return a + b\n}\n",
+      "x: int = 5\n",
+      "if x != 0 {\n   y = [1, 2, f(x)]\n   print y\n}\n",
+      "table = {\n   :one = 1\n   :two = (2, 3)\n}\n",
+      "z = (\n   1 +\n   2 *\n)\n"
+   };
+   size_t size = 4 * 32 * PARSER_PARALLEL_MIN_CHUNK_TOKENS;
+   char *source = (char *)malloc(size + 64);
+   size_t used = 0;
+
+   for(size_t i = 0; used < size; i = (i * 7 + 3) % 5)
+   {
+      used += sprintf(&source[used], "%s", definitions[i]);
+   }
+
+   TheTreeShouldMatchTheSerialParser(source);
+   CHECK_EQUAL(4, parallelParser.chunkCount);
+   free(source);
+}
@@ -0,0 +1,339 @@
+#include "TestHarness.h"
+#include "MockSupport.h"
+#include "Error_Mock.h"
+
+extern "C"
+{
+   #include <string.h>
+   #include "Parser.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "Error_Buffer.h"
+   #include "Token.h"
+}
+
+TEST_GROUP(Parser)
+{
+   Error_Buffer_t lexerErrors;
+   Error_Mock_t errorMock;
+   List_Calloc_t tokens;
+   Lexer_StaticLookup_t lexer;
+   Parser_t parser;
+   char tree[4096];
+
+   void setup()
+   {
+      Error_Buffer_Init(&lexerErrors);
+      Error_Mock_Init(&errorMock);
+      List_Calloc_Init(&tokens, sizeof(Token_t));
+      Lexer_StaticLookup_Init(&lexer, &lexerErrors.interface);
+      Parser_Init(&parser, &errorMock.interface);
+
+      mock().strictOrder();
+   }
+
+   void teardown()
+   {
+      Parser_Deinit(&parser);
+      Lexer_StaticLookup_Deinit(&lexer);
+      List_Calloc_Deinit(&tokens);
+      Error_Buffer_Deinit(&lexerErrors);
+
+      mock().checkExpectations();
+      mock().clear();
+   }
+
+   void ShouldReportThisError(size_t line, const char *message)
+   {
+      mock()
+         .expectOneCall("report")
+         .onObject(&errorMock)
+         .withParameter("line", line)
+         .withParameter("message", message);
+   }
+
+   // Write a node as an s-expression: leaves as their lexeme, operators as (op operands...)
+   void Print(uint32_t index, size_t *used)
+   {
+      const Parser_Node_t *node = Parser_Node(&parser, index);
+      const Token_t *token = (node->token != PARSER_NONE) ? &((Token_t *)tokens.storage)[node->token] : NULL;
+
+      if(node->kind >= Parser_Node_Kind_Identifier && node->kind <= Parser_Node_Kind_Symbol)
+      {
+         *used += sprintf(&tree[*used], "%.*s", (int)token->length, token->lexeme);
+         return;
+      }
+
+      if(node->kind == Parser_Node_Kind_Unary || node->kind == Parser_Node_Kind_Binary)
+      {
+         *used += sprintf(&tree[*used], "(%.*s", (int)token->length, token->lexeme);
+      }
+      else
+      {
+         *used += sprintf(&tree[*used], "(%s", Parser_KindName(node->kind));
+      }
+
+      for(uint32_t child = node->first; child != PARSER_NONE; child = Parser_Node(&parser, child)->next)
+      {
+         tree[(*used)++] = ' ';
+         Print(child, used);
+      }
+      tree[(*used)++] = ')';
+      tree[*used] = '\0';
+   }
+
+   uint32_t Parse(const char *source)
+   {
+      uint32_t root;
+
+      List_Calloc_Deinit(&tokens);
+      List_Calloc_Init(&tokens, sizeof(Token_t));
+      Lexer_Lex(&lexer.interface, source, &tokens.interface);
+      root = Parser_Parse(&parser, (Token_t *)tokens.storage, tokens.usedSize);
+      CHECK_EQUAL(parser.nodeCount - 1, root);
+      return root;
+   }
+
+   void TheTreeShouldBe(const char *source, const char *expected)
+   {
+      size_t used = 0;
+
+      Print(Parse(source), &used);
+      STRCMP_EQUAL(expected, tree);
+   }
+};
+
+TEST(Parser, EmptySourceIsAnEmptyProgram)
+{
+   TheTreeShouldBe("", "(Program)");
+}
+
+TEST(Parser, LeavesAreTheirTokens)
+{
+   TheTreeShouldBe("x\n12.5\n\"text\"\n:sym", "(Program x 12.5 \"text\" :sym)");
+}
+
+TEST(Parser, ProductsBindTighterThanSums)
+{
+   TheTreeShouldBe("a + b * c - d / e", "(Program (- (+ a (* b c)) (/ d e)))");
+}
+
+TEST(Parser, SumsAndProductsGroupFromTheLeft)
+{
+   TheTreeShouldBe("a - b - c", "(Program (- (- a b) c))");
+   TheTreeShouldBe("a / b * c", "(Program (* (/ a b) c))");
+}
+
+TEST(Parser, AssignmentGroupsFromTheRight)
+{
+   TheTreeShouldBe("a = b = c + 1", "(Program (= a (= b (+ c 1))))");
+}
+
+TEST(Parser, TypesBindTighterThanAssignment)
+{
+   TheTreeShouldBe("x: int = 5", "(Program (= (: x int) 5))");
+}
+
+TEST(Parser, ComparisonsAndRangesBindLooserThanSums)
+{
+   TheTreeShouldBe("a + 1 <= b * 2", "(Program (<= (+ a 1) (* b 2)))");
+   TheTreeShouldBe("1 .. n - 1", "(Program (.. 1 (- n 1)))");
+   TheTreeShouldBe("a == b != c", "(Program (!= (== a b) c))");
+}
+
+TEST(Parser, PrefixOperatorsBindTighterThanInfix)
+{
+   TheTreeShouldBe("- a * $ b", "(Program (* (- a) ($ b)))");
+   TheTreeShouldBe("- - a", "(Program (- (- a)))");
+}
+
+TEST(Parser, ParenthesesOnlyGroup)
+{
+   TheTreeShouldBe("(a + b) * c", "(Program (* (+ a b) c))");
+}
+
+TEST(Parser, ParenthesesWithCommasMakeAGroup)
+{
+   TheTreeShouldBe("(a, b + 1)", "(Program (Group a (+ b 1)))");
+   TheTreeShouldBe("(a,)", "(Program (Group a))");
+   TheTreeShouldBe("()", "(Program (Group))");
+}
+
+TEST(Parser, SquareBracesMakeAList)
+{
+   TheTreeShouldBe("[1, 2, 3]", "(Program (List 1 2 3))");
+   TheTreeShouldBe("[]", "(Program (List))");
+}
+
+TEST(Parser, TouchingParenthesesCall)
+{
+   TheTreeShouldBe("f(a, b)", "(Program (Call f a b))");
+   TheTreeShouldBe("f()", "(Program (Call f))");
+   TheTreeShouldBe("f(a)(b)", "(Program (Call (Call f a) b))");
+}
+
+TEST(Parser, TouchingSquareBracesIndex)
+{
+   TheTreeShouldBe("a[i + 1]", "(Program (Index a (+ i 1)))");
+}
+
+TEST(Parser, CallsAndMembersBindTighterThanPrefixOperators)
+{
+   TheTreeShouldBe("- a.b(c)", "(Program (- (Call (. a b) c)))");
+}
+
+TEST(Parser, ExpressionsSideBySideMakeAPhrase)
+{
+   TheTreeShouldBe("let x = 10", "(Program (Phrase let (= x 10)))");
+   TheTreeShouldBe("f (a)", "(Program (Phrase f a))");
+   TheTreeShouldBe("int [20]", "(Program (Phrase int (List 20)))");
+}
+
+TEST(Parser, EachLineIsAStatement)
+{
+   TheTreeShouldBe("a = 1\nb = 2\n- c", "(Program (= a 1) (= b 2) (- c))");
+}
+
+TEST(Parser, CommasSeparateStatements)
+{
+   TheTreeShouldBe("a = 1, b = 2", "(Program (= a 1) (= b 2))");
+}
+
+TEST(Parser, OperatorsCarryOnToTheNextLine)
+{
+   TheTreeShouldBe("a = b +\n   c", "(Program (= a (+ b c)))");
+}
+
+TEST(Parser, LinesDoNotEndStatementsInsideBrackets)
+{
+   TheTreeShouldBe("f(a,\n  b\n  + c)", "(Program (Call f a (+ b c)))");
+   TheTreeShouldBe("[1\n 2]", "(Program (List (Phrase 1 2)))");
+}
+
+TEST(Parser, BlocksHoldStatements)
+{
+   TheTreeShouldBe("if x != 0 {\n   y = 1\n   print y\n}\n",
+                   "(Program (Phrase if (!= x 0) (Block (= y 1) (Phrase print y))))");
+}
+
+TEST(Parser, LinesEndStatementsInsideBlocksInsideBrackets)
+{
+   TheTreeShouldBe("f({\n a\n b\n})", "(Program (Call f (Block a b)))");
+}
+
+TEST(Parser, FunctionDefinition)
+{
+   TheTreeShouldBe("func add(a, b) { return a + b }",
+                   "(Program (Phrase func (Call add a b) (Block (Phrase return (+ a b)))))");
+}
+
+TEST(Parser, NodesAreSixteenBytes)
+{
+   CHECK_EQUAL(16, sizeof(Parser_Node_t));
+}
+
+TEST(Parser, ChildrenComeBeforeTheirParents)
+{
+   Parse("a = f(b, [c * 2, d]) + { e }");
+
+   for(uint32_t i = 0; i < parser.nodeCount; i++)
+   {
+      const Parser_Node_t *node = Parser_Node(&parser, i);
+
+      for(uint32_t child = node->first; child != PARSER_NONE; child = Parser_Node(&parser, child)->next)
+      {
+         CHECK(child < i);
+      }
+   }
+}
+
+TEST(Parser, ReportsAMissingOperand)
+{
+   ShouldReportThisError(1, "Expected an expression before ')'");
+   TheTreeShouldBe("f(a +)", "(Program (Call f (+ a (Error))))");
+}
+
+TEST(Parser, ReportsAMissingOperandAtTheEnd)
+{
+   ShouldReportThisError(2, "Expected an expression at the end");
+   TheTreeShouldBe("a = 1\nb *", "(Program (= a 1) (* b (Error)))");
+}
+
+TEST(Parser, ReportsAMissingCloser)
+{
+   ShouldReportThisError(1, "Missing ')' to close the '(' on line 1");
+   TheTreeShouldBe("f(a, b", "(Program (Call f a b))");
+}
+
+TEST(Parser, ReportsAMissingCloserInsideABlock)
+{
+   ShouldReportThisError(2, "Missing ']' to close the '[' on line 2");
+   TheTreeShouldBe("{\n  x = [1, 2\n}\ny", "(Program (Block (= x (List 1 2))) y)");
+}
+
+TEST(Parser, ReportsAnUnclosedBlock)
+{
+   ShouldReportThisError(1, "Missing '}' to close the '{' on line 1");
+   TheTreeShouldBe("if a {\n b", "(Program (Phrase if a (Block b)))");
+}
+
+TEST(Parser, ReportsAndSkipsAStrayCloser)
+{
+   ShouldReportThisError(1, "Unexpected ')'");
+   ShouldReportThisError(2, "Unexpected '}'");
+   TheTreeShouldBe("a)\n}\nb", "(Program a b)");
+}
+
+TEST(Parser, ReportsAnOperatorThatCannotStartAnExpression)
+{
+   ShouldReportThisError(1, "Unexpected '*'");
+   TheTreeShouldBe("x = * 2", "(Program (Phrase (= x (Error)) 2))");
+}
+
+TEST(Parser, StopsGoingDeeperAtTheLimit)
+{
+   char source[3 * PARSER_MAX_DEPTH];
+
+   for(size_t i = 0; i < sizeof(source) - 1; i++)
+   {
+      source[i] = '(';
+   }
+   source[sizeof(source) - 1] = '\0';
+
+   Error_Buffer_t errors;
+
+   // Too many errors to expect one by one
+   Error_Buffer_Init(&errors);
+   parser.errorHandler = &errors.interface;
+   Parse(source);
+   CHECK(errors.count > 0);
+   STRCMP_EQUAL("Nested too deeply at '('", &errors.text[errors.entries[0].message]);
+   Error_Buffer_Deinit(&errors);
+}
+
+TEST(Parser, ReportsTheLimitAtTheEndWithoutAToken)
+{
+   char source[2 * PARSER_MAX_DEPTH + 1];
+
+   for(size_t i = 0; i < 2 * PARSER_MAX_DEPTH; i += 2)
+   {
+      source[i] = '$';
+      source[i + 1] = ' ';
+   }
+   source[sizeof(source) - 1] = '\0';
+
+   Error_Buffer_t errors;
+
+   Error_Buffer_Init(&errors);
+   parser.errorHandler = &errors.interface;
+   Parse(source);
+   CHECK(errors.count > 0);
+   STRCMP_EQUAL("Nested too deeply at the end", &errors.text[errors.entries[0].message]);
+   Error_Buffer_Deinit(&errors);
+}
+
+TEST(Parser, ParsesAgainFromScratch)
+{
+   TheTreeShouldBe("a + b", "(Program (+ a b))");
+   TheTreeShouldBe("c", "(Program c)");
+}
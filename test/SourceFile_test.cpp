@@ -0,0 +1,59 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <stdio.h>
+   #include <stdlib.h>
+   #include <string.h>
+   #include <unistd.h>
+   #include "SourceFile.h"
+}
+
+TEST_GROUP(SourceFile)
+{
+   SourceFile_t file;
+   char path[32];
+
+   void setup()
+   {
+      strcpy(path, "/tmp/SourceFile_testXXXXXX");
+      close(mkstemp(path));
+   }
+
+   void teardown()
+   {
+      unlink(path);
+   }
+
+   void GivenTheFileContains(const char *contents, size_t length)
+   {
+      FILE *stream = fopen(path, "wb");
+      fwrite(contents, 1, length, stream);
+      fclose(stream);
+   }
+};
+
+TEST(SourceFile, MissingFileFailsToOpen)
+{
+   unlink(path);
+   CHECK_FALSE(SourceFile_Open(&file, path));
+}
+
+TEST(SourceFile, EmptyFileOpensWithNoContents)
+{
+   CHECK_TRUE(SourceFile_Open(&file, path));
+   CHECK_EQUAL(0, file.length);
+   SourceFile_Close(&file);
+}
+
+TEST(SourceFile, WholeFileIsAvailableAtOnce)
+{
+   const char contents[] = "x: int = 5\ny: int = 10\n\0binary after a null";
+   GivenTheFileContains(contents, sizeof(contents) - 1);
+
+   CHECK_TRUE(SourceFile_Open(&file, path));
+   CHECK_TRUE(file.mapped);
+   CHECK_EQUAL(sizeof(contents) - 1, file.length);
+   MEMCMP_EQUAL(contents, file.data, file.length);
+   SourceFile_Close(&file);
+}
@@ -0,0 +1,64 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <pthread.h>
+   #include "Threads.h"
+}
+
+typedef struct
+{
+   size_t runs;
+   pthread_t thread;
+} Item_t;
+
+static void *Count(void *argument)
+{
+   Item_t *item = (Item_t *)argument;
+
+   item->runs++;
+   item->thread = pthread_self();
+   return NULL;
+}
+
+TEST_GROUP(Threads)
+{
+   Item_t items[8];
+
+   void setup()
+   {
+      for(size_t k = 0; k < 8; k++)
+      {
+         items[k].runs = 0;
+      }
+   }
+};
+
+TEST(Threads, DefaultCountIsAtLeastOne)
+{
+   CHECK(Threads_DefaultCount() >= 1);
+}
+
+TEST(Threads, RunsEveryItemOnce)
+{
+   Threads_RunAll(items, 8, sizeof(Item_t), &Count);
+
+   for(size_t k = 0; k < 8; k++)
+   {
+      CHECK_EQUAL(1, items[k].runs);
+   }
+}
+
+TEST(Threads, RunsTheFirstItemOnTheCallingThread)
+{
+   Threads_RunAll(items, 3, sizeof(Item_t), &Count);
+
+   CHECK(pthread_equal(pthread_self(), items[0].thread));
+}
+
+TEST(Threads, DoesNothingWithNoItems)
+{
+   Threads_RunAll(items, 0, sizeof(Item_t), &Count);
+
+   CHECK_EQUAL(0, items[0].runs);
+}
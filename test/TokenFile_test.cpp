@@ -0,0 +1,335 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include <errno.h>
+   #include <stdio.h>
+   #include <stdlib.h>
+   #include <string.h>
+   #include <unistd.h>
+   #include "TokenFile.h"
+   #include "Lexer_StaticLookup.h"
+   #include "List_Calloc.h"
+   #include "Error_Buffer.h"
+   #include "Token.h"
+}
+
+TEST_GROUP(TokenFile)
+{
+   Error_Buffer_t errors;
+   List_Calloc_t tokens;
+   Lexer_StaticLookup_t lexer;
+   TokenFile_Writer_t writer;
+   TokenFile_t file;
+   char path[32];
+   char *source;
+
+   void setup()
+   {
+      int fd;
+
+      Error_Buffer_Init(&errors);
+      List_Calloc_Init(&tokens, sizeof(Token_t));
+      Lexer_StaticLookup_Init(&lexer, &errors.interface);
+      strcpy(path, "/tmp/TokenFile_XXXXXX");
+      fd = mkstemp(path);
+      CHECK(fd >= 0);
+      close(fd);
+      source = NULL;
+   }
+
+   void teardown()
+   {
+      Lexer_StaticLookup_Deinit(&lexer);
+      List_Calloc_Deinit(&tokens);
+      Error_Buffer_Deinit(&errors);
+      remove(path);
+      free(source);
+   }
+
+   // Lex the source into a list and into a token file, and open the file
+   void GivenTheTokensOf(const char *text)
+   {
+      source = strdup(text);
+      Lexer_Lex(&lexer.interface, source, &tokens.interface);
+
+      TokenFile_Writer_Init(&writer, source, strlen(source));
+      for(size_t i = 0; i < tokens.usedSize; i++)
+      {
+         Token_t *token;
+
+         List_At(&tokens.interface, i, (void **)&token);
+         List_Add(&writer.interface, token);
+      }
+      CHECK(TokenFile_Writer_Save(&writer, path));
+      TokenFile_Writer_Deinit(&writer);
+
+      CHECK(TokenFile_Open(&file, path, source, strlen(source)));
+   }
+
+   // A source of many short lines, each with a few tokens
+   void GivenALongSource(size_t lines)
+   {
+      char *text = (char *)malloc(lines * 32 + 1);
+      size_t length = 0;
+
+      for(size_t i = 0; i < lines; i++)
+      {
+         length += sprintf(&text[length], "%slet x%zu = %zu;\n", (i % 10 == 0) ? "\n\n" : "", i, i * 7);
+      }
+
+      GivenTheTokensOf(text);
+      free(text);
+   }
+
+   void TheTokenShouldBe(const Token_t *actual, size_t index)
+   {
+      Token_t *expected;
+
+      List_At(&tokens.interface, index, (void **)&expected);
+      CHECK_EQUAL(expected->type, actual->type);
+      CHECK_EQUAL(expected->lexeme, actual->lexeme);
+      CHECK_EQUAL(expected->length, actual->length);
+      CHECK_EQUAL(expected->line, actual->line);
+   }
+
+   void TheRestShouldMatchFrom(TokenFile_Cursor_t *cursor, size_t index)
+   {
+      Token_t token;
+
+      while(TokenFile_Next(&file, cursor, &token))
+      {
+         TheTokenShouldBe(&token, index++);
+      }
+      CHECK_EQUAL(tokens.usedSize, index);
+   }
+
+   void ThenItShouldReadBackEveryToken()
+   {
+      TokenFile_Cursor_t cursor;
+
+      CHECK_EQUAL(tokens.usedSize, TokenFile_Count(&file));
+      TokenFile_Begin(&file, &cursor);
+      TheRestShouldMatchFrom(&cursor, 0);
+   }
+
+   void WriteRawFile(const void *data, size_t size)
+   {
+      FILE *out = fopen(path, "wb");
+
+      CHECK_EQUAL(size, fwrite(data, 1, size, out));
+      fclose(out);
+   }
+};
+
+TEST(TokenFile, ReadsBackTheTokensOfASource)
+{
+   GivenTheTokensOf("let x = 10;\nfunc f(a, b) { return a + b; }\n\"a string\" #symbol 3.25\n");
+   ThenItShouldReadBackEveryToken();
+   TokenFile_Close(&file);
+}
+
+TEST(TokenFile, ReadsBackAnEmptySource)
+{
+   GivenTheTokensOf("");
+   ThenItShouldReadBackEveryToken();
+   TokenFile_Close(&file);
+}
+
+TEST(TokenFile, ReadsBackLongTokensAndGaps)
+{
+   char *text = (char *)malloc(100000);
+
+   memset(text, ' ', 100000 - 1);
+   memset(&text[5], 'a', 70000);
+   memset(&text[80000], '\n', 300);
+   strcpy(&text[99000], "let y");
+   GivenTheTokensOf(text);
+   free(text);
+
+   ThenItShouldReadBackEveryToken();
+   TokenFile_Close(&file);
+}
+
+TEST(TokenFile, ReadsBackTokensAddedOutOfOrder)
+{
+   const char *text = "alpha beta gamma";
+   Token_t added[] =
+   {
+      { Token_Type_Identifier, &text[11], 5, 9 },
+      { Token_Type_Identifier, &text[0], 5, 2 },
+      { Token_Type_Identifier, &text[6], 4, 2 },
+      { Token_Type_Identifier, &text[6], 4, 100000 }
+   };
+   TokenFile_Cursor_t cursor;
+   Token_t token;
+
+   TokenFile_Writer_Init(&writer, text, strlen(text));
+   for(size_t i = 0; i < sizeof(added) / sizeof(added[0]); i++)
+   {
+      List_Add(&writer.interface, &added[i]);
+      List_Add(&tokens.interface, &added[i]);
+   }
+   CHECK(TokenFile_Writer_Save(&writer, path));
+   TokenFile_Writer_Deinit(&writer);
+   CHECK(TokenFile_Open(&file, path, text, strlen(text)));
+
+   TokenFile_Begin(&file, &cursor);
+   for(size_t i = 0; i < sizeof(added) / sizeof(added[0]); i++)
+   {
+      CHECK(TokenFile_Next(&file, &cursor, &token));
+      TheTokenShouldBe(&token, i);
+   }
+   CHECK_FALSE(TokenFile_Next(&file, &cursor, &token));
+   TokenFile_Close(&file);
+}
+
+TEST(TokenFile, TakesAboutThreeBytesPerToken)
+{
+   FILE *in;
+   long size;
+
+   GivenALongSource(2000);
+   TokenFile_Close(&file);
+
+   in = fopen(path, "rb");
+   fseek(in, 0, SEEK_END);
+   size = ftell(in);
+   fclose(in);
+   CHECK(size < (long)(tokens.usedSize * 4));
+}
+
+TEST(TokenFile, SeeksToAnyToken)
+{
+   TokenFile_Cursor_t cursor;
+   size_t indexes[] = { 0, 1, 255, 256, 257, 1000, 4000, 7999 };
+
+   GivenALongSource(2000);
+
+   for(size_t i = 0; i < sizeof(indexes) / sizeof(indexes[0]); i++)
+   {
+      TokenFile_SeekToken(&file, &cursor, indexes[i]);
+      TheRestShouldMatchFrom(&cursor, indexes[i]);
+   }
+   TokenFile_Close(&file);
+}
+
+TEST(TokenFile, SeekingPastTheEndLeavesNothing)
+{
+   TokenFile_Cursor_t cursor;
+   Token_t token;
+
+   GivenALongSource(100);
+   TokenFile_SeekToken(&file, &cursor, tokens.usedSize);
+   CHECK_FALSE(TokenFile_Next(&file, &cursor, &token));
+   TokenFile_SeekToken(&file, &cursor, 10000);
+   CHECK_FALSE(TokenFile_Next(&file, &cursor, &token));
+   TokenFile_Close(&file);
+}
+
+TEST(TokenFile, SeeksToTheFirstTokenOnOrAfterALine)
+{
+   TokenFile_Cursor_t cursor;
+
+   GivenALongSource(2000);
+
+   for(size_t line = 0; line < 2500; line += 7)
+   {
+      size_t first = 0;
+      Token_t *token;
+
+      List_At(&tokens.interface, first, (void **)&token);
+      while(token != NULL && token->line < line)
+      {
+         List_At(&tokens.interface, ++first, (void **)&token);
+      }
+
+      TokenFile_SeekLine(&file, &cursor, line);
+      CHECK_EQUAL(first, cursor.index);
+      TheRestShouldMatchFrom(&cursor, first);
+   }
+   TokenFile_Close(&file);
+}
+
+TEST(TokenFile, RefusesAFileForOtherContents)
+{
+   GivenTheTokensOf("let x = 1;");
+   TokenFile_Close(&file);
+
+   CHECK_FALSE(TokenFile_Open(&file, path, "let x = 2;", 10));
+   CHECK_EQUAL(ESTALE, errno);
+   CHECK_FALSE(TokenFile_Open(&file, path, "let x = 1;;", 11));
+   CHECK_EQUAL(ESTALE, errno);
+}
+
+TEST(TokenFile, RefusesSomethingElse)
+{
+   const char *text = "let x = 1;";
+
+   WriteRawFile("let x = 1;", 10);
+   CHECK_FALSE(TokenFile_Open(&file, path, text, 10));
+   CHECK_EQUAL(EINVAL, errno);
+
+   WriteRawFile("", 0);
+   CHECK_FALSE(TokenFile_Open(&file, path, text, 10));
+   CHECK_EQUAL(EINVAL, errno);
+}
+
+TEST(TokenFile, RefusesACutOffFile)
+{
+   char *data;
+   long size;
+   FILE *in;
+
+   GivenALongSource(100);
+   TokenFile_Close(&file);
+
+   in = fopen(path, "rb");
+   fseek(in, 0, SEEK_END);
+   size = ftell(in);
+   rewind(in);
+   data = (char *)malloc(size);
+   CHECK_EQUAL((size_t)size, fread(data, 1, size, in));
+   fclose(in);
+
+   WriteRawFile(data, size - 1);
+   free(data);
+   CHECK_FALSE(TokenFile_Open(&file, path, source, strlen(source)));
+   CHECK_EQUAL(EINVAL, errno);
+}
+
+TEST(TokenFile, StopsAtDamageInsteadOfLeavingTheSource)
+{
+   TokenFile_Cursor_t cursor;
+   Token_t token;
+   size_t count = 0;
+   char *data;
+   long size;
+   FILE *in;
+
+   GivenALongSource(100);
+   TokenFile_Close(&file);
+
+   in = fopen(path, "rb");
+   fseek(in, 0, SEEK_END);
+   size = ftell(in);
+   rewind(in);
+   data = (char *)malloc(size);
+   CHECK_EQUAL((size_t)size, fread(data, 1, size, in));
+   fclose(in);
+
+   // Every length and gap byte in the stream becomes a huge varint
+   memset(&data[64 + 10], 0xFF, 40);
+   WriteRawFile(data, size);
+   free(data);
+
+   CHECK(TokenFile_Open(&file, path, source, strlen(source)));
+   TokenFile_Begin(&file, &cursor);
+   while(TokenFile_Next(&file, &cursor, &token))
+   {
+      CHECK(token.lexeme >= source && token.lexeme + token.length <= source + strlen(source));
+      count++;
+   }
+   CHECK(count < tokens.usedSize);
+   TokenFile_Close(&file);
+}
@@ -0,0 +1,123 @@
+#include "TestHarness.h"
+
+extern "C"
+{
+   #include "TokenList.h"
+   #include "List_Calloc.h"
+}
+
+TEST_GROUP(TokenList)
+{
+   TokenList_t list;
+   Token_t *readToken;
+   Token_t dummyToken;
+
+   void setup()
+   {
+      TokenList_Init(&list);
+      readToken = NULL;
+   }
+
+   void teardown()
+   {
+      TokenList_Deinit(&list);
+   }
+
+   Token_t TokenNumber(size_t n)
+   {
+      Token_t token = { Token_Type_Identifier, "token", n % 5, n };
+      return token;
+   }
+
+   void TheTokenAtThisIndexShouldBe(size_t index, Token_t expected)
+   {
+      List_At(&list.interface, index, (void **)&readToken);
+      CHECK(readToken != NULL);
+      CHECK_EQUAL(expected.type, readToken->type);
+      CHECK_EQUAL(expected.lexeme, readToken->lexeme);
+      CHECK_EQUAL(expected.length, readToken->length);
+      CHECK_EQUAL(expected.line, readToken->line);
+   }
+};
+
+TEST(TokenList, EmptyListReturnsNull)
+{
+   readToken = &dummyToken;
+   List_At(&list.interface, 0, (void **)&readToken);
+   POINTERS_EQUAL(NULL, readToken);
+}
+
+TEST(TokenList, AddedTokensCanBeReadThroughTheInterface)
+{
+   for(size_t i = 0; i < 1000; i++)
+   {
+      Token_t token = TokenNumber(i);
+      TokenList_Add(&list, &token);
+   }
+
+   CHECK_EQUAL(1000, list.count);
+   TheTokenAtThisIndexShouldBe(0, TokenNumber(0));
+   TheTokenAtThisIndexShouldBe(999, TokenNumber(999));
+   List_At(&list.interface, 1000, (void **)&readToken);
+   POINTERS_EQUAL(NULL, readToken);
+}
+
+TEST(TokenList, EmplacedTokensAreFilledInPlace)
+{
+   Token_t *token = TokenList_Emplace(&list);
+
+   *token = TokenNumber(7);
+   CHECK_EQUAL(1, list.count);
+   TheTokenAtThisIndexShouldBe(0, TokenNumber(7));
+}
+
+TEST(TokenList, InterfaceAddsAndSets)
+{
+   Token_t token = TokenNumber(1);
+
+   List_Add(&list.interface, &token);
+   token = TokenNumber(4);
+   List_Set(&list.interface, 3, &token);
+
+   CHECK_EQUAL(4, list.count);
+   TheTokenAtThisIndexShouldBe(0, TokenNumber(1));
+   TheTokenAtThisIndexShouldBe(3, TokenNumber(4));
+}
+
+TEST(TokenList, ReserveMakesRoomWithoutAdding)
+{
+   TokenList_Reserve(&list, 100);
+   Token_t *storage = list.tokens;
+
+   CHECK(list.allocatedCount >= 100);
+   CHECK_EQUAL(0, list.count);
+   for(size_t i = 0; i < 100; i++)
+   {
+      *TokenList_Emplace(&list) = TokenNumber(i);
+   }
+   POINTERS_EQUAL(storage, list.tokens);
+}
+
+TEST(TokenList, ClearKeepsTheMemory)
+{
+   Token_t token = TokenNumber(2);
+
+   TokenList_Add(&list, &token);
+   TokenList_Clear(&list);
+
+   CHECK_EQUAL(0, list.count);
+   CHECK(list.allocatedCount > 0);
+   List_At(&list.interface, 0, (void **)&readToken);
+   POINTERS_EQUAL(NULL, readToken);
+}
+
+TEST(TokenList, OnlyATokenListIsRecognized)
+{
+   List_Calloc_t other;
+
+   List_Calloc_Init(&other, sizeof(Token_t));
+   POINTERS_EQUAL(&list, TokenList_Of(&list.interface));
+   POINTERS_EQUAL(NULL, TokenList_Of(&other.interface));
+   POINTERS_EQUAL(NULL, TokenList_Of(NULL));
+   List_Calloc_Deinit(&other);
+}
@@ -0,0 +1,160 @@
+#include "TestHarness.h"
+#include "Error_TestDouble.h"
+
+extern "C"
+{
+   #include <stdlib.h>
+   #include <string.h>
+   #include "TokenStream.h"
+   #include "List_Calloc.h"
+   #include "Lexer_StaticLookup.h"
+}
+
+TEST_GROUP(TokenStream)
+{
+   const char *source;
+   TokenStream_t stream;
+   Token_t token;
+
+   void setup()
+   {
+      source = "x: int = 5\ny: int = 10\n\n print x + y";
+      TokenStream_Init(&stream, source);
+   }
+
+   void teardown()
+   {
+      TokenStream_Deinit(&stream);
+   }
+
+   void AddToken(Token_Type_t type, size_t offset, size_t length, size_t line)
+   {
+      Token_t added = { type, &source[offset], length, line };
+      List_Add(&stream.interface, &added);
+   }
+
+   void SetToken(size_t index, Token_Type_t type, size_t offset, size_t length, size_t line)
+   {
+      Token_t changed = { type, &source[offset], length, line };
+      List_Set(&stream.interface, index, &changed);
+   }
+
+   void TheTokenAtThisIndexShouldBe(size_t index, Token_Type_t type, size_t offset, size_t length, size_t line)
+   {
+      Token_t *actual;
+
+      List_At(&stream.interface, index, (void **)&actual);
+      CHECK(actual != NULL);
+      CHECK_EQUAL(type, actual->type);
+      CHECK_EQUAL(&source[offset], actual->lexeme);
+      CHECK_EQUAL(length, actual->length);
+      CHECK_EQUAL(line, actual->line);
+   }
+};
+
+TEST(TokenStream, EmptyStreamHasNoTokens)
+{
+   Token_t *actual = &token;
+
+   List_At(&stream.interface, 0, (void **)&actual);
+   POINTERS_EQUAL(NULL, actual);
+   CHECK_EQUAL(0, TokenStream_Count(&stream));
+   CHECK_EQUAL(Token_Type_Unused, TokenStream_Type(&stream, 0));
+   CHECK_FALSE(TokenStream_Get(&stream, 0, &token));
+}
+
+TEST(TokenStream, HoldsTheSameTokensAsAListOfTokens)
+{
+   Error_TestDouble_t errors;
+   List_Calloc_t list;
+   Lexer_StaticLookup_t lexer;
+   Token_t *expected;
+
+   Error_TestDouble_Init(&errors);
+   List_Calloc_Init(&list, sizeof(Token_t));
+   Lexer_StaticLookup_Init(&lexer, &errors.interface);
+
+   Lexer_Lex(&lexer.interface, source, &list.interface);
+   Lexer_Lex(&lexer.interface, source, &stream.interface);
+
+   CHECK_EQUAL(list.usedSize, TokenStream_Count(&stream));
+   for(size_t i = 0; i < list.usedSize; i++)
+   {
+      List_At(&list.interface, i, (void **)&expected);
+      TheTokenAtThisIndexShouldBe(i, expected->type, expected->lexeme - source, expected->length, expected->line);
+      CHECK_EQUAL(expected->type, TokenStream_Type(&stream, i));
+   }
+
+   Lexer_StaticLookup_Deinit(&lexer);
+   List_Calloc_Deinit(&list);
+}
+
+TEST(TokenStream, WalkingVisitsEveryTokenInOrder)
+{
+   TokenStream_Cursor_t cursor;
+   size_t visited = 0;
+
+   AddToken(Token_Type_Identifier, 0, 1, 1);
+   AddToken(Token_Type_Colon, 1, 1, 1);
+   AddToken(Token_Type_Identifier, 11, 1, 2);
+   AddToken(Token_Type_Identifier, 25, 5, 4);
+
+   TokenStream_Begin(&stream, &cursor);
+   while(TokenStream_Next(&stream, &cursor, &token))
+   {
+      Token_t expected;
+      TokenStream_Get(&stream, visited, &expected);
+      CHECK_EQUAL(expected.type, token.type);
+      CHECK_EQUAL(expected.lexeme, token.lexeme);
+      CHECK_EQUAL(expected.line, token.line);
+      visited++;
+   }
+
+   CHECK_EQUAL(4, visited);
+   CHECK_EQUAL(4, token.line);
+}
+
+TEST(TokenStream, LongLengthsAreKeptInFull)
+{
+   AddToken(Token_Type_Literal_String, 0, 70000, 1);
+   AddToken(Token_Type_Literal_String, 1, 65535, 1);
+   AddToken(Token_Type_Literal_String, 2, 65534, 1);
+
+   TheTokenAtThisIndexShouldBe(0, Token_Type_Literal_String, 0, 70000, 1);
+   TheTokenAtThisIndexShouldBe(1, Token_Type_Literal_String, 1, 65535, 1);
+   TheTokenAtThisIndexShouldBe(2, Token_Type_Literal_String, 2, 65534, 1);
+
+   SetToken(2, Token_Type_Literal_String, 2, 1000000, 1);
+   SetToken(0, Token_Type_Literal_String, 0, 3, 1);
+   TheTokenAtThisIndexShouldBe(0, Token_Type_Literal_String, 0, 3, 1);
+   TheTokenAtThisIndexShouldBe(2, Token_Type_Literal_String, 2, 1000000, 1);
+}
+
+TEST(TokenStream, SettingALineInsideARunSplitsIt)
+{
+   for(size_t i = 0; i < 5; i++)
+   {
+      AddToken(Token_Type_Identifier, i, 1, 1);
+   }
+
+   SetToken(2, Token_Type_Identifier, 2, 1, 7);
+
+   TheTokenAtThisIndexShouldBe(1, Token_Type_Identifier, 1, 1, 1);
+   TheTokenAtThisIndexShouldBe(2, Token_Type_Identifier, 2, 1, 7);
+   TheTokenAtThisIndexShouldBe(3, Token_Type_Identifier, 3, 1, 1);
+   CHECK_EQUAL(3, stream.lineRunCount);
+
+   SetToken(2, Token_Type_Identifier, 2, 1, 1);
+   TheTokenAtThisIndexShouldBe(2, Token_Type_Identifier, 2, 1, 1);
+   CHECK_EQUAL(1, stream.lineRunCount);
+}
+
+TEST(TokenStream, SetAtHighIndexResizesTheStream)
+{
+   AddToken(Token_Type_Identifier, 0, 1, 1);
+   SetToken(20, Token_Type_Plus, 33, 1, 4);
+
+   CHECK_EQUAL(21, TokenStream_Count(&stream));
+   TheTokenAtThisIndexShouldBe(10, Token_Type_Unused, 0, 0, 0);
+   TheTokenAtThisIndexShouldBe(20, Token_Type_Plus, 33, 1, 4);
+}